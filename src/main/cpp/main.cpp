@@ -1,11 +1,7 @@
 #include <jni.h>
-#include <android/log.h>
 #include "jni/jni_bridge.h"
 #include "openxr/openxr_api.h"
-
-#define LOG_TAG "XRRuntime"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include "utils/logger.h"
 
 #include "platform/android_platform.h"
 
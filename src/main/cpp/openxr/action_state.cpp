@@ -0,0 +1,84 @@
+#include "action_state.h"
+#include <cstring>
+
+static inline bool TestBit(const uint64_t* bits, uint32_t entry) {
+    return (bits[entry >> 6] >> (entry & 63)) & 1;
+}
+
+static inline void AssignBit(uint64_t* bits, uint32_t entry, bool value) {
+    uint64_t mask = 1ULL << (entry & 63);
+    if (value) {
+        bits[entry >> 6] |= mask;
+    } else {
+        bits[entry >> 6] &= ~mask;
+    }
+}
+
+ActionStateBuffer::ActionStateBuffer() : front(0) {
+    for (ActionStateSnapshot& snapshot : snapshots) {
+        snapshot.syncTime = 0;
+        memset(snapshot.activeBits, 0, sizeof(snapshot.activeBits));
+        memset(snapshot.booleanBits, 0, sizeof(snapshot.booleanBits));
+        memset(snapshot.changedBits, 0, sizeof(snapshot.changedBits));
+        memset(snapshot.floatValues, 0, sizeof(snapshot.floatValues));
+        memset(snapshot.vector2fValues, 0, sizeof(snapshot.vector2fValues));
+        memset(snapshot.lastChangeTimes, 0, sizeof(snapshot.lastChangeTimes));
+    }
+}
+
+ActionStateSnapshot* BeginActionStateWrite(ActionStateBuffer* buffer) {
+    uint32_t back = buffer->front.load(std::memory_order_relaxed) ^ 1;
+    ActionStateSnapshot* snapshot = &buffer->snapshots[back];
+
+    // Mark as in progress before touching any data
+    snapshot->sequence.BeginWrite();
+
+    // Unbound entries must read as inactive
+    memset(snapshot->activeBits, 0, sizeof(snapshot->activeBits));
+    memset(snapshot->changedBits, 0, sizeof(snapshot->changedBits));
+    return snapshot;
+}
+
+void PublishActionState(ActionStateBuffer* buffer) {
+    uint32_t back = buffer->front.load(std::memory_order_relaxed) ^ 1;
+    ActionStateSnapshot* snapshot = &buffer->snapshots[back];
+
+    snapshot->sequence.EndWrite();
+    buffer->front.store(back, std::memory_order_release);
+}
+
+void StoreActionState(ActionStateSnapshot* snapshot, uint32_t entry, const ActionStateValue& value) {
+    AssignBit(snapshot->activeBits, entry, value.isActive);
+    AssignBit(snapshot->booleanBits, entry, value.booleanState);
+    AssignBit(snapshot->changedBits, entry, value.changedSinceLastSync);
+    snapshot->floatValues[entry] = value.floatState;
+    snapshot->vector2fValues[entry] = value.vector2fState;
+    snapshot->lastChangeTimes[entry] = value.lastChangeTime;
+}
+
+void ReadActionStateUnsynchronized(const ActionStateSnapshot& snapshot, uint32_t entry,
+                                   ActionStateValue* value) {
+    value->isActive = TestBit(snapshot.activeBits, entry);
+    value->booleanState = TestBit(snapshot.booleanBits, entry);
+    value->changedSinceLastSync = TestBit(snapshot.changedBits, entry);
+    value->floatState = snapshot.floatValues[entry];
+    value->vector2fState = snapshot.vector2fValues[entry];
+    value->lastChangeTime = snapshot.lastChangeTimes[entry];
+}
+
+bool ReadActionState(const ActionStateBuffer& buffer, uint32_t entry, ActionStateValue* value) {
+    if (!value || entry >= ACTION_STATE_ENTRIES) {
+        return false;
+    }
+
+    for (;;) {
+        const ActionStateSnapshot& snapshot = buffer.snapshots[buffer.front.load(std::memory_order_acquire)];
+
+        // Waits if the writer lapped us and is refilling this snapshot
+        uint64_t before = snapshot.sequence.ReadBegin();
+        ReadActionStateUnsynchronized(snapshot, entry, value);
+        if (!snapshot.sequence.ReadRetry(before)) {
+            return true;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef ACTION_STATE_H
+#define ACTION_STATE_H
+
+#include <openxr/openxr.h>
+#include "platform/input_manager.h"
+#include "utils/seqlock.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// State lanes per action: one per hand plus the combined state that is
+// returned when the app queries with XR_NULL_PATH as subaction path
+enum ActionStateLane : uint32_t {
+    ACTION_STATE_LANE_LEFT = 0,
+    ACTION_STATE_LANE_RIGHT = 1,
+    ACTION_STATE_LANE_ANY = 2,
+};
+
+static const uint32_t ACTION_STATE_LANES = 3;
+static const uint32_t ACTION_STATE_ENTRIES = MAX_INPUT_ACTIONS * ACTION_STATE_LANES;
+static const uint32_t ACTION_STATE_WORDS = (ACTION_STATE_ENTRIES + 63) / 64;
+
+inline uint32_t ActionStateEntry(uint32_t actionSlot, uint32_t lane) {
+    return actionSlot * ACTION_STATE_LANES + lane;
+}
+
+// Action state published by one xrSyncActions call, struct-of-arrays.
+// Entries are indexed by ActionStateEntry(action handle slot, lane).
+struct ActionStateSnapshot {
+    SeqLock sequence;  // Odd while the writer is filling it
+    XrTime syncTime;
+    uint64_t activeBits[ACTION_STATE_WORDS];
+    uint64_t booleanBits[ACTION_STATE_WORDS];
+    uint64_t changedBits[ACTION_STATE_WORDS];
+    float floatValues[ACTION_STATE_ENTRIES];
+    XrVector2f vector2fValues[ACTION_STATE_ENTRIES];
+    XrTime lastChangeTimes[ACTION_STATE_ENTRIES];
+};
+
+// Per-session double buffer. xrSyncActions fills the back snapshot and flips;
+// xrGetActionState* read the front one without a lock, retrying if the
+// writer lapped them (sequence changed during the read).
+struct ActionStateBuffer {
+    ActionStateSnapshot snapshots[2];
+    std::atomic<uint32_t> front;
+    std::mutex writerMutex;  // Serializes concurrent xrSyncActions calls
+
+    ActionStateBuffer();
+
+    ActionStateBuffer(const ActionStateBuffer&) = delete;
+    ActionStateBuffer& operator=(const ActionStateBuffer&) = delete;
+};
+
+// One entry read out of a snapshot
+struct ActionStateValue {
+    bool isActive;
+    bool booleanState;
+    bool changedSinceLastSync;
+    float floatState;
+    XrVector2f vector2fState;
+    XrTime lastChangeTime;
+};
+
+// Writer side; caller holds buffer->writerMutex
+ActionStateSnapshot* BeginActionStateWrite(ActionStateBuffer* buffer);
+void PublishActionState(ActionStateBuffer* buffer);
+void StoreActionState(ActionStateSnapshot* snapshot, uint32_t entry, const ActionStateValue& value);
+
+// Lock-free reader side
+bool ReadActionState(const ActionStateBuffer& buffer, uint32_t entry, ActionStateValue* value);
+void ReadActionStateUnsynchronized(const ActionStateSnapshot& snapshot, uint32_t entry,
+                                   ActionStateValue* value);
+
+#endif // ACTION_STATE_H
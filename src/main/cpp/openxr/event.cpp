@@ -1,15 +1,14 @@
 #include "openxr_api.h"
 #include "platform/input_manager.h"
 #include "utils/logger.h"
+#include "handle_table.h"
 #include <mutex>
 #include <queue>
 #include <cstring>
-#include <unordered_map>
 #include <memory>
 
 // External declarations
-extern std::mutex g_instanceMutex;
-extern std::unordered_map<XrInstance, std::shared_ptr<XRInstance>> g_instances;
+extern HandleTable<XRInstance, XrInstance> g_instances;
 
 struct XREvent {
     XrEventDataBuffer buffer;
@@ -25,9 +24,7 @@ XrResult xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData) {
     }
     
     // Validate instance
-    std::lock_guard<std::mutex> instLock(g_instanceMutex);
-    auto instIt = g_instances.find(instance);
-    if (instIt == g_instances.end()) {
+    if (!g_instances.Lookup(instance)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
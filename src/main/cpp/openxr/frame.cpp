@@ -1,26 +1,19 @@
 #include "openxr_api.h"
+#include "session.h"
+#include "handle_table.h"
 #include "qualcomm/xr2_platform.h"
 #include "platform/frame_sync.h"
+#include "platform/frame_pacer.h"
+#include "platform/frame_telemetry.h"
+#include "platform/display_manager.h"
+#include "frame_ring.h"
 #include "utils/logger.h"
 #include <mutex>
 #include <chrono>
-#include <unordered_map>
 #include <memory>
 
-// Forward declaration of XRSession structure
-struct XRSession {
-    XrInstance instance;
-    XrSessionState state;
-    XrViewConfigurationType viewConfigType;
-    bool active;
-    std::mutex mutex;
-};
-
 // External declarations
-extern std::mutex g_sessionMutex;
-extern std::unordered_map<XrSession, std::shared_ptr<XRSession>> g_sessions;
-
-static std::mutex g_frameMutex;
+extern HandleTable<XRSession, XrSession> g_sessions;
 
 XrResult xrWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState) {
     if (!frameWaitInfo || !frameState) {
@@ -35,27 +28,40 @@ XrResult xrWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, Xr
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
-    // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    // Validate session; hold a reference since this call blocks
+    std::shared_ptr<XRSession> sess = g_sessions.Acquire(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& sess = sessIt->second;
     if (!sess->active) {
         return XR_ERROR_SESSION_NOT_RUNNING;
     }
     
-    // Wait for next frame from display
+    // Claim a frame slot; blocks while the pipeline is full or the previous
+    // waited frame has not been begun
+    uint64_t frameId;
+    if (!AcquireFrameSlot(&sess->frameRing, &frameId)) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    
+    // Wait for next frame on the session's own pacer (no global locks held)
     XrTime predictedDisplayTime;
     XrDuration predictedDisplayPeriod;
     
-    if (!WaitForNextFrame(&predictedDisplayTime, &predictedDisplayPeriod)) {
+    if (!WaitForFramePacer(&sess->framePacer, &predictedDisplayTime, &predictedDisplayPeriod)) {
+        AbortFrameWait(&sess->frameRing, frameId);
+        if (!sess->active) {
+            // Session ended while this thread was waiting
+            return XR_ERROR_SESSION_NOT_RUNNING;
+        }
         LOGE("Failed to wait for next frame");
         return XR_ERROR_RUNTIME_FAILURE;
     }
     
+    CompleteFrameWait(&sess->frameRing, frameId, predictedDisplayTime, predictedDisplayPeriod);
+    BeginFrameTiming(frameId, predictedDisplayTime, predictedDisplayPeriod);
+    
     // Check if should render
     bool shouldRender = true; // Platform determines this
     
@@ -76,24 +82,34 @@ XrResult xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo)
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& sess = sessIt->second;
     if (!sess->active) {
         return XR_ERROR_SESSION_NOT_RUNNING;
     }
     
+    // XR_FRAME_DISCARDED (success) if the previous begun frame was never ended
+    FrameSlot frame;
+    XrResult result = BeginFrameSlot(&sess->frameRing, &frame);
+    if (XR_FAILED(result)) {
+        return result;
+    }
+    
+    RecordFrameEvent(frame.frameId, FRAME_EVENT_BEGIN);
+    if (result == XR_FRAME_DISCARDED) {
+        RecordFrameDrop(FRAME_DROP_DISCARDED);
+    }
+    
     // Begin frame rendering
     if (!BeginFrameRendering()) {
         LOGE("Failed to begin frame rendering");
         return XR_ERROR_RUNTIME_FAILURE;
     }
     
-    return XR_SUCCESS;
+    return result;
 }
 
 XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
@@ -106,13 +122,11 @@ XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& sess = sessIt->second;
     if (!sess->active) {
         return XR_ERROR_SESSION_NOT_RUNNING;
     }
@@ -122,12 +136,32 @@ XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
+    if (frameEndInfo->displayTime <= 0) {
+        return XR_ERROR_TIME_INVALID;
+    }
+    
+    FrameSlot frame;
+    XrResult result = EndFrameSlot(&sess->frameRing, &frame);
+    if (XR_FAILED(result)) {
+        return result;
+    }
+    
+    RecordFrameEvent(frame.frameId, FRAME_EVENT_END);
+    
     // Submit layers to compositor
     if (frameEndInfo->layerCount > 0) {
-        if (!SubmitFrameLayers(frameEndInfo->layers, frameEndInfo->layerCount)) {
+        RecordFrameEvent(frame.frameId, FRAME_EVENT_LAYER_SUBMIT);
+        CompositorSubmitResult submitted = SubmitFrameLayers(frame.frameId, frameEndInfo->displayTime,
+                                                             frameEndInfo->layers, frameEndInfo->layerCount);
+        if (submitted == COMPOSITOR_SUBMIT_FAILED) {
             LOGE("Failed to submit frame layers");
             return XR_ERROR_RUNTIME_FAILURE;
         }
+        // Back-pressure: the compositor is behind and the frame is not
+        // shown, which is a drop, not an error for the app
+        if (submitted == COMPOSITOR_SUBMIT_DROPPED) {
+            RecordFrameDrop(FRAME_DROP_QUEUE_FULL);
+        }
     }
     
     // End frame rendering
@@ -136,6 +170,12 @@ XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
         return XR_ERROR_RUNTIME_FAILURE;
     }
     
+    // Frame time feeds the pacer's wake-up offset
+    EndFramePacerFrame(&sess->framePacer, frame.wakeTime);
+    
+    // Swapchains the compositor let go of since the last frame
+    FlushDeferredSwapchainDeletes();
+    
     return XR_SUCCESS;
 }
 
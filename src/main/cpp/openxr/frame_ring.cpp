@@ -0,0 +1,188 @@
+#include "frame_ring.h"
+#include "utils/xr_time.h"
+#include <chrono>
+
+static FrameSlot* FindFrameSlot(FrameRing* ring, uint64_t frameId) {
+    for (FrameSlot& slot : ring->slots) {
+        if (slot.state != FRAME_SLOT_FREE && slot.frameId == frameId) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+// Free ended frames whose display time has passed; returns frames still in
+// flight and the earliest pending display time (0 if none)
+static uint32_t RetireDisplayedFrames(FrameRing* ring, XrTime now, XrTime* nextDisplayTime) {
+    uint32_t inFlight = 0;
+    *nextDisplayTime = 0;
+
+    for (FrameSlot& slot : ring->slots) {
+        if (slot.state == FRAME_SLOT_ENDED && slot.predictedDisplayTime <= now) {
+            slot.state = FRAME_SLOT_FREE;
+        }
+        if (slot.state == FRAME_SLOT_FREE) {
+            continue;
+        }
+
+        inFlight++;
+        if (slot.state == FRAME_SLOT_ENDED &&
+            (*nextDisplayTime == 0 || slot.predictedDisplayTime < *nextDisplayTime)) {
+            *nextDisplayTime = slot.predictedDisplayTime;
+        }
+    }
+    return inFlight;
+}
+
+FrameRing::FrameRing()
+    : depth(DEFAULT_FRAME_PIPELINE_DEPTH), nextFrameId(1), waitedFrameId(0), begunFrameId(0),
+      cancelled(false) {
+    for (FrameSlot& slot : slots) {
+        slot = {};
+    }
+}
+
+uint32_t GetFrameRingDepth(FrameRing* ring) {
+    if (!ring) {
+        return DEFAULT_FRAME_PIPELINE_DEPTH;
+    }
+
+    return ring->depth;
+}
+
+bool AcquireFrameSlot(FrameRing* ring, uint64_t* frameId) {
+    if (!ring || !frameId) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(ring->mutex);
+
+    for (;;) {
+        if (ring->cancelled) {
+            return false;
+        }
+
+        XrTime nextDisplayTime;
+        uint32_t inFlight = RetireDisplayedFrames(ring, GetXR2CurrentTime(), &nextDisplayTime);
+        if (ring->waitedFrameId == 0 && inFlight < ring->depth) {
+            break;
+        }
+
+        // Woken by begin/end/cancel, or when the oldest ended frame displays
+        if (nextDisplayTime != 0) {
+            ring->condition.wait_until(lock, XrTimeToSteadyClock(nextDisplayTime));
+        } else {
+            ring->condition.wait(lock);
+        }
+    }
+
+    for (FrameSlot& slot : ring->slots) {
+        if (slot.state == FRAME_SLOT_FREE) {
+            slot = {};
+            slot.frameId = ring->nextFrameId++;
+            slot.state = FRAME_SLOT_WAITING;
+            ring->waitedFrameId = slot.frameId;
+            *frameId = slot.frameId;
+            return true;
+        }
+    }
+    return false;  // Unreachable: inFlight < depth <= slot count
+}
+
+void CompleteFrameWait(FrameRing* ring, uint64_t frameId, XrTime predictedDisplayTime,
+                       XrDuration predictedDisplayPeriod) {
+    std::lock_guard<std::mutex> lock(ring->mutex);
+
+    FrameSlot* slot = FindFrameSlot(ring, frameId);
+    if (!slot) {
+        return;  // Reset while waiting
+    }
+
+    slot->wakeTime = GetXR2CurrentTime();
+    slot->predictedDisplayTime = predictedDisplayTime;
+    slot->predictedDisplayPeriod = predictedDisplayPeriod;
+    slot->state = FRAME_SLOT_WAITED;
+}
+
+void AbortFrameWait(FrameRing* ring, uint64_t frameId) {
+    {
+        std::lock_guard<std::mutex> lock(ring->mutex);
+
+        FrameSlot* slot = FindFrameSlot(ring, frameId);
+        if (slot) {
+            slot->state = FRAME_SLOT_FREE;
+        }
+        if (ring->waitedFrameId == frameId) {
+            ring->waitedFrameId = 0;
+        }
+    }
+    ring->condition.notify_all();
+}
+
+XrResult BeginFrameSlot(FrameRing* ring, FrameSlot* frame) {
+    XrResult result = XR_SUCCESS;
+    {
+        std::lock_guard<std::mutex> lock(ring->mutex);
+
+        FrameSlot* waited = FindFrameSlot(ring, ring->waitedFrameId);
+        if (!waited || waited->state != FRAME_SLOT_WAITED) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+
+        // Beginning a new frame discards one that was begun but never ended
+        if (ring->begunFrameId != 0) {
+            FrameSlot* begun = FindFrameSlot(ring, ring->begunFrameId);
+            if (begun) {
+                begun->state = FRAME_SLOT_FREE;
+            }
+            result = XR_FRAME_DISCARDED;
+        }
+
+        waited->state = FRAME_SLOT_BEGUN;
+        ring->begunFrameId = waited->frameId;
+        ring->waitedFrameId = 0;
+        if (frame) {
+            *frame = *waited;
+        }
+    }
+    ring->condition.notify_all();
+    return result;
+}
+
+XrResult EndFrameSlot(FrameRing* ring, FrameSlot* frame) {
+    {
+        std::lock_guard<std::mutex> lock(ring->mutex);
+
+        FrameSlot* begun = FindFrameSlot(ring, ring->begunFrameId);
+        if (!begun || begun->state != FRAME_SLOT_BEGUN) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+
+        begun->state = FRAME_SLOT_ENDED;
+        ring->begunFrameId = 0;
+        if (frame) {
+            *frame = *begun;
+        }
+    }
+    ring->condition.notify_all();
+    return XR_SUCCESS;
+}
+
+void ResetFrameRing(FrameRing* ring) {
+    std::lock_guard<std::mutex> lock(ring->mutex);
+
+    for (FrameSlot& slot : ring->slots) {
+        slot.state = FRAME_SLOT_FREE;
+    }
+    ring->waitedFrameId = 0;
+    ring->begunFrameId = 0;
+    ring->cancelled = false;
+}
+
+void CancelFrameRing(FrameRing* ring) {
+    {
+        std::lock_guard<std::mutex> lock(ring->mutex);
+        ring->cancelled = true;
+    }
+    ring->condition.notify_all();
+}
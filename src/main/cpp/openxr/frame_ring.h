@@ -0,0 +1,76 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <openxr/openxr.h>
+#include "qualcomm/xr2_platform.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+static const uint32_t MAX_FRAME_PIPELINE_DEPTH = XR2_MAX_FRAMES_IN_FLIGHT;
+static const uint32_t DEFAULT_FRAME_PIPELINE_DEPTH = 2;
+
+enum FrameSlotState : uint8_t {
+    FRAME_SLOT_FREE = 0,
+    FRAME_SLOT_WAITING,   // Inside xrWaitFrame
+    FRAME_SLOT_WAITED,    // Returned by xrWaitFrame, not begun yet
+    FRAME_SLOT_BEGUN,     // Between xrBeginFrame and xrEndFrame
+    FRAME_SLOT_ENDED,     // Submitted, waiting for its display time
+};
+
+// One frame from xrWaitFrame to display. The head pose for the frame is
+// the tracking snapshot keyed by predictedDisplayTime.
+struct FrameSlot {
+    uint64_t frameId;
+    XrTime wakeTime;  // When xrWaitFrame returned
+    XrTime predictedDisplayTime;
+    XrDuration predictedDisplayPeriod;
+    FrameSlotState state;
+};
+
+// Per-session ring of frames in flight. Frame ids increase by one per
+// xrWaitFrame. At most 'depth' frames are in flight (waited, begun, or
+// ended but not yet displayed); xrWaitFrame blocks for a free slot, and also
+// while the previously waited frame has not been begun.
+struct FrameRing {
+    std::mutex mutex;
+    std::condition_variable condition;
+    FrameSlot slots[MAX_FRAME_PIPELINE_DEPTH];
+    const uint32_t depth;
+    uint64_t nextFrameId;    // Id handed to the next xrWaitFrame
+    uint64_t waitedFrameId;  // Oldest frame waited but not begun, 0 = none
+    uint64_t begunFrameId;   // Frame between begin and end, 0 = none
+    bool cancelled;
+
+    FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+};
+
+// Fixed at DEFAULT_FRAME_PIPELINE_DEPTH; swapchains size their image count
+// from it
+uint32_t GetFrameRingDepth(FrameRing* ring);
+
+// xrWaitFrame, part 1: block until a slot is free, then claim it.
+// False if the ring was cancelled.
+bool AcquireFrameSlot(FrameRing* ring, uint64_t* frameId);
+
+// xrWaitFrame, part 2: the pacer returned; publish the frame's timing.
+// On failure the claimed slot is released instead.
+void CompleteFrameWait(FrameRing* ring, uint64_t frameId, XrTime predictedDisplayTime,
+                       XrDuration predictedDisplayPeriod);
+void AbortFrameWait(FrameRing* ring, uint64_t frameId);
+
+// xrBeginFrame: XR_ERROR_CALL_ORDER_INVALID without a waited frame,
+// XR_FRAME_DISCARDED if the previously begun frame was never ended
+XrResult BeginFrameSlot(FrameRing* ring, FrameSlot* frame);
+
+// xrEndFrame: XR_ERROR_CALL_ORDER_INVALID without a begun frame
+XrResult EndFrameSlot(FrameRing* ring, FrameSlot* frame);
+
+// Session begin/end
+void ResetFrameRing(FrameRing* ring);
+void CancelFrameRing(FrameRing* ring);
+
+#endif // FRAME_RING_H
@@ -0,0 +1,207 @@
+#ifndef HANDLE_TABLE_H
+#define HANDLE_TABLE_H
+
+#include <openxr/openxr.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+// Type tags stored in the top byte of every handle
+enum HandleType : uint8_t {
+    HANDLE_TYPE_INSTANCE = 1,
+    HANDLE_TYPE_SESSION = 2,
+    HANDLE_TYPE_SPACE = 3,
+    HANDLE_TYPE_SWAPCHAIN = 4,
+    HANDLE_TYPE_ACTION_SET = 5,
+    HANDLE_TYPE_ACTION = 6,
+};
+
+// Handle layout (64 bits):
+//   [63..56] type tag | [55..24] slot generation | [23..0] slot index
+static const uint32_t HANDLE_INDEX_BITS = 24;
+static const uint64_t HANDLE_INDEX_MASK = (1ULL << HANDLE_INDEX_BITS) - 1;
+static const uint32_t HANDLE_GENERATION_SHIFT = HANDLE_INDEX_BITS;
+static const uint64_t HANDLE_GENERATION_MASK = 0xFFFFFFFFULL;
+static const uint32_t HANDLE_TYPE_SHIFT = 56;
+
+// OpenXR handles are pointers on 64-bit targets and uint64_t on 32-bit ones
+template <typename H>
+inline uint64_t HandleToValue(H handle) {
+    if constexpr (std::is_pointer<H>::value) {
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+    } else {
+        return static_cast<uint64_t>(handle);
+    }
+}
+
+template <typename H>
+inline H ValueToHandle(uint64_t value) {
+    if constexpr (std::is_pointer<H>::value) {
+        return reinterpret_cast<H>(static_cast<uintptr_t>(value));
+    } else {
+        return static_cast<H>(value);
+    }
+}
+
+// Dense slot index of a handle, usable as an index into per-object side arrays
+template <typename H>
+inline uint32_t HandleSlotIndex(H handle) {
+    return static_cast<uint32_t>(HandleToValue(handle) & HANDLE_INDEX_MASK);
+}
+
+// Fixed-capacity slot array shared by all OpenXR object types.
+// Lookups are wait-free: decode the slot index, compare the generation and
+// read the object pointer. Insert/Remove are serialized by a writer mutex and
+// bump the slot generation so stale handles fail validation.
+// Per the OpenXR threading rules, destroying a handle is externally
+// synchronized with every other use of that handle.
+template <typename T, typename H>
+class HandleTable {
+public:
+    HandleTable(HandleType type, uint32_t capacity)
+        : type_(type), capacity_(capacity), slots_(new Slot[capacity]), nextUnused_(0) {}
+
+    HandleTable(const HandleTable&) = delete;
+    HandleTable& operator=(const HandleTable&) = delete;
+
+    // Register an object; returns XR_NULL_HANDLE when the table is full
+    H Insert(std::shared_ptr<T> object) {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+
+        uint32_t index;
+        if (!freeList_.empty()) {
+            index = freeList_.back();
+            freeList_.pop_back();
+        } else if (nextUnused_ < capacity_) {
+            index = nextUnused_++;
+        } else {
+            return ValueToHandle<H>(0);
+        }
+
+        Slot& slot = slots_[index];
+        uint32_t generation = slot.generation.load(std::memory_order_relaxed);
+        slot.raw.store(object.get(), std::memory_order_release);
+        std::atomic_store(&slot.owner, std::move(object));
+
+        return ValueToHandle<H>(MakeValue(index, generation));
+    }
+
+    // Wait-free validation; returns nullptr for stale or foreign handles
+    T* Lookup(H handle) const {
+        const Slot* slot = Resolve(HandleToValue(handle));
+        if (!slot) {
+            return nullptr;
+        }
+        return slot->raw.load(std::memory_order_acquire);
+    }
+
+    // Like Lookup, but keeps the object alive for callers that block
+    std::shared_ptr<T> Acquire(H handle) const {
+        uint64_t value = HandleToValue(handle);
+        const Slot* slot = Resolve(value);
+        if (!slot) {
+            return nullptr;
+        }
+        std::shared_ptr<T> object = std::atomic_load(&slot->owner);
+        // Re-check: the slot may have been recycled between the two reads
+        if (!Resolve(value)) {
+            return nullptr;
+        }
+        return object;
+    }
+
+    // Unregister an object; returns it so the caller controls destruction
+    std::shared_ptr<T> Remove(H handle) {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+
+        uint64_t value = HandleToValue(handle);
+        Slot* slot = const_cast<Slot*>(Resolve(value));
+        if (!slot || !slot->raw.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        // Invalidate outstanding handles before the object goes away
+        slot->generation.fetch_add(1, std::memory_order_acq_rel);
+        slot->raw.store(nullptr, std::memory_order_release);
+        std::shared_ptr<T> object = std::atomic_exchange(&slot->owner, std::shared_ptr<T>());
+
+        freeList_.push_back(static_cast<uint32_t>(value & HANDLE_INDEX_MASK));
+        return object;
+    }
+
+    // Destroy every registered object (runtime shutdown)
+    void Clear() {
+        std::vector<std::shared_ptr<T>> released;
+        {
+            std::lock_guard<std::mutex> lock(writerMutex_);
+            for (uint32_t i = 0; i < nextUnused_; ++i) {
+                Slot& slot = slots_[i];
+                if (!slot.raw.load(std::memory_order_relaxed)) {
+                    continue;
+                }
+                slot.generation.fetch_add(1, std::memory_order_acq_rel);
+                slot.raw.store(nullptr, std::memory_order_release);
+                released.push_back(std::atomic_exchange(&slot.owner, std::shared_ptr<T>()));
+                freeList_.push_back(i);
+            }
+        }
+        // Objects are destroyed here, outside the writer lock
+    }
+
+    // Handle of the first live object, or XR_NULL_HANDLE
+    H First() const {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        for (uint32_t i = 0; i < nextUnused_; ++i) {
+            const Slot& slot = slots_[i];
+            if (slot.raw.load(std::memory_order_relaxed)) {
+                return ValueToHandle<H>(MakeValue(i, slot.generation.load(std::memory_order_relaxed)));
+            }
+        }
+        return ValueToHandle<H>(0);
+    }
+
+    uint32_t Capacity() const { return capacity_; }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> generation;
+        std::atomic<T*> raw;
+        std::shared_ptr<T> owner;  // Accessed through std::atomic_* only
+
+        Slot() : generation(1), raw(nullptr) {}
+    };
+
+    uint64_t MakeValue(uint32_t index, uint32_t generation) const {
+        return (static_cast<uint64_t>(type_) << HANDLE_TYPE_SHIFT) |
+               ((static_cast<uint64_t>(generation) & HANDLE_GENERATION_MASK) << HANDLE_GENERATION_SHIFT) |
+               static_cast<uint64_t>(index);
+    }
+
+    const Slot* Resolve(uint64_t value) const {
+        if ((value >> HANDLE_TYPE_SHIFT) != type_) {
+            return nullptr;
+        }
+        uint64_t index = value & HANDLE_INDEX_MASK;
+        if (index >= capacity_) {
+            return nullptr;
+        }
+        const Slot& slot = slots_[index];
+        uint32_t generation = static_cast<uint32_t>((value >> HANDLE_GENERATION_SHIFT) & HANDLE_GENERATION_MASK);
+        if (slot.generation.load(std::memory_order_acquire) != generation) {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    const HandleType type_;
+    const uint32_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    mutable std::mutex writerMutex_;
+    std::vector<uint32_t> freeList_;
+    uint32_t nextUnused_;
+};
+
+#endif // HANDLE_TABLE_H
@@ -1,8 +1,11 @@
 #include "openxr_api.h"
 #include "platform/input_manager.h"
 #include "utils/logger.h"
+#include "handle_table.h"
+#include "instance.h"
+#include "session.h"
+#include "action_state.h"
 #include <cstdint>
-#include <mutex>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -10,10 +13,8 @@
 #include <cstring>
 
 // External declarations
-extern std::mutex g_instanceMutex;
-extern std::unordered_map<XrInstance, std::shared_ptr<XRInstance>> g_instances;
-extern std::mutex g_sessionMutex;
-extern std::unordered_map<XrSession, std::shared_ptr<XRSession>> g_sessions;
+extern HandleTable<XRInstance, XrInstance> g_instances;
+extern HandleTable<XRSession, XrSession> g_sessions;
 
 struct XRActionSet {
     XrInstance instance;
@@ -30,13 +31,10 @@ struct XRAction {
     std::unordered_map<XrPath, XrPath> subactionPaths;
 };
 
-std::mutex g_actionSetMutex;
-std::unordered_map<XrActionSet, std::shared_ptr<XRActionSet>> g_actionSets;
-static XrActionSet g_nextActionSetHandle = reinterpret_cast<XrActionSet>(0x4000);
+static const uint32_t MAX_ACTION_SETS = 128;
+HandleTable<XRActionSet, XrActionSet> g_actionSets(HANDLE_TYPE_ACTION_SET, MAX_ACTION_SETS);
 
-std::mutex g_actionMutex;
-std::unordered_map<XrAction, std::shared_ptr<XRAction>> g_actions;
-static XrAction g_nextActionHandle = reinterpret_cast<XrAction>(0x5000);
+HandleTable<XRAction, XrAction> g_actions(HANDLE_TYPE_ACTION, MAX_INPUT_ACTIONS);
 
 XrResult xrCreateActionSet(XrInstance instance, const XrActionSetCreateInfo* createInfo, XrActionSet* actionSet) {
     if (!createInfo || !actionSet) {
@@ -48,9 +46,7 @@ XrResult xrCreateActionSet(XrInstance instance, const XrActionSetCreateInfo* cre
     }
     
     // Validate instance
-    std::lock_guard<std::mutex> instLock(g_instanceMutex);
-    auto instIt = g_instances.find(instance);
-    if (instIt == g_instances.end()) {
+    if (!g_instances.Lookup(instance)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -62,13 +58,11 @@ XrResult xrCreateActionSet(XrInstance instance, const XrActionSetCreateInfo* cre
     xrActionSet->priority = createInfo->priority;
     
     // Register action set
-    std::lock_guard<std::mutex> setLock(g_actionSetMutex);
-    // Increment handle using integer arithmetic (handles are pointers in 64-bit)
-    uintptr_t handleValue = reinterpret_cast<uintptr_t>(g_nextActionSetHandle);
-    handleValue++;
-    XrActionSet handle = reinterpret_cast<XrActionSet>(handleValue);
-    g_nextActionSetHandle = handle;
-    g_actionSets[handle] = xrActionSet;
+    XrActionSet handle = g_actionSets.Insert(xrActionSet);
+    if (handle == XR_NULL_HANDLE) {
+        LOGE("Action set limit reached (%u)", g_actionSets.Capacity());
+        return XR_ERROR_LIMIT_REACHED;
+    }
     *actionSet = handle;
     
     LOGI("Action set created: %p, name: %s", handle, createInfo->actionSetName);
@@ -80,14 +74,10 @@ XrResult xrDestroyActionSet(XrActionSet actionSet) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    std::lock_guard<std::mutex> lock(g_actionSetMutex);
-    auto it = g_actionSets.find(actionSet);
-    if (it == g_actionSets.end()) {
+    if (!g_actionSets.Remove(actionSet)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    g_actionSets.erase(it);
-    
     LOGI("Action set destroyed: %p", actionSet);
     return XR_SUCCESS;
 }
@@ -102,9 +92,7 @@ XrResult xrCreateAction(XrActionSet actionSet, const XrActionCreateInfo* createI
     }
     
     // Validate action set
-    std::lock_guard<std::mutex> setLock(g_actionSetMutex);
-    auto setIt = g_actionSets.find(actionSet);
-    if (setIt == g_actionSets.end()) {
+    if (!g_actionSets.Lookup(actionSet)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -116,13 +104,11 @@ XrResult xrCreateAction(XrActionSet actionSet, const XrActionCreateInfo* createI
     xrAction->localizedActionName = createInfo->localizedActionName;
     
     // Register action
-    std::lock_guard<std::mutex> actLock(g_actionMutex);
-    // Increment handle using integer arithmetic (handles are pointers in 64-bit)
-    uintptr_t handleValue = reinterpret_cast<uintptr_t>(g_nextActionHandle);
-    handleValue++;
-    XrAction handle = reinterpret_cast<XrAction>(handleValue);
-    g_nextActionHandle = handle;
-    g_actions[handle] = xrAction;
+    XrAction handle = g_actions.Insert(xrAction);
+    if (handle == XR_NULL_HANDLE) {
+        LOGE("Action limit reached (%u)", g_actions.Capacity());
+        return XR_ERROR_LIMIT_REACHED;
+    }
     *action = handle;
     
     LOGI("Action created: %p, name: %s, type: %d", handle, createInfo->actionName, createInfo->actionType);
@@ -134,14 +120,10 @@ XrResult xrDestroyAction(XrAction action) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    std::lock_guard<std::mutex> lock(g_actionMutex);
-    auto it = g_actions.find(action);
-    if (it == g_actions.end()) {
+    if (!g_actions.Remove(action)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    g_actions.erase(it);
-    
     LOGI("Action destroyed: %p", action);
     return XR_SUCCESS;
 }
@@ -156,17 +138,34 @@ XrResult xrSuggestInteractionProfileBindings(XrInstance instance, const XrIntera
     }
     
     // Validate instance
-    std::lock_guard<std::mutex> instLock(g_instanceMutex);
-    auto instIt = g_instances.find(instance);
-    if (instIt == g_instances.end()) {
+    XRInstance* xrInstance = g_instances.Lookup(instance);
+    if (!xrInstance) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
+    // Bindings are frozen once a session of this instance has attached
+    // action sets
+    if (xrInstance->inputBindings->frozen.load(std::memory_order_acquire)) {
+        return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
+    }
+    
+    // Validate actions; the type decides which state each binding feeds
+    std::vector<XrActionType> actionTypes(suggestedBindings->countSuggestedBindings);
+    for (uint32_t i = 0; i < suggestedBindings->countSuggestedBindings; ++i) {
+        XRAction* xrAction = g_actions.Lookup(suggestedBindings->suggestedBindings[i].action);
+        if (!xrAction) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        actionTypes[i] = xrAction->actionType;
+    }
+    
     // Register bindings
-    if (!RegisterInteractionProfileBindings(suggestedBindings->interactionProfile, 
+    if (!RegisterInteractionProfileBindings(instance, suggestedBindings->interactionProfile, 
                                             suggestedBindings->suggestedBindings, 
+                                            actionTypes.data(),
                                             suggestedBindings->countSuggestedBindings)) {
-        return XR_ERROR_RUNTIME_FAILURE;
+        return xrInstance->inputBindings->frozen.load(std::memory_order_acquire) 
+                   ? XR_ERROR_ACTIONSETS_ALREADY_ATTACHED : XR_ERROR_RUNTIME_FAILURE;
     }
     
     LOGI("Interaction profile bindings registered");
@@ -183,15 +182,14 @@ XrResult xrAttachSessionActionSets(XrSession session, const XrSessionActionSetsA
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    // Attach action sets
-    if (!AttachActionSetsToSession(session, attachInfo->actionSets, attachInfo->countActionSets)) {
-        return XR_ERROR_RUNTIME_FAILURE;
+    // Attach action sets, once per session
+    if (!AttachActionSetsToSession(sess, attachInfo->actionSets, attachInfo->countActionSets)) {
+        return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
     }
     
     LOGI("Action sets attached to session");
@@ -212,32 +210,38 @@ XrResult xrGetActionStateBoolean(XrSession session, const XrActionStateGetInfo*
     }
     
     // Validate session and action
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    std::lock_guard<std::mutex> actLock(g_actionMutex);
-    auto actIt = g_actions.find(getInfo->action);
-    if (actIt == g_actions.end()) {
+    XRAction* xrAction = g_actions.Lookup(getInfo->action);
+    if (!xrAction) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    // Get action state from input manager
-    bool currentState;
-    bool changedSinceLastSync;
+    if (xrAction->actionType != XR_ACTION_TYPE_BOOLEAN_INPUT) {
+        return XR_ERROR_ACTION_TYPE_MISMATCH;
+    }
+    
+    if (!IsActionSetAttached(*sess, xrAction->actionSet)) {
+        return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+    }
     
-    if (!GetBooleanActionState(getInfo->action, getInfo->subactionPath, 
-                               &currentState, &changedSinceLastSync)) {
+    // Read the snapshot published by the last xrSyncActions
+    ActionStateValue value;
+    if (!GetActionStateValue(*sess->inputBindings, sess->actionState, getInfo->action, getInfo->subactionPath, &value)) {
         state->currentState = XR_FALSE;
         state->changedSinceLastSync = XR_FALSE;
+        state->lastChangeTime = 0;
+        state->isActive = XR_FALSE;
         return XR_SUCCESS;
     }
     
-    state->currentState = currentState ? XR_TRUE : XR_FALSE;
-    state->changedSinceLastSync = changedSinceLastSync ? XR_TRUE : XR_FALSE;
-    state->lastChangeTime = GetCurrentXrTime();
+    state->currentState = value.booleanState ? XR_TRUE : XR_FALSE;
+    state->changedSinceLastSync = value.changedSinceLastSync ? XR_TRUE : XR_FALSE;
+    state->lastChangeTime = value.lastChangeTime;
+    state->isActive = value.isActive ? XR_TRUE : XR_FALSE;
     
     return XR_SUCCESS;
 }
@@ -256,32 +260,38 @@ XrResult xrGetActionStateFloat(XrSession session, const XrActionStateGetInfo* ge
     }
     
     // Validate session and action
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    std::lock_guard<std::mutex> actLock(g_actionMutex);
-    auto actIt = g_actions.find(getInfo->action);
-    if (actIt == g_actions.end()) {
+    XRAction* xrAction = g_actions.Lookup(getInfo->action);
+    if (!xrAction) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    // Get action state from input manager
-    float currentState;
-    bool changedSinceLastSync;
+    if (xrAction->actionType != XR_ACTION_TYPE_FLOAT_INPUT) {
+        return XR_ERROR_ACTION_TYPE_MISMATCH;
+    }
     
-    if (!GetFloatActionState(getInfo->action, getInfo->subactionPath, 
-                             &currentState, &changedSinceLastSync)) {
+    if (!IsActionSetAttached(*sess, xrAction->actionSet)) {
+        return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+    }
+    
+    // Read the snapshot published by the last xrSyncActions
+    ActionStateValue value;
+    if (!GetActionStateValue(*sess->inputBindings, sess->actionState, getInfo->action, getInfo->subactionPath, &value)) {
         state->currentState = 0.0f;
         state->changedSinceLastSync = XR_FALSE;
+        state->lastChangeTime = 0;
+        state->isActive = XR_FALSE;
         return XR_SUCCESS;
     }
     
-    state->currentState = currentState;
-    state->changedSinceLastSync = changedSinceLastSync ? XR_TRUE : XR_FALSE;
-    state->lastChangeTime = GetCurrentXrTime();
+    state->currentState = value.floatState;
+    state->changedSinceLastSync = value.changedSinceLastSync ? XR_TRUE : XR_FALSE;
+    state->lastChangeTime = value.lastChangeTime;
+    state->isActive = value.isActive ? XR_TRUE : XR_FALSE;
     
     return XR_SUCCESS;
 }
@@ -300,32 +310,38 @@ XrResult xrGetActionStateVector2f(XrSession session, const XrActionStateGetInfo*
     }
     
     // Validate session and action
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    std::lock_guard<std::mutex> actLock(g_actionMutex);
-    auto actIt = g_actions.find(getInfo->action);
-    if (actIt == g_actions.end()) {
+    XRAction* xrAction = g_actions.Lookup(getInfo->action);
+    if (!xrAction) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    // Get action state from input manager
-    XrVector2f currentState;
-    bool changedSinceLastSync;
+    if (xrAction->actionType != XR_ACTION_TYPE_VECTOR2F_INPUT) {
+        return XR_ERROR_ACTION_TYPE_MISMATCH;
+    }
+    
+    if (!IsActionSetAttached(*sess, xrAction->actionSet)) {
+        return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+    }
     
-    if (!GetVector2fActionState(getInfo->action, getInfo->subactionPath, 
-                                 &currentState, &changedSinceLastSync)) {
+    // Read the snapshot published by the last xrSyncActions
+    ActionStateValue value;
+    if (!GetActionStateValue(*sess->inputBindings, sess->actionState, getInfo->action, getInfo->subactionPath, &value)) {
         state->currentState = {0.0f, 0.0f};
         state->changedSinceLastSync = XR_FALSE;
+        state->lastChangeTime = 0;
+        state->isActive = XR_FALSE;
         return XR_SUCCESS;
     }
     
-    state->currentState = currentState;
-    state->changedSinceLastSync = changedSinceLastSync ? XR_TRUE : XR_FALSE;
-    state->lastChangeTime = GetCurrentXrTime();
+    state->currentState = value.vector2fState;
+    state->changedSinceLastSync = value.changedSinceLastSync ? XR_TRUE : XR_FALSE;
+    state->lastChangeTime = value.lastChangeTime;
+    state->isActive = value.isActive ? XR_TRUE : XR_FALSE;
     
     return XR_SUCCESS;
 }
@@ -344,27 +360,32 @@ XrResult xrGetActionStatePose(XrSession session, const XrActionStateGetInfo* get
     }
     
     // Validate session and action
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    std::lock_guard<std::mutex> actLock(g_actionMutex);
-    auto actIt = g_actions.find(getInfo->action);
-    if (actIt == g_actions.end()) {
+    XRAction* xrAction = g_actions.Lookup(getInfo->action);
+    if (!xrAction) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    // Get pose state from input manager
-    bool isActive;
+    if (xrAction->actionType != XR_ACTION_TYPE_POSE_INPUT) {
+        return XR_ERROR_ACTION_TYPE_MISMATCH;
+    }
     
-    if (!GetPoseActionState(getInfo->action, getInfo->subactionPath, &isActive)) {
+    if (!IsActionSetAttached(*sess, xrAction->actionSet)) {
+        return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+    }
+    
+    // Read the snapshot published by the last xrSyncActions
+    ActionStateValue value;
+    if (!GetActionStateValue(*sess->inputBindings, sess->actionState, getInfo->action, getInfo->subactionPath, &value)) {
         state->isActive = XR_FALSE;
         return XR_SUCCESS;
     }
     
-    state->isActive = isActive ? XR_TRUE : XR_FALSE;
+    state->isActive = value.isActive ? XR_TRUE : XR_FALSE;
     
     return XR_SUCCESS;
 }
@@ -378,15 +399,28 @@ XrResult xrSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) {
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
+    if (syncInfo->countActiveActionSets > 0 && !syncInfo->activeActionSets) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    // Sync actions from input devices
-    if (!SyncInputActions()) {
+    // The binding table is only stable once attached
+    if (!sess->actionSetsAttached.load(std::memory_order_acquire)) {
+        return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+    }
+    for (uint32_t i = 0; i < syncInfo->countActiveActionSets; ++i) {
+        if (!IsActionSetAttached(*sess, syncInfo->activeActionSets[i].actionSet)) {
+            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+        }
+    }
+    
+    // Sync actions from input devices and publish a new state snapshot
+    if (!SyncInputActions(*sess->inputBindings, &sess->actionState)) {
         return XR_ERROR_RUNTIME_FAILURE;
     }
     
@@ -403,9 +437,7 @@ XrResult xrGetCurrentInteractionProfile(XrSession session, XrPath topLevelUserPa
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    if (!g_sessions.Lookup(session)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -1,4 +1,6 @@
 #include "openxr_api.h"
+#include "instance.h"
+#include "handle_table.h"
 #include "platform/android_platform.h"
 #include "qualcomm/xr2_platform.h"
 #include "utils/logger.h"
@@ -6,30 +8,15 @@
 #include <cstring>
 #include <cstdint>
 #include <mutex>
-#include <unordered_map>
 #include <atomic>
 #include <memory>
 
 // External runtime initialization
 extern std::atomic<bool> g_runtimeInitialized;
 
-struct XRInstance {
-    XrInstanceProperties properties;
-    XrSystemId systemId;
-    bool initialized;
-    std::mutex mutex;
-    
-    XRInstance() : initialized(false) {
-        memset(&properties, 0, sizeof(properties));
-        properties.type = XR_TYPE_INSTANCE_PROPERTIES;
-        strncpy(properties.runtimeName, "Custom XR2 Runtime", XR_MAX_RUNTIME_NAME_SIZE - 1);
-        properties.runtimeVersion = XR_MAKE_VERSION(1, 1, 0);
-    }
-};
+static const uint32_t MAX_INSTANCES = 4;
 
-std::mutex g_instanceMutex;
-std::unordered_map<XrInstance, std::shared_ptr<XRInstance>> g_instances;
-static XrInstance g_nextInstanceHandle = reinterpret_cast<XrInstance>(1);
+HandleTable<XRInstance, XrInstance> g_instances(HANDLE_TYPE_INSTANCE, MAX_INSTANCES);
 
 XrResult xrCreateInstance(const XrInstanceCreateInfo* createInfo, XrInstance* instance) {
     if (!createInfo || !instance) {
@@ -68,13 +55,11 @@ XrResult xrCreateInstance(const XrInstanceCreateInfo* createInfo, XrInstance* in
     xrInstance->initialized = true;
     
     // Register instance
-    std::lock_guard<std::mutex> lock(g_instanceMutex);
-    // Increment handle using integer arithmetic (handles are pointers in 64-bit)
-    uintptr_t handleValue = reinterpret_cast<uintptr_t>(g_nextInstanceHandle);
-    handleValue++;
-    XrInstance handle = reinterpret_cast<XrInstance>(handleValue);
-    g_nextInstanceHandle = handle;
-    g_instances[handle] = xrInstance;
+    XrInstance handle = g_instances.Insert(xrInstance);
+    if (handle == XR_NULL_HANDLE) {
+        LOGE("Instance limit reached");
+        return XR_ERROR_LIMIT_REACHED;
+    }
     *instance = handle;
     
     LOGI("Instance created: %p", handle);
@@ -88,9 +73,7 @@ XrResult xrDestroyInstance(XrInstance instance) {
     
     LOGI("xrDestroyInstance called for instance: %p", instance);
     
-    std::lock_guard<std::mutex> lock(g_instanceMutex);
-    auto it = g_instances.find(instance);
-    if (it == g_instances.end()) {
+    if (!g_instances.Remove(instance)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -98,8 +81,6 @@ XrResult xrDestroyInstance(XrInstance instance) {
     ShutdownXR2Platform();
     ShutdownAndroidPlatform();
     
-    g_instances.erase(it);
-    
     LOGI("Instance destroyed");
     return XR_SUCCESS;
 }
@@ -113,13 +94,12 @@ XrResult xrGetInstanceProperties(XrInstance instance, XrInstanceProperties* inst
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
-    std::lock_guard<std::mutex> lock(g_instanceMutex);
-    auto it = g_instances.find(instance);
-    if (it == g_instances.end()) {
+    XRInstance* xrInstance = g_instances.Lookup(instance);
+    if (!xrInstance) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    *instanceProperties = it->second->properties;
+    *instanceProperties = xrInstance->properties;
     return XR_SUCCESS;
 }
 
@@ -132,9 +112,8 @@ XrResult xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSyst
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
-    std::lock_guard<std::mutex> lock(g_instanceMutex);
-    auto it = g_instances.find(instance);
-    if (it == g_instances.end()) {
+    XRInstance* xrInstance = g_instances.Lookup(instance);
+    if (!xrInstance) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -144,12 +123,12 @@ XrResult xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSyst
         return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
     }
     
-    // Create system ID (simple implementation)
-    if (it->second->systemId == XR_NULL_SYSTEM_ID) {
-        it->second->systemId = 1; // Simple system ID
-    }
+    // Create system ID (simple implementation). A racing xrGetSystem gets
+    // the same id.
+    XrSystemId expected = XR_NULL_SYSTEM_ID;
+    xrInstance->systemId.compare_exchange_strong(expected, 1); // Simple system ID
     
-    *systemId = it->second->systemId;
+    *systemId = xrInstance->systemId.load();
     
     LOGI("System ID: %llu", *systemId);
     return XR_SUCCESS;
@@ -164,13 +143,12 @@ XrResult xrGetSystemProperties(XrInstance instance, XrSystemId systemId, XrSyste
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
-    std::lock_guard<std::mutex> lock(g_instanceMutex);
-    auto it = g_instances.find(instance);
-    if (it == g_instances.end()) {
+    XRInstance* xrInstance = g_instances.Lookup(instance);
+    if (!xrInstance) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    if (it->second->systemId != systemId) {
+    if (systemId == XR_NULL_SYSTEM_ID || xrInstance->systemId.load() != systemId) {
         return XR_ERROR_SYSTEM_INVALID;
     }
     
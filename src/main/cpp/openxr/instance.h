@@ -0,0 +1,34 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <openxr/openxr.h>
+#include "path_registry.h"
+#include "platform/input_manager.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+// Instance object shared by the instance, path and input modules
+struct XRInstance {
+    XrInstanceProperties properties;
+    std::atomic<XrSystemId> systemId;  // Set once by xrGetSystem, read without the lock
+    bool initialized;
+    std::mutex mutex;
+    PathRegistry paths;
+    std::shared_ptr<InputBindingTable> inputBindings;  // Outlives the instance while sessions use it
+    
+    XRInstance() : systemId(XR_NULL_SYSTEM_ID), initialized(false),
+                   inputBindings(std::make_shared<InputBindingTable>()) {
+        memset(&properties, 0, sizeof(properties));
+        properties.type = XR_TYPE_INSTANCE_PROPERTIES;
+        strncpy(properties.runtimeName, "Custom XR2 Runtime", XR_MAX_RUNTIME_NAME_SIZE - 1);
+        properties.runtimeVersion = XR_MAKE_VERSION(1, 1, 0);
+        
+        // Subaction paths are compared as XrPath values, never as strings
+        paths.StringToPath("/user/hand/left", &inputBindings->handPaths[0]);
+        paths.StringToPath("/user/hand/right", &inputBindings->handPaths[1]);
+    }
+};
+
+#endif // INSTANCE_H
@@ -1,17 +1,17 @@
 #include "openxr_api.h"
 #include "utils/logger.h"
 #include "utils/error_handler.h"
+#include "utils/trace.h"
 #include "platform/android_platform.h"
 #include "platform/display_manager.h"
 #include "qualcomm/xr2_platform.h"
-#include <unordered_map>
+#include "handle_table.h"
+#include "instance.h"
 #include <atomic>
-#include <mutex>
 #include <cstring>
-#include <string>
+#include <string_view>
 
 // Forward declarations
-struct XRInstance;
 struct XRSession;
 struct XRSpace;
 struct XRSwapchain;
@@ -22,23 +22,12 @@ struct XRAction;
 std::atomic<bool> g_runtimeInitialized(false);
 
 // External declarations from other modules
-extern std::mutex g_instanceMutex;
-extern std::unordered_map<XrInstance, std::shared_ptr<XRInstance>> g_instances;
-
-extern std::mutex g_sessionMutex;
-extern std::unordered_map<XrSession, std::shared_ptr<XRSession>> g_sessions;
-
-extern std::mutex g_spaceMutex;
-extern std::unordered_map<XrSpace, std::shared_ptr<XRSpace>> g_spaces;
-
-extern std::mutex g_swapchainMutex;
-extern std::unordered_map<XrSwapchain, std::shared_ptr<XRSwapchain>> g_swapchains;
-
-extern std::mutex g_actionSetMutex;
-extern std::unordered_map<XrActionSet, std::shared_ptr<XRActionSet>> g_actionSets;
-
-extern std::mutex g_actionMutex;
-extern std::unordered_map<XrAction, std::shared_ptr<XRAction>> g_actions;
+extern HandleTable<XRInstance, XrInstance> g_instances;
+extern HandleTable<XRSession, XrSession> g_sessions;
+extern HandleTable<XRSpace, XrSpace> g_spaces;
+extern HandleTable<XRSwapchain, XrSwapchain> g_swapchains;
+extern HandleTable<XRActionSet, XrActionSet> g_actionSets;
+extern HandleTable<XRAction, XrAction> g_actions;
 
 bool InitializeXRRuntime() {
     if (g_runtimeInitialized.exchange(true)) {
@@ -48,9 +37,16 @@ bool InitializeXRRuntime() {
     
     LOGI("Initializing XR Runtime for Qualcomm XR2");
     
+    // Log messages and hot-path trace records are written from background
+    // threads from here on
+    StartLogThread();
+    StartTraceDrain();
+    
     // Initialize platform layer
     if (!InitializeAndroidPlatform()) {
         LOGE("Failed to initialize Android platform");
+        StopTraceDrain();
+        StopLogThread();
         return false;
     }
     
@@ -58,6 +54,8 @@ bool InitializeXRRuntime() {
     if (!InitializeXR2Platform()) {
         LOGE("Failed to initialize XR2 platform");
         ShutdownAndroidPlatform();
+        StopTraceDrain();
+        StopLogThread();
         return false;
     }
     
@@ -72,41 +70,27 @@ void ShutdownXRRuntime() {
     
     LOGI("Shutting down XR Runtime");
     
-    // Destroy all remaining resources
-    {
-        std::lock_guard<std::mutex> lock(g_actionMutex);
-        g_actions.clear();
-    }
-    
-    {
-        std::lock_guard<std::mutex> lock(g_actionSetMutex);
-        g_actionSets.clear();
-    }
-    
-    {
-        std::lock_guard<std::mutex> lock(g_swapchainMutex);
-        g_swapchains.clear();
-    }
-    
-    {
-        std::lock_guard<std::mutex> lock(g_spaceMutex);
-        g_spaces.clear();
-    }
-    
-    {
-        std::lock_guard<std::mutex> lock(g_sessionMutex);
-        g_sessions.clear();
-    }
-    
-    {
-        std::lock_guard<std::mutex> lock(g_instanceMutex);
-        g_instances.clear();
+    // Destroy all remaining resources, children before parents
+    g_actions.Clear();
+    g_actionSets.Clear();
+    g_swapchains.Clear();
+    g_spaces.Clear();
+    
+    // Through xrDestroySession so a running session's compositor, vsync
+    // and governor threads stop before the platform goes away
+    XrSession session;
+    while ((session = g_sessions.First()) != XR_NULL_HANDLE) {
+        xrDestroySession(session);
     }
+    g_sessions.Clear();
+    g_instances.Clear();
     
     ShutdownXR2Platform();
     ShutdownAndroidPlatform();
+    StopTraceDrain();
     
     LOGI("XR Runtime shutdown complete");
+    StopLogThread();
 }
 
 // Additional OpenXR API implementations
@@ -117,31 +101,12 @@ XrResult xrStringToPath(XrInstance instance, const char* pathString, XrPath* pat
     }
     
     // Validate instance
-    std::lock_guard<std::mutex> instLock(g_instanceMutex);
-    auto instIt = g_instances.find(instance);
-    if (instIt == g_instances.end()) {
+    XRInstance* xrInstance = g_instances.Lookup(instance);
+    if (!xrInstance) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    // Simple path string to path conversion
-    // In a real implementation, this would maintain a path registry
-    static std::mutex pathMutex;
-    static std::unordered_map<std::string, XrPath> pathMap;
-    static std::unordered_map<XrPath, std::string> pathToStringMap; // Reverse mapping
-    static XrPath nextPath = 1;
-    
-    std::lock_guard<std::mutex> lock(pathMutex);
-    auto it = pathMap.find(pathString);
-    if (it != pathMap.end()) {
-        *path = it->second;
-    } else {
-        *path = nextPath++;
-        pathMap[pathString] = *path;
-        // Also register reverse mapping for path to string conversion
-        pathToStringMap[*path] = pathString;
-    }
-    
-    return XR_SUCCESS;
+    return xrInstance->paths.StringToPath(pathString, path);
 }
 
 XrResult xrPathToString(XrInstance instance, XrPath path, uint32_t bufferCapacityInput, 
@@ -151,33 +116,35 @@ XrResult xrPathToString(XrInstance instance, XrPath path, uint32_t bufferCapacit
     }
     
     // Validate instance
-    std::lock_guard<std::mutex> instLock(g_instanceMutex);
-    auto instIt = g_instances.find(instance);
-    if (instIt == g_instances.end()) {
+    XRInstance* xrInstance = g_instances.Lookup(instance);
+    if (!xrInstance) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    // Simple path to string conversion
-    // Use the same registry as xrStringToPath
-    static std::mutex pathMutex;
-    static std::unordered_map<XrPath, std::string> pathToStringMap;
-    
-    std::lock_guard<std::mutex> lock(pathMutex);
-    auto it = pathToStringMap.find(path);
-    if (it == pathToStringMap.end()) {
+    std::string_view pathString = xrInstance->paths.PathToString(path);
+    if (pathString.empty()) {
         return XR_ERROR_PATH_INVALID;
     }
     
-    const std::string& pathString = it->second;
-    uint32_t requiredSize = static_cast<uint32_t>(pathString.length() + 1);
-    
+    uint32_t requiredSize = static_cast<uint32_t>(pathString.size() + 1);
     *bufferCountOutput = requiredSize;
     
-    if (buffer && bufferCapacityInput >= requiredSize) {
-        strncpy(buffer, pathString.c_str(), bufferCapacityInput - 1);
-        buffer[bufferCapacityInput - 1] = '\0';
+    // Capacity 0 is a size query
+    if (bufferCapacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    
+    if (!buffer) {
+        return XR_ERROR_VALIDATION_FAILURE;
     }
     
+    if (bufferCapacityInput < requiredSize) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    
+    memcpy(buffer, pathString.data(), pathString.size());
+    buffer[pathString.size()] = '\0';
+    
     return XR_SUCCESS;
 }
 
@@ -190,9 +157,7 @@ XrResult xrEnumerateViewConfigurations(XrInstance instance, XrSystemId systemId,
     }
     
     // Validate instance
-    std::lock_guard<std::mutex> instLock(g_instanceMutex);
-    auto instIt = g_instances.find(instance);
-    if (instIt == g_instances.end()) {
+    if (!g_instances.Lookup(instance)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -219,9 +184,7 @@ XrResult xrGetViewConfigurationProperties(XrInstance instance, XrSystemId system
     }
     
     // Validate instance
-    std::lock_guard<std::mutex> instLock(g_instanceMutex);
-    auto instIt = g_instances.find(instance);
-    if (instIt == g_instances.end()) {
+    if (!g_instances.Lookup(instance)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -244,9 +207,7 @@ XrResult xrEnumerateViewConfigurationViews(XrInstance instance, XrSystemId syste
     }
     
     // Validate instance
-    std::lock_guard<std::mutex> instLock(g_instanceMutex);
-    auto instIt = g_instances.find(instance);
-    if (instIt == g_instances.end()) {
+    if (!g_instances.Lookup(instance)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -275,9 +236,7 @@ XrResult xrGetReferenceSpaceBoundsRect(XrSession session, XrReferenceSpaceType r
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    if (!g_sessions.Lookup(session)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
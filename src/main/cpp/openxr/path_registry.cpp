@@ -0,0 +1,156 @@
+#include "path_registry.h"
+#include "utils/logger.h"
+#include <cstring>
+
+// Enough for every interaction profile and binding path an app suggests
+static const uint32_t MAX_PATHS = 4096;
+static const uint32_t PATH_BUCKET_COUNT = MAX_PATHS * 2;  // Power of two, load <= 0.5
+static const size_t ARENA_CHUNK_SIZE = 16 * 1024;
+
+// FNV-1a
+static uint32_t HashPathString(std::string_view pathString) {
+    uint32_t hash = 2166136261u;
+    for (char c : pathString) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Well-formed path: "/component/component...", components made of
+// [a-z0-9-_.], not empty and not made only of periods, no trailing slash
+static bool IsValidPathString(std::string_view pathString) {
+    if (pathString.empty() || pathString.size() >= XR_MAX_PATH_LENGTH) {
+        return false;
+    }
+    if (pathString.front() != '/' || pathString.back() == '/') {
+        return false;
+    }
+
+    size_t componentLength = 0;
+    bool componentAllPeriods = true;
+    for (size_t i = 1; i <= pathString.size(); ++i) {
+        char c = (i < pathString.size()) ? pathString[i] : '/';
+        if (c == '/') {
+            if (componentLength == 0 || componentAllPeriods) {
+                return false;
+            }
+            componentLength = 0;
+            componentAllPeriods = true;
+            continue;
+        }
+
+        bool valid = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                     c == '-' || c == '_' || c == '.';
+        if (!valid) {
+            return false;
+        }
+        if (c != '.') {
+            componentAllPeriods = false;
+        }
+        componentLength++;
+    }
+    return true;
+}
+
+PathRegistry::PathRegistry()
+    : entries_(new Entry[MAX_PATHS]),
+      buckets_(new std::atomic<uint32_t>[PATH_BUCKET_COUNT]),
+      count_(0),
+      arenaOffset_(ARENA_CHUNK_SIZE) {
+    for (uint32_t i = 0; i < PATH_BUCKET_COUNT; ++i) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+XrPath PathRegistry::Find(std::string_view pathString, uint32_t hash) const {
+    uint32_t mask = PATH_BUCKET_COUNT - 1;
+    for (uint32_t probe = 0; probe < PATH_BUCKET_COUNT; ++probe) {
+        uint32_t value = buckets_[(hash + probe) & mask].load(std::memory_order_acquire);
+        if (value == 0) {
+            return XR_NULL_PATH;
+        }
+
+        // Entry is fully written before its bucket is published
+        const Entry& entry = entries_[value - 1];
+        if (entry.hash == hash && entry.length == pathString.size() &&
+            memcmp(entry.data, pathString.data(), entry.length) == 0) {
+            return static_cast<XrPath>(value);
+        }
+    }
+    return XR_NULL_PATH;
+}
+
+const char* PathRegistry::StoreString(std::string_view pathString) {
+    size_t size = pathString.size() + 1;
+    if (arenaOffset_ + size > ARENA_CHUNK_SIZE) {
+        arenaChunks_.emplace_back(new char[ARENA_CHUNK_SIZE]);
+        arenaOffset_ = 0;
+    }
+
+    char* data = arenaChunks_.back().get() + arenaOffset_;
+    memcpy(data, pathString.data(), pathString.size());
+    data[pathString.size()] = '\0';
+    arenaOffset_ += size;
+    return data;
+}
+
+XrResult PathRegistry::StringToPath(const char* pathString, XrPath* path) {
+    std::string_view view(pathString, strnlen(pathString, XR_MAX_PATH_LENGTH));
+    if (!IsValidPathString(view)) {
+        return XR_ERROR_PATH_FORMAT_INVALID;
+    }
+
+    // Fast path: already interned
+    uint32_t hash = HashPathString(view);
+    XrPath existing = Find(view, hash);
+    if (existing != XR_NULL_PATH) {
+        *path = existing;
+        return XR_SUCCESS;
+    }
+
+    std::lock_guard<std::mutex> lock(writerMutex_);
+
+    // Another thread may have interned it while we waited
+    existing = Find(view, hash);
+    if (existing != XR_NULL_PATH) {
+        *path = existing;
+        return XR_SUCCESS;
+    }
+
+    uint32_t index = count_.load(std::memory_order_relaxed);
+    if (index >= MAX_PATHS) {
+        LOGE("Path limit reached (%u)", MAX_PATHS);
+        return XR_ERROR_PATH_COUNT_EXCEEDED;
+    }
+
+    Entry& entry = entries_[index];
+    entry.data = StoreString(view);
+    entry.length = static_cast<uint32_t>(view.size());
+    entry.hash = hash;
+
+    // Publish to reverse lookups, then to forward lookups
+    uint32_t value = index + 1;
+    count_.store(value, std::memory_order_release);
+
+    uint32_t mask = PATH_BUCKET_COUNT - 1;
+    for (uint32_t probe = 0; probe < PATH_BUCKET_COUNT; ++probe) {
+        std::atomic<uint32_t>& bucket = buckets_[(hash + probe) & mask];
+        if (bucket.load(std::memory_order_relaxed) == 0) {
+            bucket.store(value, std::memory_order_release);
+            break;
+        }
+    }
+
+    *path = static_cast<XrPath>(value);
+    return XR_SUCCESS;
+}
+
+std::string_view PathRegistry::PathToString(XrPath path) const {
+    if (path == XR_NULL_PATH || path > count_.load(std::memory_order_acquire)) {
+        return std::string_view();
+    }
+
+    const Entry& entry = entries_[path - 1];
+    return std::string_view(entry.data, entry.length);
+}
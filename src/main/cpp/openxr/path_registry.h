@@ -0,0 +1,53 @@
+#ifndef PATH_REGISTRY_H
+#define PATH_REGISTRY_H
+
+#include <openxr/openxr.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Instance-scoped XrPath interner.
+// Each string is stored once in an append-only arena and never moves, so the
+// views handed out stay valid for the lifetime of the owning instance.
+// XrPath values are dense (1..count): path-to-string is an array index and
+// string-to-path is an open-addressing hash. Both lookups are lock-free;
+// only interning a new string takes the writer mutex.
+class PathRegistry {
+public:
+    PathRegistry();
+
+    PathRegistry(const PathRegistry&) = delete;
+    PathRegistry& operator=(const PathRegistry&) = delete;
+
+    // Intern a path string. Returns XR_ERROR_PATH_FORMAT_INVALID for
+    // malformed paths and XR_ERROR_PATH_COUNT_EXCEEDED when full.
+    XrResult StringToPath(const char* pathString, XrPath* path);
+
+    // Lock-free reverse lookup; returns an empty view for unknown paths
+    std::string_view PathToString(XrPath path) const;
+
+    uint32_t Count() const { return count_.load(std::memory_order_acquire); }
+
+private:
+    struct Entry {
+        const char* data;
+        uint32_t length;
+        uint32_t hash;
+    };
+
+    XrPath Find(std::string_view pathString, uint32_t hash) const;
+    const char* StoreString(std::string_view pathString);
+
+    std::unique_ptr<Entry[]> entries_;                  // Indexed by XrPath - 1
+    std::unique_ptr<std::atomic<uint32_t>[]> buckets_;  // 0 = empty, else XrPath
+    std::atomic<uint32_t> count_;
+
+    std::mutex writerMutex_;
+    std::vector<std::unique_ptr<char[]>> arenaChunks_;
+    size_t arenaOffset_;
+};
+
+#endif // PATH_REGISTRY_H
@@ -1,32 +1,48 @@
 #include "openxr_api.h"
+#include "session.h"
+#include "handle_table.h"
+#include "instance.h"
 #include "platform/android_platform.h"
+#include "platform/vsync_source.h"
+#include "platform/frame_telemetry.h"
+#include "platform/frame_sync.h"
+#include "platform/compositor.h"
+#include "platform/display_manager.h"
 #include "qualcomm/xr2_platform.h"
+#include "qualcomm/perf_governor.h"
 #include "utils/logger.h"
 #include <cstring>
 #include <cstdint>
 #include <mutex>
 #include <atomic>
-#include <unordered_map>
 #include <memory>
 
 // External declarations
-extern std::mutex g_instanceMutex;
-extern std::unordered_map<XrInstance, std::shared_ptr<XRInstance>> g_instances;
+extern HandleTable<XRInstance, XrInstance> g_instances;
 
-struct XRSession {
-    XrInstance instance;
-    XrSessionState state;
-    XrViewConfigurationType viewConfigType;
-    bool active;
-    std::mutex mutex;
-    
-    XRSession(XrInstance inst) : instance(inst), state(XR_SESSION_STATE_UNKNOWN), 
-                                 viewConfigType(XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO), active(false) {}
-};
+static const uint32_t MAX_SESSIONS = 8;
 
-std::mutex g_sessionMutex;
-std::unordered_map<XrSession, std::shared_ptr<XRSession>> g_sessions;
-static XrSession g_nextSessionHandle = reinterpret_cast<XrSession>(0x1000);
+HandleTable<XRSession, XrSession> g_sessions(HANDLE_TYPE_SESSION, MAX_SESSIONS);
+
+// The vsync source, input sampler, compositor and perf governor are global
+// and the compositor queue has a single producer, so only one session runs
+// at a time. Guarded by g_runningSessionMutex.
+static std::mutex g_runningSessionMutex;
+static XrSession g_runningSession = XR_NULL_HANDLE;
+
+// Stop what xrBeginSession started and let another session begin
+static void StopRunningSession(XrSession session) {
+    StopVsyncSource();
+    StopXR2InputSampling();
+    StopPerfGovernor();
+    StopCompositor();
+    StopXR2Rendering();
+    
+    std::lock_guard<std::mutex> lock(g_runningSessionMutex);
+    if (g_runningSession == session) {
+        g_runningSession = XR_NULL_HANDLE;
+    }
+}
 
 XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) {
     if (!createInfo || !session) {
@@ -40,9 +56,8 @@ XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createI
     LOGI("xrCreateSession called");
     
     // Validate instance
-    std::lock_guard<std::mutex> instLock(g_instanceMutex);
-    auto instIt = g_instances.find(instance);
-    if (instIt == g_instances.end()) {
+    XRInstance* xrInstance = g_instances.Lookup(instance);
+    if (!xrInstance) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -54,6 +69,7 @@ XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createI
     
     // Create session
     auto xrSession = std::make_shared<XRSession>(instance);
+    xrSession->inputBindings = xrInstance->inputBindings;
     
     // Initialize display and tracking
     if (!InitializeXR2Display()) {
@@ -70,13 +86,13 @@ XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createI
     xrSession->state = XR_SESSION_STATE_IDLE;
     
     // Register session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    // Increment handle using integer arithmetic (handles are pointers in 64-bit)
-    uintptr_t handleValue = reinterpret_cast<uintptr_t>(g_nextSessionHandle);
-    handleValue++;
-    XrSession handle = reinterpret_cast<XrSession>(handleValue);
-    g_nextSessionHandle = handle;
-    g_sessions[handle] = xrSession;
+    XrSession handle = g_sessions.Insert(xrSession);
+    if (handle == XR_NULL_HANDLE) {
+        LOGE("Session limit reached");
+        ShutdownXR2Tracking();
+        ShutdownXR2Display();
+        return XR_ERROR_LIMIT_REACHED;
+    }
     *session = handle;
     
     LOGI("Session created: %p, state: IDLE", handle);
@@ -90,19 +106,28 @@ XrResult xrDestroySession(XrSession session) {
     
     LOGI("xrDestroySession called for session: %p", session);
     
-    std::lock_guard<std::mutex> lock(g_sessionMutex);
-    auto it = g_sessions.find(session);
-    if (it == g_sessions.end()) {
+    std::shared_ptr<XRSession> sess = g_sessions.Remove(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
     // End session if still active
-    if (it->second->active) {
+    if (sess->active) {
+        sess->active = false;
+        StopRunningSession(session);
         ShutdownXR2Display();
         ShutdownXR2Tracking();
     }
     
-    g_sessions.erase(it);
+    // Release a frame thread still blocked in xrWaitFrame
+    CancelFrameRing(&sess->frameRing);
+    CancelFramePacer(&sess->framePacer);
+    
+    // Pooled swapchain textures belong to the graphics context; keep them
+    // while another session can still reuse them
+    if (g_sessions.First() == XR_NULL_HANDLE) {
+        ReleaseSwapchainImagePool();
+    }
     
     LOGI("Session destroyed");
     return XR_SUCCESS;
@@ -119,13 +144,12 @@ XrResult xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo)
     
     LOGI("xrBeginSession called");
     
-    std::lock_guard<std::mutex> lock(g_sessionMutex);
-    auto it = g_sessions.find(session);
-    if (it == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& sess = it->second;
+    std::lock_guard<std::mutex> lock(sess->mutex);
     
     if (sess->active) {
         LOGW("Session already active");
@@ -140,12 +164,54 @@ XrResult xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo)
     
     sess->viewConfigType = viewConfigType;
     
+    // Claimed until xrEndSession/xrDestroySession
+    {
+        std::lock_guard<std::mutex> runningLock(g_runningSessionMutex);
+        if (g_runningSession != XR_NULL_HANDLE) {
+            LOGW("Another session is running: %p", g_runningSession);
+            return XR_ERROR_LIMIT_REACHED;
+        }
+        g_runningSession = session;
+    }
+    
     // Start rendering
     if (!StartXR2Rendering()) {
         LOGE("Failed to start XR2 rendering");
+        StopRunningSession(session);
         return XR_ERROR_RUNTIME_FAILURE;
     }
     
+    // Vsync events drive frame pacing
+    if (StartVsyncSource(VSYNC_SOURCE_CALLBACK) == VSYNC_SOURCE_NONE) {
+        StopRunningSession(session);
+        return XR_ERROR_RUNTIME_FAILURE;
+    }
+    
+    // xrEndFrame queues frames; the compositor thread shows them each vsync
+    if (!StartCompositor(GetDisplayCompositorBackend())) {
+        LOGE("Failed to start compositor");
+        StopRunningSession(session);
+        return XR_ERROR_RUNTIME_FAILURE;
+    }
+    
+    // Eye FOV/offsets are cached for xrLocateViews
+    if (!RefreshXR2EyeCalibration()) {
+        LOGW("Failed to refresh eye calibration, using cached values");
+    }
+    
+    // Sample controllers between syncs; xrSyncActions falls back to
+    // polling if the sampler is not running
+    if (!StartXR2InputSampling(XR2_DEFAULT_INPUT_SAMPLE_RATE_HZ)) {
+        LOGW("Failed to start input sampling, polling on sync");
+    }
+    
+    ResetFrameRing(&sess->frameRing);
+    ResetFrameTelemetry();
+    
+    // Adjusts CPU/GPU levels from the frame telemetry
+    StartPerfGovernor();
+    ResetFramePacer(&sess->framePacer);
+    
     sess->state = XR_SESSION_STATE_READY;
     sess->active = true;
     
@@ -156,13 +222,12 @@ XrResult xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo)
 XrResult xrEndSession(XrSession session) {
     LOGI("xrEndSession called");
     
-    std::lock_guard<std::mutex> lock(g_sessionMutex);
-    auto it = g_sessions.find(session);
-    if (it == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& sess = it->second;
+    std::lock_guard<std::mutex> lock(sess->mutex);
     
     if (!sess->active) {
         LOGW("Session not active");
@@ -170,10 +235,12 @@ XrResult xrEndSession(XrSession session) {
     }
     
     // Stop rendering
-    StopXR2Rendering();
+    StopRunningSession(session);
     
     sess->state = XR_SESSION_STATE_STOPPING;
     sess->active = false;
+    CancelFrameRing(&sess->frameRing);
+    CancelFramePacer(&sess->framePacer);
     
     LOGI("Session ended, state: STOPPING");
     return XR_SUCCESS;
@@ -182,13 +249,12 @@ XrResult xrEndSession(XrSession session) {
 XrResult xrRequestExitSession(XrSession session) {
     LOGI("xrRequestExitSession called");
     
-    std::lock_guard<std::mutex> lock(g_sessionMutex);
-    auto it = g_sessions.find(session);
-    if (it == g_sessions.end()) {
+    XRSession* sess = g_sessions.Lookup(session);
+    if (!sess) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& sess = it->second;
+    std::lock_guard<std::mutex> lock(sess->mutex);
     sess->state = XR_SESSION_STATE_STOPPING;
     
     // Post exit event
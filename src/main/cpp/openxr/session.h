@@ -0,0 +1,33 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <openxr/openxr.h>
+#include "platform/frame_pacer.h"
+#include "frame_ring.h"
+#include "action_state.h"
+#include "platform/input_manager.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Session object shared by the session, frame and input modules
+struct XRSession {
+    XrInstance instance;
+    XrSessionState state;
+    XrViewConfigurationType viewConfigType;
+    std::atomic<bool> active;
+    std::mutex mutex;
+    FramePacer framePacer;  // xrWaitFrame blocks here, not on a global lock
+    FrameRing frameRing;    // Frames from xrWaitFrame to display
+    ActionStateBuffer actionState;  // Published by xrSyncActions
+    std::shared_ptr<InputBindingTable> inputBindings;  // The instance's
+    std::atomic<bool> actionSetsAttached;
+    std::vector<XrActionSet> attachedActionSets;       // Written once, at attach
+    
+    XRSession(XrInstance inst) : instance(inst), state(XR_SESSION_STATE_UNKNOWN), 
+                                 viewConfigType(XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO), active(false),
+                                 actionSetsAttached(false) {}
+};
+
+#endif // SESSION_H
@@ -2,14 +2,14 @@
 #include "qualcomm/xr2_platform.h"
 #include "platform/input_manager.h"
 #include "utils/logger.h"
+#include "handle_table.h"
+#include "session.h"
 #include <cstdint>
-#include <mutex>
-#include <unordered_map>
+#include <memory>
 #include <cstring>
 
 // External declarations
-extern std::mutex g_sessionMutex;
-extern std::unordered_map<XrSession, std::shared_ptr<XRSession>> g_sessions;
+extern HandleTable<XRSession, XrSession> g_sessions;
 
 struct XRSpace {
     XrSession session;
@@ -18,6 +18,7 @@ struct XRSpace {
     bool isActionSpace;
     XrAction action;
     XrPath subactionPath;
+    uint32_t controllerIndex;  // Resolved from subactionPath at creation
     
     XRSpace(XrSession sess, XrReferenceSpaceType type) 
         : session(sess), referenceSpaceType(type), isActionSpace(false) {
@@ -31,9 +32,8 @@ struct XRSpace {
     }
 };
 
-std::mutex g_spaceMutex;
-std::unordered_map<XrSpace, std::shared_ptr<XRSpace>> g_spaces;
-static XrSpace g_nextSpaceHandle = reinterpret_cast<XrSpace>(0x2000);
+static const uint32_t MAX_SPACES = 1024;
+HandleTable<XRSpace, XrSpace> g_spaces(HANDLE_TYPE_SPACE, MAX_SPACES);
 
 XrResult xrCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateInfo* createInfo, XrSpace* space) {
     if (!createInfo || !space) {
@@ -45,9 +45,7 @@ XrResult xrCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateI
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    if (!g_sessions.Lookup(session)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -64,13 +62,11 @@ XrResult xrCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateI
     xrSpace->poseInReferenceSpace = createInfo->poseInReferenceSpace;
     
     // Register space
-    std::lock_guard<std::mutex> spaceLock(g_spaceMutex);
-    // Increment handle using integer arithmetic (handles are pointers in 64-bit)
-    uintptr_t handleValue = reinterpret_cast<uintptr_t>(g_nextSpaceHandle);
-    handleValue++;
-    XrSpace handle = reinterpret_cast<XrSpace>(handleValue);
-    g_nextSpaceHandle = handle;
-    g_spaces[handle] = xrSpace;
+    XrSpace handle = g_spaces.Insert(xrSpace);
+    if (handle == XR_NULL_HANDLE) {
+        LOGE("Space limit reached (%u)", g_spaces.Capacity());
+        return XR_ERROR_LIMIT_REACHED;
+    }
     *space = handle;
     
     LOGI("Reference space created: %p, type: %d", handle, spaceType);
@@ -87,24 +83,22 @@ XrResult xrCreateActionSpace(XrSession session, const XrActionSpaceCreateInfo* c
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* xrSession = g_sessions.Lookup(session);
+    if (!xrSession) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
     // Create action space
     auto xrSpace = std::make_shared<XRSpace>(session, createInfo->action, createInfo->subactionPath);
+    xrSpace->controllerIndex = GetSubactionControllerIndex(*xrSession->inputBindings, createInfo->subactionPath);
     xrSpace->poseInReferenceSpace = createInfo->poseInActionSpace;
     
     // Register space
-    std::lock_guard<std::mutex> spaceLock(g_spaceMutex);
-    // Increment handle using integer arithmetic (handles are pointers in 64-bit)
-    uintptr_t handleValue = reinterpret_cast<uintptr_t>(g_nextSpaceHandle);
-    handleValue++;
-    XrSpace handle = reinterpret_cast<XrSpace>(handleValue);
-    g_nextSpaceHandle = handle;
-    g_spaces[handle] = xrSpace;
+    XrSpace handle = g_spaces.Insert(xrSpace);
+    if (handle == XR_NULL_HANDLE) {
+        LOGE("Space limit reached (%u)", g_spaces.Capacity());
+        return XR_ERROR_LIMIT_REACHED;
+    }
     *space = handle;
     
     LOGI("Action space created: %p", handle);
@@ -116,14 +110,10 @@ XrResult xrDestroySpace(XrSpace space) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    std::lock_guard<std::mutex> lock(g_spaceMutex);
-    auto it = g_spaces.find(space);
-    if (it == g_spaces.end()) {
+    if (!g_spaces.Remove(space)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    g_spaces.erase(it);
-    
     LOGI("Space destroyed: %p", space);
     return XR_SUCCESS;
 }
@@ -137,31 +127,25 @@ XrResult xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLoc
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
-    std::lock_guard<std::mutex> lock(g_spaceMutex);
-    
     // Get space
-    auto spaceIt = g_spaces.find(space);
-    if (spaceIt == g_spaces.end()) {
+    XRSpace* xrSpace = g_spaces.Lookup(space);
+    if (!xrSpace) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& xrSpace = spaceIt->second;
-    
     // Get base space
-    auto baseIt = g_spaces.find(baseSpace);
-    if (baseIt == g_spaces.end()) {
+    XRSpace* baseXrSpace = g_spaces.Lookup(baseSpace);
+    if (!baseXrSpace) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& baseXrSpace = baseIt->second;
-    
     // Get tracking data from platform
     XrPosef pose;
     XrSpaceLocationFlags locationFlags = 0;
     
     if (xrSpace->isActionSpace) {
         // Get pose from action
-        if (!GetActionPose(xrSpace->action, xrSpace->subactionPath, time, &pose, &locationFlags)) {
+        if (!GetActionPose(xrSpace->controllerIndex, time, &pose, &locationFlags)) {
             location->locationFlags = 0;
             return XR_SUCCESS; // Valid but not tracked
         }
@@ -195,9 +179,7 @@ XrResult xrLocateViews(XrSession session, const XrViewLocateInfo* viewLocateInfo
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    if (!g_sessions.Lookup(session)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -1,48 +1,32 @@
 #include "openxr_api.h"
+#include "swapchain.h"
 #include "platform/display_manager.h"
 #include "utils/logger.h"
+#include "handle_table.h"
+#include "session.h"
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <mutex>
 #include <vector>
-#include <unordered_map>
 #include <memory>
 
 // External declarations
-extern std::mutex g_sessionMutex;
-extern std::unordered_map<XrSession, std::shared_ptr<XRSession>> g_sessions;
+extern HandleTable<XRSession, XrSession> g_sessions;
 
-struct SwapchainImage {
-    void* image;
-    uint32_t width;
-    uint32_t height;
-    int64_t format;
-    bool acquired;
-    bool released;
-};
-
-struct XRSwapchain {
-    XrSession session;
-    uint32_t width;
-    uint32_t height;
-    uint32_t arraySize;
-    uint32_t mipCount;
-    uint32_t faceCount;
-    uint32_t arrayLayerCount;
-    uint32_t sampleCount;
-    int64_t format;
-    XrSwapchainUsageFlags usageFlags;
-    XrSwapchainCreateFlags createFlags;
-    
-    std::vector<SwapchainImage> images;
-    std::mutex mutex;
-    uint32_t currentImageIndex;
-    
-    XRSwapchain(XrSession sess) : session(sess), currentImageIndex(0) {}
-};
+static const uint32_t MAX_SWAPCHAINS = 256;
+HandleTable<XRSwapchain, XrSwapchain> g_swapchains(HANDLE_TYPE_SWAPCHAIN, MAX_SWAPCHAINS);
 
-std::mutex g_swapchainMutex;
-std::unordered_map<XrSwapchain, std::shared_ptr<XRSwapchain>> g_swapchains;
-static XrSwapchain g_nextSwapchainHandle = reinterpret_cast<XrSwapchain>(0x3000);
+static SwapchainImageDesc GetSwapchainImageDesc(const XRSwapchain& swapchain) {
+    SwapchainImageDesc desc;
+    desc.width = swapchain.width;
+    desc.height = swapchain.height;
+    desc.format = swapchain.format;
+    desc.sampleCount = swapchain.sampleCount > 0 ? swapchain.sampleCount : 1;
+    desc.arraySize = swapchain.arraySize;
+    desc.mipCount = swapchain.mipCount > 0 ? swapchain.mipCount : 1;
+    return desc;
+}
 
 XrResult xrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain) {
     if (!createInfo || !swapchain) {
@@ -54,12 +38,14 @@ XrResult xrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* creat
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    XRSession* xrSession = g_sessions.Lookup(session);
+    if (!xrSession) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
+    // Recycle destroyed swapchains first; their images may match
+    FlushDeferredSwapchainDeletes();
+    
     // Validate parameters
     if (createInfo->width == 0 || createInfo->height == 0) {
         return XR_ERROR_VALIDATION_FAILURE;
@@ -69,6 +55,13 @@ XrResult xrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* creat
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
+    std::vector<int64_t> supportedFormats;
+    GetSupportedSwapchainFormats(supportedFormats);
+    if (std::find(supportedFormats.begin(), supportedFormats.end(), createInfo->format) ==
+        supportedFormats.end()) {
+        return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+    }
+    
     // Create swapchain
     auto xrSwapchain = std::make_shared<XRSwapchain>(session);
     xrSwapchain->width = createInfo->width;
@@ -83,29 +76,37 @@ XrResult xrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* creat
     xrSwapchain->usageFlags = createInfo->usageFlags;
     xrSwapchain->createFlags = createInfo->createFlags;
     
-    // Create swapchain images
-    uint32_t imageCount = createInfo->arraySize;
-    xrSwapchain->images.resize(imageCount);
+    // Create swapchain images. arraySize is the layer count of each image;
+    // the number of images is the runtime's choice: one per frame the app
+    // may have in flight plus the one the compositor is showing. Static
+    // swapchains have a single image by definition.
+    uint32_t imageCount = 1;
+    if (!(createInfo->createFlags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT)) {
+        imageCount = GetFrameRingDepth(&xrSession->frameRing) + 1;
+    }
+    xrSwapchain->graphics = GetGraphicsBackend();
+    xrSwapchain->imageCount = imageCount;
+    xrSwapchain->textures.resize(imageCount);
+    xrSwapchain->fences.reset(new SwapchainImageFence[imageCount]);
     
-    if (!CreateSwapchainImages(xrSwapchain->width, xrSwapchain->height, 
-                               xrSwapchain->format, imageCount, 
-                               xrSwapchain->images.data())) {
+    if (!CreateSwapchainImages(xrSwapchain->graphics, GetSwapchainImageDesc(*xrSwapchain), imageCount,
+                               xrSwapchain->textures.data())) {
         LOGE("Failed to create swapchain images");
+        xrSwapchain->textures.clear();  // Nothing for the destructor to recycle
         return XR_ERROR_RUNTIME_FAILURE;
     }
     
-    // Register swapchain
-    std::lock_guard<std::mutex> swapLock(g_swapchainMutex);
-    // Increment handle using integer arithmetic (handles are pointers in 64-bit)
-    uintptr_t handleValue = reinterpret_cast<uintptr_t>(g_nextSwapchainHandle);
-    handleValue++;
-    XrSwapchain handle = reinterpret_cast<XrSwapchain>(handleValue);
-    g_nextSwapchainHandle = handle;
-    g_swapchains[handle] = xrSwapchain;
+    // Register swapchain; on failure the destructor queues the images
+    XrSwapchain handle = g_swapchains.Insert(xrSwapchain);
+    if (handle == XR_NULL_HANDLE) {
+        LOGE("Swapchain limit reached (%u)", g_swapchains.Capacity());
+        return XR_ERROR_LIMIT_REACHED;
+    }
     *swapchain = handle;
     
-    LOGI("Swapchain created: %p, %ux%u, format: %lld", handle, 
-         xrSwapchain->width, xrSwapchain->height, xrSwapchain->format);
+    LOGI("Swapchain created: %p, %ux%u, format: %lld, layers: %u, images: %u", handle, 
+         xrSwapchain->width, xrSwapchain->height, xrSwapchain->format,
+         xrSwapchain->arraySize, imageCount);
     return XR_SUCCESS;
 }
 
@@ -114,37 +115,47 @@ XrResult xrDestroySwapchain(XrSwapchain swapchain) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    std::lock_guard<std::mutex> lock(g_swapchainMutex);
-    auto it = g_swapchains.find(swapchain);
-    if (it == g_swapchains.end()) {
+    // The handle is invalid from here on. The images are recycled when
+    // the last reference goes: here, or once the compositor unpins them
+    // and the app's next graphics call flushes them.
+    std::shared_ptr<XRSwapchain> xrSwapchain = g_swapchains.Remove(swapchain);
+    if (!xrSwapchain) {
         return XR_ERROR_HANDLE_INVALID;
     }
-    
-    auto& xrSwapchain = it->second;
-    
-    // Destroy swapchain images
-    DestroySwapchainImages(xrSwapchain->images.data(), xrSwapchain->images.size());
-    
-    g_swapchains.erase(it);
+    xrSwapchain.reset();
+    FlushDeferredSwapchainDeletes();
     
     LOGI("Swapchain destroyed: %p", swapchain);
     return XR_SUCCESS;
 }
 
+XRSwapchain::~XRSwapchain() {
+    std::vector<GraphicsFence> renderFences;
+    for (uint32_t i = 0; i < imageCount && fences; ++i) {
+        GraphicsFence fence = fences[i].renderFence.exchange(GRAPHICS_NO_FENCE);
+        if (fence != GRAPHICS_NO_FENCE) {
+            renderFences.push_back(fence);
+        }
+    }
+    
+    // May run on the compositor thread: the app's graphics thread deletes
+    // the fences and returns the images to the texture pool
+    DeferSwapchainDelete(graphics, GetSwapchainImageDesc(*this), std::move(textures),
+                         std::move(renderFences));
+}
+
 XrResult xrEnumerateSwapchainImages(XrSwapchain swapchain, uint32_t imageCapacityInput, 
                                    uint32_t* imageCountOutput, XrSwapchainImageBaseHeader* images) {
     if (!imageCountOutput) {
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
-    std::lock_guard<std::mutex> lock(g_swapchainMutex);
-    auto it = g_swapchains.find(swapchain);
-    if (it == g_swapchains.end()) {
+    XRSwapchain* xrSwapchain = g_swapchains.Lookup(swapchain);
+    if (!xrSwapchain) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& xrSwapchain = it->second;
-    uint32_t imageCount = static_cast<uint32_t>(xrSwapchain->images.size());
+    uint32_t imageCount = xrSwapchain->imageCount;
     
     *imageCountOutput = imageCount;
     
@@ -154,7 +165,7 @@ XrResult xrEnumerateSwapchainImages(XrSwapchain swapchain, uint32_t imageCapacit
         for (uint32_t i = 0; i < imageCount; ++i) {
             // Fill image data
             // images[i].type = XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR;
-            // images[i].image = xrSwapchain->images[i].image;
+            // images[i].image = xrSwapchain->textures[i];
         }
     }
     
@@ -167,32 +178,50 @@ XrResult xrAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAc
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
-    std::lock_guard<std::mutex> lock(g_swapchainMutex);
-    auto it = g_swapchains.find(swapchain);
-    if (it == g_swapchains.end()) {
+    XRSwapchain* xrSwapchain = g_swapchains.Lookup(swapchain);
+    if (!xrSwapchain) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& xrSwapchain = it->second;
+    // A static image is rendered once and never acquired again
+    if ((xrSwapchain->createFlags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT) &&
+        xrSwapchain->staticImageAcquired.exchange(true, std::memory_order_acq_rel)) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
     
-    // Find available image
-    bool found = false;
-    for (uint32_t i = 0; i < xrSwapchain->images.size(); ++i) {
-        auto& img = xrSwapchain->images[i];
-        if (!img.acquired && img.released) {
-            img.acquired = true;
-            img.released = false;
-            *index = i;
-            found = true;
-            break;
+    // Next image in FIFO order. It may still be read by the compositor;
+    // xrWaitSwapchainImage blocks on that, acquire never does.
+    uint32_t acquired = xrSwapchain->acquireCount.load(std::memory_order_relaxed);
+    do {
+        if (acquired - xrSwapchain->releaseCount.load(std::memory_order_acquire) >= xrSwapchain->imageCount) {
+            return XR_ERROR_CALL_ORDER_INVALID;  // Every image is held by the app
         }
-    }
+    } while (!xrSwapchain->acquireCount.compare_exchange_weak(acquired, acquired + 1,
+                                                              std::memory_order_acq_rel));
     
-    if (!found) {
-        return XR_ERROR_CALL_ORDER_INVALID;
+    *index = acquired % xrSwapchain->imageCount;
+    return XR_SUCCESS;
+}
+
+// Block until the compositor no longer reads 'image' or 'timeout' expires
+static bool WaitForImageFence(XRSwapchain* xrSwapchain, uint32_t image, XrDuration timeout) {
+    SwapchainImageFence& fence = xrSwapchain->fences[image];
+    if (fence.compositorRefs.load() == 0) {
+        return true;
     }
     
-    return XR_SUCCESS;
+    std::unique_lock<std::mutex> lock(xrSwapchain->fenceMutex);
+    xrSwapchain->fenceWaiters.fetch_add(1);
+    auto signalled = [&fence]() { return fence.compositorRefs.load() == 0; };
+    bool released;
+    if (timeout == XR_INFINITE_DURATION) {
+        xrSwapchain->fenceCondition.wait(lock, signalled);
+        released = true;
+    } else {
+        released = xrSwapchain->fenceCondition.wait_for(lock, std::chrono::nanoseconds(timeout), signalled);
+    }
+    xrSwapchain->fenceWaiters.fetch_sub(1);
+    return released;
 }
 
 XrResult xrWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* waitInfo) {
@@ -204,36 +233,131 @@ XrResult xrWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitI
         return XR_ERROR_VALIDATION_FAILURE;
     }
     
-    std::lock_guard<std::mutex> lock(g_swapchainMutex);
-    auto it = g_swapchains.find(swapchain);
-    if (it == g_swapchains.end()) {
+    // Blocks, so keep the swapchain alive
+    std::shared_ptr<XRSwapchain> xrSwapchain = g_swapchains.Acquire(swapchain);
+    if (!xrSwapchain) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    // Wait for image to be available
-    // This is typically a no-op for most platforms
+    // Oldest acquired image not waited on yet
+    uint32_t waited = xrSwapchain->waitCount.load(std::memory_order_relaxed);
+    if (waited == xrSwapchain->acquireCount.load(std::memory_order_acquire)) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    
+    if (!WaitForImageFence(xrSwapchain.get(), waited % xrSwapchain->imageCount, waitInfo->timeout)) {
+        return XR_TIMEOUT_EXPIRED;  // Still not waited; the app retries
+    }
+    
+    xrSwapchain->waitCount.store(waited + 1, std::memory_order_release);
     return XR_SUCCESS;
 }
 
 XrResult xrReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo* releaseInfo) {
-    std::lock_guard<std::mutex> lock(g_swapchainMutex);
-    auto it = g_swapchains.find(swapchain);
-    if (it == g_swapchains.end()) {
+    XRSwapchain* xrSwapchain = g_swapchains.Lookup(swapchain);
+    if (!xrSwapchain) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
-    auto& xrSwapchain = it->second;
+    // Oldest waited image; the next submitted frame shows it
+    uint32_t released = xrSwapchain->releaseCount.load(std::memory_order_relaxed);
+    if (released == xrSwapchain->waitCount.load(std::memory_order_acquire)) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
     
-    // Mark current image as released
-    if (xrSwapchain->currentImageIndex < xrSwapchain->images.size()) {
-        auto& img = xrSwapchain->images[xrSwapchain->currentImageIndex];
-        img.acquired = false;
-        img.released = true;
+    // Fence the app's rendering to the image before the compositor can
+    // pin it. xrWaitSwapchainImage made sure the compositor is done with
+    // the image, so nothing waits on the previous fence.
+    uint32_t image = released % xrSwapchain->imageCount;
+    GraphicsFence previous = xrSwapchain->fences[image].renderFence.exchange(
+        xrSwapchain->graphics->CreateFence(), std::memory_order_acq_rel);
+    if (previous != GRAPHICS_NO_FENCE) {
+        xrSwapchain->graphics->DestroyFence(previous);
     }
     
+    // Sequentially consistent, as is the fence check in
+    // WaitForImageFence: PinSwapchainImage's recheck relies on it
+    xrSwapchain->lastReleasedImage.store(image);
+    xrSwapchain->releaseCount.store(released + 1, std::memory_order_release);
     return XR_SUCCESS;
 }
 
+bool PinSwapchainImage(XrSwapchain swapchain, XRSwapchain** pinned, uint32_t* imageIndex) {
+    std::shared_ptr<XRSwapchain> xrSwapchain = g_swapchains.Acquire(swapchain);
+    if (!xrSwapchain) {
+        return false;
+    }
+    
+    // Take the reference, then check the image is still the last released.
+    // If the app released another one meanwhile it may already have waited
+    // on this image and be rendering to it again, so drop it and retry.
+    uint32_t image = xrSwapchain->lastReleasedImage.load();
+    for (;;) {
+        if (image == SWAPCHAIN_NO_IMAGE) {
+            return false;
+        }
+        SwapchainImageFence& fence = xrSwapchain->fences[image];
+        fence.compositorRefs.fetch_add(1);
+        uint32_t latest = xrSwapchain->lastReleasedImage.load();
+        if (latest == image) {
+            break;
+        }
+        if (fence.compositorRefs.fetch_sub(1) == 1 && xrSwapchain->fenceWaiters.load() > 0) {
+            std::lock_guard<std::mutex> lock(xrSwapchain->fenceMutex);
+            xrSwapchain->fenceCondition.notify_all();
+        }
+        image = latest;
+    }
+    
+    // First pin: hold the swapchain until the last unpin
+    if (xrSwapchain->pinCount.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        std::lock_guard<std::mutex> lock(xrSwapchain->pinMutex);
+        xrSwapchain->pinnedSelf = xrSwapchain;
+    }
+    
+    *pinned = xrSwapchain.get();
+    *imageIndex = image;
+    return true;
+}
+
+void UnpinSwapchainImage(XRSwapchain* pinned, uint32_t imageIndex) {
+    if (!pinned || imageIndex >= pinned->imageCount) {
+        return;
+    }
+    
+    // Signal the fence; only wake under the lock if someone waits
+    if (pinned->fences[imageIndex].compositorRefs.fetch_sub(1) == 1 &&
+        pinned->fenceWaiters.load() > 0) {
+        std::lock_guard<std::mutex> lock(pinned->fenceMutex);
+        pinned->fenceCondition.notify_all();
+    }
+    
+    if (pinned->pinCount.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    
+    // Last unpin, unless a pin came in meanwhile. If the app destroyed the
+    // swapchain this is the final reference; drop it outside pinMutex.
+    std::shared_ptr<XRSwapchain> self;
+    {
+        std::lock_guard<std::mutex> lock(pinned->pinMutex);
+        if (pinned->pinCount.load(std::memory_order_acquire) == 0) {
+            self = std::move(pinned->pinnedSelf);
+        }
+    }
+}
+
+bool GetSwapchainImage(const XRSwapchain* pinned, uint32_t imageIndex, uint32_t* image,
+                       GraphicsFence* renderFence) {
+    if (!pinned || imageIndex >= pinned->imageCount || !image || !renderFence) {
+        return false;
+    }
+    
+    *image = pinned->textures[imageIndex];
+    *renderFence = pinned->fences[imageIndex].renderFence.load(std::memory_order_acquire);
+    return true;
+}
+
 XrResult xrEnumerateSwapchainFormats(XrSession session, uint32_t formatCapacityInput, 
                                     uint32_t* formatCountOutput, int64_t* formats) {
     if (!formatCountOutput) {
@@ -241,9 +365,7 @@ XrResult xrEnumerateSwapchainFormats(XrSession session, uint32_t formatCapacityI
     }
     
     // Validate session
-    std::lock_guard<std::mutex> sessLock(g_sessionMutex);
-    auto sessIt = g_sessions.find(session);
-    if (sessIt == g_sessions.end()) {
+    if (!g_sessions.Lookup(session)) {
         return XR_ERROR_HANDLE_INVALID;
     }
     
@@ -0,0 +1,87 @@
+#ifndef SWAPCHAIN_H
+#define SWAPCHAIN_H
+
+#include <openxr/openxr.h>
+#include "platform/graphics_backend.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// No image index (nothing released yet)
+static const uint32_t SWAPCHAIN_NO_IMAGE = UINT32_MAX;
+
+// Fences of one image. The app's rendering: created at
+// xrReleaseSwapchainImage, waited on before the compositor reads. The
+// compositor hold: the image's release fence is signalled when the count
+// drops to zero; xrWaitSwapchainImage blocks until then.
+struct SwapchainImageFence {
+    std::atomic<GraphicsFence> renderFence;
+    std::atomic<uint32_t> compositorRefs;
+
+    SwapchainImageFence() : renderFence(GRAPHICS_NO_FENCE), compositorRefs(0) {}
+};
+
+struct XRSwapchain {
+    XrSession session;
+    uint32_t width;
+    uint32_t height;
+    uint32_t arraySize;
+    uint32_t mipCount;
+    uint32_t faceCount;
+    uint32_t sampleCount;
+    int64_t format;
+    XrSwapchainUsageFlags usageFlags;
+    XrSwapchainCreateFlags createFlags;
+
+    GraphicsBackend* graphics;  // Backend the images and fences belong to
+    uint32_t imageCount;
+    std::vector<uint32_t> textures;  // Backend image (GL texture name) per index
+    std::unique_ptr<SwapchainImageFence[]> fences;
+
+    // FIFO image ring: images are acquired, waited and released in index
+    // order, so three running counts describe it. Image i of the ring is
+    // count % imageCount.
+    std::atomic<uint32_t> acquireCount;
+    std::atomic<uint32_t> waitCount;
+    std::atomic<uint32_t> releaseCount;
+    std::atomic<uint32_t> lastReleasedImage;  // Shown by layers submitted next
+    std::atomic<bool> staticImageAcquired;    // Static swapchains: acquired once only
+
+    // Blocking side of the fences; only taken when someone waits
+    std::mutex fenceMutex;
+    std::condition_variable fenceCondition;
+    std::atomic<uint32_t> fenceWaiters;
+
+    // While any image is pinned the swapchain holds itself, so a frame
+    // the compositor still reads survives xrDestroySwapchain
+    std::atomic<uint32_t> pinCount;
+    std::mutex pinMutex;
+    std::shared_ptr<XRSwapchain> pinnedSelf;
+
+    XRSwapchain(XrSession sess)
+        : session(sess), graphics(nullptr), imageCount(0), acquireCount(0), waitCount(0),
+          releaseCount(0), lastReleasedImage(SWAPCHAIN_NO_IMAGE), staticImageAcquired(false),
+          fenceWaiters(0), pinCount(0) {}
+
+    // Deletes the render fences and recycles the images; runs when the
+    // last reference goes, which is the compositor's unpin if it still
+    // held an image at xrDestroySwapchain
+    ~XRSwapchain();
+};
+
+// Compositor side (any thread). Pin holds the swapchain's last released
+// image for a submitted frame and returns its index and the swapchain to
+// unpin it on; Unpin signals the image's release fence once no frame
+// needs it. A pinned image stays valid after xrDestroySwapchain.
+bool PinSwapchainImage(XrSwapchain swapchain, XRSwapchain** pinned, uint32_t* imageIndex);
+void UnpinSwapchainImage(XRSwapchain* pinned, uint32_t imageIndex);
+
+// Backend image and render fence behind a pinned image index; valid until
+// it is unpinned, even if the app destroyed the swapchain meanwhile
+bool GetSwapchainImage(const XRSwapchain* pinned, uint32_t imageIndex, uint32_t* image,
+                       GraphicsFence* renderFence);
+
+#endif // SWAPCHAIN_H
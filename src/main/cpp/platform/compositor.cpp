@@ -0,0 +1,464 @@
+#include "compositor.h"
+#include "frame_pacer.h"
+#include "frame_telemetry.h"
+#include "vsync_estimator.h"
+#include "qualcomm/xr2_platform.h"
+#include "openxr/swapchain.h"
+#include "utils/logger.h"
+#include "utils/pose_math.h"
+#include "utils/spsc_ring.h"
+#include "utils/frame_arena.h"
+#include "utils/xr_time.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Period used until the vsync model has a sample
+static const XrDuration DEFAULT_COMPOSITOR_PERIOD_NS = 1000000000LL / 90;
+
+// xrEndFrame -> compositor thread
+static SpscRing<CompositorFrame, COMPOSITOR_QUEUE_SIZE> g_compositorQueue;
+
+// Layer storage for queued and composed frames. The xrEndFrame thread takes
+// free arenas from g_freeArenas; the compositor thread returns them when a
+// frame is superseded. Allocated once at start, so steady-state frames do
+// no heap allocation.
+static FrameArena g_frameArenas[COMPOSITOR_FRAME_ARENAS];
+static SpscRing<uint32_t, 8> g_freeArenas;  // compositor -> xrEndFrame
+static_assert(COMPOSITOR_FRAME_ARENAS <= 8, "free arena ring too small");
+static const uint32_t NO_FRAME_ARENA = UINT32_MAX;
+static uint32_t g_heldArena = NO_FRAME_ARENA;  // Running session's xrEndFrame only: taken but never queued
+
+// Compositor thread state
+static CompositorFrame g_pendingFrame;  // Popped, due at a later vsync
+static CompositorFrame g_currentFrame;  // Last frame composed
+static bool g_hasPendingFrame = false;
+static bool g_hasCurrentFrame = false;
+
+static std::mutex g_compositorMutex;  // Start/stop and the thread's sleep
+static std::condition_variable g_compositorCondition;
+static std::thread g_compositorThread;
+static bool g_compositorRunning = false;
+static bool g_compositorStarting = false;  // Until the thread has initialized the backend
+static CompositorBackend* g_compositorBackend = nullptr;
+
+static std::atomic<uint64_t> g_composedFrames(0);
+static std::atomic<uint64_t> g_reusedFrames(0);
+static std::atomic<uint64_t> g_queueOverflows(0);
+
+void CalculateTimeWarpMatrix(const XrPosef& renderPose, const XrPosef& displayPose, float* warpMatrix) {
+    if (!warpMatrix) {
+        return;
+    }
+
+    // Rotation from the render pose to the display pose
+    XrQuaternionf q = QuatNormalize(QuatMultiply(displayPose.orientation,
+                                                 QuatConjugate(renderPose.orientation)));
+    float x = q.x, y = q.y, z = q.z, w = q.w;
+
+    warpMatrix[0] = 1.0f - 2.0f * (y * y + z * z);
+    warpMatrix[1] = 2.0f * (x * y + z * w);
+    warpMatrix[2] = 2.0f * (x * z - y * w);
+    warpMatrix[3] = 0.0f;
+
+    warpMatrix[4] = 2.0f * (x * y - z * w);
+    warpMatrix[5] = 1.0f - 2.0f * (x * x + z * z);
+    warpMatrix[6] = 2.0f * (y * z + x * w);
+    warpMatrix[7] = 0.0f;
+
+    warpMatrix[8] = 2.0f * (x * z + y * w);
+    warpMatrix[9] = 2.0f * (y * z - x * w);
+    warpMatrix[10] = 1.0f - 2.0f * (x * x + y * y);
+    warpMatrix[11] = 0.0f;
+
+    warpMatrix[12] = 0.0f;
+    warpMatrix[13] = 0.0f;
+    warpMatrix[14] = 0.0f;
+    warpMatrix[15] = 1.0f;
+}
+
+static void CopySubImage(const XrSwapchainSubImage& subImage, CompositorView* view) {
+    view->swapchain = subImage.swapchain;
+    if (!PinSwapchainImage(subImage.swapchain, &view->pinned, &view->imageIndex)) {
+        view->pinned = nullptr;
+        view->imageIndex = SWAPCHAIN_NO_IMAGE;
+    }
+    view->imageRect = subImage.imageRect;
+    view->imageArrayIndex = subImage.imageArrayIndex;
+    view->depth = nullptr;
+}
+
+// Signal the release fences of every image the frame pinned
+static void UnpinFrameImages(const CompositorFrame& frame) {
+    for (uint32_t l = 0; l < frame.layerCount; ++l) {
+        const CompositorLayer& layer = frame.layers[l];
+        for (uint32_t v = 0; v < layer.viewCount; ++v) {
+            const CompositorView& view = layer.views[v];
+            if (view.imageIndex != SWAPCHAIN_NO_IMAGE) {
+                UnpinSwapchainImage(view.pinned, view.imageIndex);
+            }
+            if (view.depth && view.depth->imageIndex != SWAPCHAIN_NO_IMAGE) {
+                UnpinSwapchainImage(view.depth->pinned, view.depth->imageIndex);
+            }
+        }
+    }
+}
+
+// Depth info chained to a projection view, copied into the arena
+static const CompositorDepth* CopyViewDepth(const void* next, FrameArena* arena) {
+    for (const XrBaseInStructure* item = static_cast<const XrBaseInStructure*>(next); item;
+         item = item->next) {
+        if (item->type != XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR) {
+            continue;
+        }
+
+        const XrCompositionLayerDepthInfoKHR* info =
+            reinterpret_cast<const XrCompositionLayerDepthInfoKHR*>(item);
+        CompositorDepth* depth = arena->AllocateArray<CompositorDepth>(1);
+        if (!depth) {
+            return nullptr;
+        }
+        depth->swapchain = info->subImage.swapchain;
+        if (!PinSwapchainImage(depth->swapchain, &depth->pinned, &depth->imageIndex)) {
+            depth->pinned = nullptr;
+            depth->imageIndex = SWAPCHAIN_NO_IMAGE;
+        }
+        depth->imageRect = info->subImage.imageRect;
+        depth->imageArrayIndex = info->subImage.imageArrayIndex;
+        depth->minDepth = info->minDepth;
+        depth->maxDepth = info->maxDepth;
+        depth->nearZ = info->nearZ;
+        depth->farZ = info->farZ;
+        return depth;
+    }
+    return nullptr;
+}
+
+// Flatten one app layer (and the next chains of its views) into 'out'.
+// False if the layer is unsupported or the arena is full.
+static bool CopyCompositorLayer(const XrCompositionLayerBaseHeader* layer, FrameArena* arena,
+                                CompositorLayer* out) {
+    *out = {};
+    out->type = layer->type;
+    out->layerFlags = layer->layerFlags;
+    out->space = layer->space;
+    out->eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+
+    switch (layer->type) {
+        case XR_TYPE_COMPOSITION_LAYER_PROJECTION: {
+            const XrCompositionLayerProjection* projLayer =
+                reinterpret_cast<const XrCompositionLayerProjection*>(layer);
+            if (!projLayer->views || projLayer->viewCount == 0) {
+                LOGW("Invalid projection layer: no views");
+                return false;
+            }
+
+            uint32_t viewCount = projLayer->viewCount < MAX_COMPOSITOR_VIEWS ? projLayer->viewCount
+                                                                              : MAX_COMPOSITOR_VIEWS;
+            CompositorView* views = arena->AllocateArray<CompositorView>(viewCount);
+            if (!views) {
+                return false;
+            }
+            for (uint32_t i = 0; i < viewCount; ++i) {
+                const XrCompositionLayerProjectionView& view = projLayer->views[i];
+                CopySubImage(view.subImage, &views[i]);
+                views[i].pose = view.pose;
+                views[i].fov = view.fov;
+                views[i].depth = CopyViewDepth(view.next, arena);
+            }
+            out->viewCount = viewCount;
+            out->views = views;
+            return true;
+        }
+
+        case XR_TYPE_COMPOSITION_LAYER_QUAD: {
+            const XrCompositionLayerQuad* quadLayer =
+                reinterpret_cast<const XrCompositionLayerQuad*>(layer);
+            CompositorView* view = arena->AllocateArray<CompositorView>(1);
+            if (!view) {
+                return false;
+            }
+            *view = {};
+            CopySubImage(quadLayer->subImage, view);
+            view->pose = quadLayer->pose;
+            out->eyeVisibility = quadLayer->eyeVisibility;
+            out->size = quadLayer->size;
+            out->viewCount = 1;
+            out->views = view;
+            return true;
+        }
+
+        case XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR: {
+            const XrCompositionLayerCylinderKHR* cylinderLayer =
+                reinterpret_cast<const XrCompositionLayerCylinderKHR*>(layer);
+            CompositorView* view = arena->AllocateArray<CompositorView>(1);
+            if (!view) {
+                return false;
+            }
+            *view = {};
+            CopySubImage(cylinderLayer->subImage, view);
+            view->pose = cylinderLayer->pose;
+            out->eyeVisibility = cylinderLayer->eyeVisibility;
+            out->radius = cylinderLayer->radius;
+            out->centralAngle = cylinderLayer->centralAngle;
+            out->aspectRatio = cylinderLayer->aspectRatio;
+            out->viewCount = 1;
+            out->views = view;
+            return true;
+        }
+
+        default:
+            LOGW("Unsupported layer type: %u", layer->type);
+            return false;
+    }
+}
+
+CompositorSubmitResult SubmitCompositorLayers(uint64_t frameId, XrTime displayTime,
+                                              const XrCompositionLayerBaseHeader* const* layers,
+                                              uint32_t layerCount) {
+    if (!layers || layerCount == 0) {
+        return COMPOSITOR_SUBMIT_FAILED;
+    }
+
+    CompositorFrame frame;
+    if (g_heldArena != NO_FRAME_ARENA) {
+        frame.arena = g_heldArena;
+        g_heldArena = NO_FRAME_ARENA;
+    } else if (!g_freeArenas.Pop(&frame.arena)) {
+        g_queueOverflows.fetch_add(1, std::memory_order_relaxed);
+        LOGW("No free frame arena, frame %llu dropped", static_cast<unsigned long long>(frameId));
+        return COMPOSITOR_SUBMIT_DROPPED;
+    }
+
+    FrameArena* arena = &g_frameArenas[frame.arena];
+    arena->Reset();
+
+    // One pass: the layer array first, then each layer's views behind it
+    uint32_t maxLayers = layerCount < MAX_COMPOSITOR_LAYERS ? layerCount : MAX_COMPOSITOR_LAYERS;
+    CompositorLayer* copied = arena->AllocateArray<CompositorLayer>(maxLayers);
+
+    frame.frameId = frameId;
+    frame.displayTime = displayTime;
+    frame.layerCount = 0;
+    frame.layers = copied;
+
+    for (uint32_t i = 0; i < layerCount && copied; ++i) {
+        if (!layers[i]) {
+            continue;
+        }
+        if (frame.layerCount == maxLayers) {
+            LOGW("Too many layers, dropping %u", layerCount - i);
+            break;
+        }
+        if (CopyCompositorLayer(layers[i], arena, &copied[frame.layerCount])) {
+            frame.layerCount++;
+        }
+    }
+
+    if (!g_compositorQueue.Push(frame)) {
+        UnpinFrameImages(frame);
+        g_heldArena = frame.arena;  // Never queued; reuse it next frame
+        g_queueOverflows.fetch_add(1, std::memory_order_relaxed);
+        LOGW("Compositor queue full, frame %llu dropped", static_cast<unsigned long long>(frameId));
+        return COMPOSITOR_SUBMIT_DROPPED;
+    }
+    return COMPOSITOR_SUBMIT_QUEUED;
+}
+
+// Take the newest queued frame due at or before 'targetVsync'; frames for
+// later vsyncs stay pending. Returns true if a new frame was taken.
+static bool TakeFrameForVsync(XrTime targetVsync, XrDuration period) {
+    bool taken = false;
+
+    for (;;) {
+        if (!g_hasPendingFrame) {
+            if (!g_compositorQueue.Pop(&g_pendingFrame)) {
+                break;
+            }
+            g_hasPendingFrame = true;
+        }
+        if (g_pendingFrame.displayTime > targetVsync + period / 2) {
+            break;
+        }
+
+        // The superseded frame is done with; release its images and arena
+        if (g_hasCurrentFrame) {
+            UnpinFrameImages(g_currentFrame);
+            g_freeArenas.Push(g_currentFrame.arena);
+        }
+        g_currentFrame = g_pendingFrame;
+        g_hasPendingFrame = false;
+        g_hasCurrentFrame = true;
+        taken = true;
+    }
+    return taken;
+}
+
+static void ComposeForVsync(CompositorBackend* backend, XrTime targetVsync, XrDuration period) {
+    bool newFrame = TakeFrameForVsync(targetVsync, period);
+    if (!g_hasCurrentFrame) {
+        return;  // Nothing submitted yet
+    }
+
+    if (newFrame) {
+        RecordFrameEvent(g_currentFrame.frameId, FRAME_EVENT_COMPOSITOR_PICKUP);
+    } else {
+        g_reusedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Re-sample the head pose for this vsync; reused frames are warped
+    // further from the pose they were rendered with
+    CompositorWarp warp;
+    warp.targetVsync = targetVsync;
+    warp.reused = !newFrame;
+    if (!backend->SampleWarpPoses(g_currentFrame.displayTime, targetVsync,
+                                  &warp.renderPose, &warp.displayPose)) {
+        warp.renderPose = {{0, 0, 0, 1}, {0, 0, 0}};
+        warp.displayPose = warp.renderPose;
+    }
+    CalculateTimeWarpMatrix(warp.renderPose, warp.displayPose, warp.matrix);
+
+    if (backend->Compose(g_currentFrame, warp)) {
+        g_composedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static void CompositorThreadMain() {
+    CompositorBackend* backend = g_compositorBackend;
+    bool initialized = backend->Initialize();
+
+    // Report the result to StartCompositor, which waits for it
+    std::unique_lock<std::mutex> lock(g_compositorMutex);
+    g_compositorStarting = false;
+    if (!initialized) {
+        LOGE("Compositor backend failed to initialize");
+        g_compositorRunning = false;
+    }
+    g_compositorCondition.notify_all();
+    if (!initialized) {
+        return;
+    }
+
+    while (g_compositorRunning) {
+        XrTime now = GetXR2CurrentTime();
+        XrTime phase;
+        XrDuration period;
+        if (!GetFramePacerVsyncModel(&phase, &period)) {
+            phase = now;
+            period = DEFAULT_COMPOSITOR_PERIOD_NS;
+        }
+
+        // Next vsync there is still time to compose for
+        XrTime targetVsync = NextVsyncAtOrAfter(phase, period, now + COMPOSITOR_LEAD_NS);
+        XrTime wakeTime = targetVsync - COMPOSITOR_LEAD_NS;
+
+        g_compositorCondition.wait_until(lock, XrTimeToSteadyClock(wakeTime),
+                                         []() { return !g_compositorRunning; });
+        if (!g_compositorRunning) {
+            break;
+        }
+
+        lock.unlock();
+        ComposeForVsync(backend, targetVsync, period);
+        lock.lock();
+    }
+    lock.unlock();
+
+    backend->Shutdown();
+}
+
+bool StartCompositor(CompositorBackend* backend) {
+    if (!backend) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(g_compositorMutex);
+
+    // One producer only: xrBeginSession lets a single session run
+    if (g_compositorRunning) {
+        LOGE("Compositor already running");
+        return false;
+    }
+
+    // Arenas are allocated on the first start and kept for the runtime's
+    // lifetime; every one is free while the thread is stopped
+    g_freeArenas.Clear();
+    for (uint32_t i = 0; i < COMPOSITOR_FRAME_ARENAS; ++i) {
+        if (g_frameArenas[i].Capacity() == 0 &&
+            !g_frameArenas[i].Initialize(COMPOSITOR_FRAME_ARENA_SIZE)) {
+            LOGE("Failed to allocate compositor frame arenas");
+            return false;
+        }
+        g_freeArenas.Push(i);
+    }
+    g_heldArena = NO_FRAME_ARENA;
+
+    g_compositorQueue.Clear();
+    g_hasPendingFrame = false;
+    g_hasCurrentFrame = false;
+    g_composedFrames.store(0, std::memory_order_relaxed);
+    g_reusedFrames.store(0, std::memory_order_relaxed);
+    g_queueOverflows.store(0, std::memory_order_relaxed);
+
+    g_compositorBackend = backend;
+    g_compositorRunning = true;
+    g_compositorStarting = true;
+    g_compositorThread = std::thread(CompositorThreadMain);
+
+    // The backend initializes on the compositor thread (its graphics
+    // context lives there); nothing may be queued if that fails
+    g_compositorCondition.wait(lock, []() { return !g_compositorStarting; });
+    if (!g_compositorRunning) {
+        lock.unlock();
+        g_compositorThread.join();
+        g_compositorBackend = nullptr;
+        return false;
+    }
+
+    LOGI("Compositor started");
+    return true;
+}
+
+void StopCompositor() {
+    {
+        std::lock_guard<std::mutex> lock(g_compositorMutex);
+        if (!g_compositorRunning) {
+            return;
+        }
+        g_compositorRunning = false;
+    }
+    g_compositorCondition.notify_all();
+
+    if (g_compositorThread.joinable()) {
+        g_compositorThread.join();
+    }
+    g_compositorBackend = nullptr;
+
+    // Nothing will be composed; let waiting apps have their images back
+    CompositorFrame frame;
+    while (g_compositorQueue.Pop(&frame)) {
+        UnpinFrameImages(frame);
+    }
+    if (g_hasPendingFrame) {
+        UnpinFrameImages(g_pendingFrame);
+        g_hasPendingFrame = false;
+    }
+    if (g_hasCurrentFrame) {
+        UnpinFrameImages(g_currentFrame);
+        g_hasCurrentFrame = false;
+    }
+
+    LOGI("Compositor stopped");
+}
+
+void GetCompositorStats(CompositorStats* stats) {
+    if (!stats) {
+        return;
+    }
+
+    stats->composedFrames = g_composedFrames.load(std::memory_order_relaxed);
+    stats->reusedFrames = g_reusedFrames.load(std::memory_order_relaxed);
+    stats->queueOverflows = g_queueOverflows.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,131 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <openxr/openxr.h>
+#include <cstdint>
+
+// Limits of the runtime-owned copy; layers or views past them are dropped
+static const uint32_t MAX_COMPOSITOR_LAYERS = 16;
+static const uint32_t MAX_COMPOSITOR_VIEWS = 2;
+
+// Frames queued between xrEndFrame and the compositor thread; more than
+// the frame pipeline depth so a full pipeline never overflows it
+static const uint32_t COMPOSITOR_QUEUE_SIZE = 4;
+
+// Per-frame arenas: every queued frame plus the compositor's pending and
+// current frame
+static const uint32_t COMPOSITOR_FRAME_ARENAS = COMPOSITOR_QUEUE_SIZE + 2;
+static const size_t COMPOSITOR_FRAME_ARENA_SIZE = 16 * 1024;
+
+// The compositor wakes this long before the vsync it composes for
+static const XrDuration COMPOSITOR_LEAD_NS = 3000000;  // 3 ms
+
+struct XRSwapchain;
+
+// Depth attached to a projection view (XR_KHR_composition_layer_depth)
+struct CompositorDepth {
+    XrSwapchain swapchain;
+    XRSwapchain* pinned;  // Swapchain holding the pin, valid until unpinned
+    uint32_t imageIndex;  // Pinned swapchain image, SWAPCHAIN_NO_IMAGE if none
+    XrRect2Di imageRect;
+    uint32_t imageArrayIndex;
+    float minDepth, maxDepth;
+    float nearZ, farZ;
+};
+
+// One view of a layer, copied out of the app's structures at xrEndFrame.
+// The swapchain image released last before xrEndFrame is pinned until the
+// compositor is done with the frame.
+struct CompositorView {
+    XrSwapchain swapchain;
+    XRSwapchain* pinned;  // Swapchain holding the pin, valid until unpinned
+    uint32_t imageIndex;  // Pinned swapchain image, SWAPCHAIN_NO_IMAGE if none
+    XrRect2Di imageRect;
+    uint32_t imageArrayIndex;
+    XrPosef pose;
+    XrFovf fov;                    // Projection layers only
+    const CompositorDepth* depth;  // nullptr if none
+};
+
+// Flattened layer. Projection layers use views[0..viewCount); quad and
+// cylinder layers have one view holding the image and pose.
+struct CompositorLayer {
+    XrStructureType type;
+    XrCompositionLayerFlags layerFlags;
+    XrSpace space;
+    XrEyeVisibility eyeVisibility;
+    XrExtent2Df size;    // Quad
+    float radius;        // Cylinder
+    float centralAngle;
+    float aspectRatio;
+    uint32_t viewCount;
+    const CompositorView* views;
+};
+
+// Runtime-owned copy of one submitted frame. Layers and views live in the
+// frame's arena, which is recycled once the compositor is done with it.
+struct CompositorFrame {
+    uint64_t frameId;
+    XrTime displayTime;  // Time the app rendered for
+    uint32_t layerCount;
+    const CompositorLayer* layers;
+    uint32_t arena;      // Index of the arena holding the layers
+};
+
+// Rotational time warp for one composition, from the head pose the frame
+// was rendered with to the pose predicted for the target vsync
+struct CompositorWarp {
+    XrTime targetVsync;
+    XrPosef renderPose;
+    XrPosef displayPose;
+    float matrix[16];  // Column-major rotation, displayPose * renderPose^-1
+    bool reused;       // Previous frame shown again (app missed the vsync)
+};
+
+// Where composed frames go. The compositor thread owns the scheduling;
+// backends only sample poses and draw, so they can be swapped for a
+// headless one.
+class CompositorBackend {
+public:
+    virtual ~CompositorBackend() {}
+
+    // Called on the compositor thread before the first/after the last Compose
+    virtual bool Initialize() = 0;
+    virtual void Shutdown() = 0;
+
+    // Head pose the app rendered with (frame display time) and the newest
+    // prediction for the target vsync
+    virtual bool SampleWarpPoses(XrTime renderTime, XrTime targetTime,
+                                 XrPosef* renderPose, XrPosef* displayPose) = 0;
+
+    virtual bool Compose(const CompositorFrame& frame, const CompositorWarp& warp) = 0;
+};
+
+struct CompositorStats {
+    uint64_t composedFrames;  // Compositions, including reuses
+    uint64_t reusedFrames;    // Vsyncs with no new frame from the app
+    uint64_t queueOverflows;  // Frames dropped at submit (queue full)
+};
+
+// Start/stop the compositor thread (session begin/end). The backend must
+// outlive the thread. Frames come from the one running session, so starting
+// it again before StopCompositor fails.
+bool StartCompositor(CompositorBackend* backend);
+void StopCompositor();
+
+enum CompositorSubmitResult {
+    COMPOSITOR_SUBMIT_QUEUED = 0,
+    COMPOSITOR_SUBMIT_DROPPED,  // Queue or frame arenas full; images unpinned
+    COMPOSITOR_SUBMIT_FAILED,   // Nothing to submit
+};
+
+// Running session's frame thread (xrEndFrame): copy the layers and queue
+// the frame; never blocks on composition, drops the frame instead
+CompositorSubmitResult SubmitCompositorLayers(uint64_t frameId, XrTime displayTime,
+                            const XrCompositionLayerBaseHeader* const* layers, uint32_t layerCount);
+
+void GetCompositorStats(CompositorStats* stats);
+
+void CalculateTimeWarpMatrix(const XrPosef& renderPose, const XrPosef& displayPose, float* warpMatrix);
+
+#endif // COMPOSITOR_H
@@ -0,0 +1,543 @@
+#include "cpu_compositor.h"
+#include "utils/logger.h"
+#include "utils/pose_math.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CPU_COMPOSITOR_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CPU_COMPOSITOR_NEON 1
+#endif
+
+// Output tiles handed to the workers
+static const uint32_t CPU_COMPOSITOR_TILE_SIZE = 64;
+
+// RGBA texel as four floats (0-255). One SIMD register per texel, so
+// bilinear filtering and blending work on all channels at once.
+#if defined(CPU_COMPOSITOR_SSE2)
+typedef __m128 Vec4f;
+
+static inline Vec4f Vec4Zero() {
+    return _mm_setzero_ps();
+}
+
+static inline Vec4f LoadTexel(const uint8_t* texel) {
+    int32_t packed;
+    memcpy(&packed, texel, sizeof(packed));
+    __m128i zero = _mm_setzero_si128();
+    __m128i value = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+    value = _mm_unpacklo_epi16(value, zero);
+    return _mm_cvtepi32_ps(value);
+}
+
+static inline void StoreTexel(uint8_t* texel, Vec4f color) {
+    __m128i value = _mm_cvtps_epi32(color);
+    value = _mm_packs_epi32(value, value);
+    value = _mm_packus_epi16(value, value);
+    int32_t packed = _mm_cvtsi128_si32(value);
+    memcpy(texel, &packed, sizeof(packed));
+}
+
+static inline Vec4f Vec4Lerp(Vec4f a, Vec4f b, float t) {
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+}
+
+// a + b * s
+static inline Vec4f Vec4MulAdd(Vec4f a, Vec4f b, float s) {
+    return _mm_add_ps(a, _mm_mul_ps(b, _mm_set1_ps(s)));
+}
+
+static inline Vec4f Vec4ScaleColor(Vec4f a, float s) {
+    return _mm_mul_ps(a, _mm_set_ps(1.0f, s, s, s));
+}
+
+static inline float Vec4Alpha(Vec4f a) {
+    return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)));
+}
+#elif defined(CPU_COMPOSITOR_NEON)
+typedef float32x4_t Vec4f;
+
+static inline Vec4f Vec4Zero() {
+    return vdupq_n_f32(0.0f);
+}
+
+static inline Vec4f LoadTexel(const uint8_t* texel) {
+    uint32_t packed;
+    memcpy(&packed, texel, sizeof(packed));
+    uint16x8_t wide = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(packed)));
+    return vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide)));
+}
+
+static inline void StoreTexel(uint8_t* texel, Vec4f color) {
+    uint32x4_t value = vcvtq_u32_f32(vaddq_f32(color, vdupq_n_f32(0.5f)));
+    uint16x4_t narrow = vqmovn_u32(value);
+    uint8x8_t bytes = vqmovn_u16(vcombine_u16(narrow, narrow));
+    uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    memcpy(texel, &packed, sizeof(packed));
+}
+
+static inline Vec4f Vec4Lerp(Vec4f a, Vec4f b, float t) {
+    return vmlaq_n_f32(a, vsubq_f32(b, a), t);
+}
+
+static inline Vec4f Vec4MulAdd(Vec4f a, Vec4f b, float s) {
+    return vmlaq_n_f32(a, b, s);
+}
+
+static inline Vec4f Vec4ScaleColor(Vec4f a, float s) {
+    float32x4_t scale = {s, s, s, 1.0f};
+    return vmulq_f32(a, scale);
+}
+
+static inline float Vec4Alpha(Vec4f a) {
+    return vgetq_lane_f32(a, 3);
+}
+#else
+struct Vec4f {
+    float v[4];
+};
+
+static inline Vec4f Vec4Zero() {
+    return Vec4f{{0.0f, 0.0f, 0.0f, 0.0f}};
+}
+
+static inline Vec4f LoadTexel(const uint8_t* texel) {
+    return Vec4f{{texel[0], texel[1], texel[2], texel[3]}};
+}
+
+static inline void StoreTexel(uint8_t* texel, Vec4f color) {
+    for (int i = 0; i < 4; ++i) {
+        float c = color.v[i] + 0.5f;
+        texel[i] = static_cast<uint8_t>(c < 0.0f ? 0.0f : (c > 255.0f ? 255.0f : c));
+    }
+}
+
+static inline Vec4f Vec4Lerp(Vec4f a, Vec4f b, float t) {
+    for (int i = 0; i < 4; ++i) {
+        a.v[i] += (b.v[i] - a.v[i]) * t;
+    }
+    return a;
+}
+
+static inline Vec4f Vec4MulAdd(Vec4f a, Vec4f b, float s) {
+    for (int i = 0; i < 4; ++i) {
+        a.v[i] += b.v[i] * s;
+    }
+    return a;
+}
+
+static inline Vec4f Vec4ScaleColor(Vec4f a, float s) {
+    a.v[0] *= s;
+    a.v[1] *= s;
+    a.v[2] *= s;
+    return a;
+}
+
+static inline float Vec4Alpha(Vec4f a) {
+    return a.v[3];
+}
+#endif
+
+// Bilinear sample at (u, v) in [0, 1] over 'rect' of 'image', clamped to
+// the rect's edges
+static inline Vec4f SampleBilinear(const HostImage& image, const XrRect2Di& rect, float u, float v) {
+    float x = rect.offset.x + u * rect.extent.width - 0.5f;
+    float y = rect.offset.y + v * rect.extent.height - 0.5f;
+
+    float minX = static_cast<float>(rect.offset.x);
+    float minY = static_cast<float>(rect.offset.y);
+    float maxX = static_cast<float>(rect.offset.x + rect.extent.width - 1);
+    float maxY = static_cast<float>(rect.offset.y + rect.extent.height - 1);
+    x = std::min(std::max(x, minX), maxX);
+    y = std::min(std::max(y, minY), maxY);
+
+    int32_t x0 = static_cast<int32_t>(x);
+    int32_t y0 = static_cast<int32_t>(y);
+    int32_t x1 = std::min(x0 + 1, static_cast<int32_t>(maxX));
+    int32_t y1 = std::min(y0 + 1, static_cast<int32_t>(maxY));
+    float fx = x - x0;
+    float fy = y - y0;
+
+    const uint8_t* row0 = image.pixels + static_cast<size_t>(y0) * image.stride;
+    const uint8_t* row1 = image.pixels + static_cast<size_t>(y1) * image.stride;
+    Vec4f top = Vec4Lerp(LoadTexel(row0 + x0 * 4), LoadTexel(row0 + x1 * 4), fx);
+    Vec4f bottom = Vec4Lerp(LoadTexel(row1 + x0 * 4), LoadTexel(row1 + x1 * 4), fx);
+    return Vec4Lerp(top, bottom, fy);
+}
+
+static float Dot(const XrVector3f& a, const XrVector3f& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+CpuCompositorBackend::CpuCompositorBackend(const CpuCompositorConfig& config)
+    : config_(config), frame_(nullptr), tilesX_(0), tilesY_(0), tileCount_(0),
+      generation_(0), stopping_(false), nextTile_(0), tilesDone_(0),
+      composedFrames_(0), composedPixels_(0), composeTime_(0) {
+    if (config_.meshResolution == 0) {
+        config_.meshResolution = 32;
+    }
+    memset(headWarp_, 0, sizeof(headWarp_));
+    memset(output_, 0, sizeof(output_));
+    memset(layerViews_, 0, sizeof(layerViews_));
+}
+
+CpuCompositorBackend::~CpuCompositorBackend() {
+    Shutdown();
+}
+
+void CpuCompositorBackend::BuildDistortionMesh() {
+    uint32_t res = config_.meshResolution;
+
+    for (uint32_t eye = 0; eye < 2; ++eye) {
+        const XrFovf& fov = config_.eyeFov[eye];
+        float tanLeft = tanf(fov.angleLeft);
+        float tanRight = tanf(fov.angleRight);
+        float tanUp = tanf(fov.angleUp);
+        float tanDown = tanf(fov.angleDown);
+
+        mesh_[eye].resize((res + 1) * (res + 1));
+        for (uint32_t j = 0; j <= res; ++j) {
+            for (uint32_t i = 0; i <= res; ++i) {
+                // Undistorted direction through the output pixel (row 0 = top)
+                float u = static_cast<float>(i) / res;
+                float v = static_cast<float>(j) / res;
+                float tanX = tanLeft + u * (tanRight - tanLeft);
+                float tanY = tanUp + v * (tanDown - tanUp);
+
+                // Pre-distort so the lens undoes it
+                float r2 = tanX * tanX + tanY * tanY;
+                float scale = 1.0f + config_.distortionK1 * r2 + config_.distortionK2 * r2 * r2;
+
+                MeshVertex& vertex = mesh_[eye][j * (res + 1) + i];
+                vertex.tanX = tanX * scale;
+                vertex.tanY = tanY * scale;
+            }
+        }
+    }
+}
+
+bool CpuCompositorBackend::Initialize() {
+    if (!workers_.empty()) {
+        return true;
+    }
+    if (config_.eyeWidth == 0 || config_.eyeHeight == 0) {
+        LOGE("CPU compositor: invalid eye size %ux%u", config_.eyeWidth, config_.eyeHeight);
+        return false;
+    }
+
+    for (uint32_t eye = 0; eye < 2; ++eye) {
+        outputPixels_[eye].assign(static_cast<size_t>(config_.eyeWidth) * config_.eyeHeight * 4, 0);
+        output_[eye].pixels = outputPixels_[eye].data();
+        output_[eye].width = config_.eyeWidth;
+        output_[eye].height = config_.eyeHeight;
+        output_[eye].stride = config_.eyeWidth * 4;
+    }
+    BuildDistortionMesh();
+
+    tilesX_ = (config_.eyeWidth + CPU_COMPOSITOR_TILE_SIZE - 1) / CPU_COMPOSITOR_TILE_SIZE;
+    tilesY_ = (config_.eyeHeight + CPU_COMPOSITOR_TILE_SIZE - 1) / CPU_COMPOSITOR_TILE_SIZE;
+    tileCount_ = tilesX_ * tilesY_ * 2;
+
+    // The thread calling Compose works too
+    uint32_t threadCount = config_.threadCount;
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    stopping_ = false;
+    nextTile_.store(tileCount_);
+    tilesDone_.store(tileCount_);
+    for (uint32_t i = 1; i < threadCount; ++i) {
+        workers_.emplace_back(&CpuCompositorBackend::WorkerMain, this);
+    }
+
+    LOGI("CPU compositor: %ux%u per eye, %u threads", config_.eyeWidth, config_.eyeHeight, threadCount);
+    return true;
+}
+
+void CpuCompositorBackend::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workCondition_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+bool CpuCompositorBackend::SampleWarpPoses(XrTime renderTime, XrTime targetTime,
+                                           XrPosef* renderPose, XrPosef* displayPose) {
+    if (config_.samplePoses) {
+        return config_.samplePoses(config_.context, renderTime, targetTime, renderPose, displayPose);
+    }
+
+    *renderPose = {{0, 0, 0, 1}, {0, 0, 0}};
+    *displayPose = *renderPose;
+    return true;
+}
+
+void CpuCompositorBackend::WorkerMain() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (;;) {
+        workCondition_.wait(lock, [this, seen]() { return stopping_ || generation_ != seen; });
+        if (stopping_) {
+            return;
+        }
+        seen = generation_;
+
+        lock.unlock();
+        RunTiles();
+        lock.lock();
+    }
+}
+
+void CpuCompositorBackend::RunTiles() {
+    for (;;) {
+        uint32_t tile = nextTile_.fetch_add(1);
+        if (tile >= tileCount_) {
+            return;
+        }
+
+        ComposeTile(tile);
+
+        if (tilesDone_.fetch_add(1) + 1 == tileCount_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            doneCondition_.notify_all();
+        }
+    }
+}
+
+void CpuCompositorBackend::ComposeTile(uint32_t tile) {
+    uint32_t tilesPerEye = tilesX_ * tilesY_;
+    uint32_t eye = tile / tilesPerEye;
+    uint32_t index = tile % tilesPerEye;
+    uint32_t x0 = (index % tilesX_) * CPU_COMPOSITOR_TILE_SIZE;
+    uint32_t y0 = (index / tilesX_) * CPU_COMPOSITOR_TILE_SIZE;
+    uint32_t x1 = std::min(x0 + CPU_COMPOSITOR_TILE_SIZE, config_.eyeWidth);
+    uint32_t y1 = std::min(y0 + CPU_COMPOSITOR_TILE_SIZE, config_.eyeHeight);
+
+    const HostImage& out = output_[eye];
+    const MeshVertex* mesh = mesh_[eye].data();
+    uint32_t res = config_.meshResolution;
+    float meshScaleX = static_cast<float>(res) / config_.eyeWidth;
+    float meshScaleY = static_cast<float>(res) / config_.eyeHeight;
+    const float* m = headWarp_;
+
+    for (uint32_t y = y0; y < y1; ++y) {
+        float my = (y + 0.5f) * meshScaleY;
+        uint32_t cy = std::min(static_cast<uint32_t>(my), res - 1);
+        float fy = my - cy;
+        const MeshVertex* meshRow0 = mesh + cy * (res + 1);
+        const MeshVertex* meshRow1 = meshRow0 + (res + 1);
+        uint8_t* outRow = out.pixels + static_cast<size_t>(y) * out.stride;
+
+        for (uint32_t x = x0; x < x1; ++x) {
+            float mx = (x + 0.5f) * meshScaleX;
+            uint32_t cx = std::min(static_cast<uint32_t>(mx), res - 1);
+            float fx = mx - cx;
+
+            // Distorted direction in display head space, z = -1
+            float topX = meshRow0[cx].tanX + (meshRow0[cx + 1].tanX - meshRow0[cx].tanX) * fx;
+            float topY = meshRow0[cx].tanY + (meshRow0[cx + 1].tanY - meshRow0[cx].tanY) * fx;
+            float botX = meshRow1[cx].tanX + (meshRow1[cx + 1].tanX - meshRow1[cx].tanX) * fx;
+            float botY = meshRow1[cx].tanY + (meshRow1[cx + 1].tanY - meshRow1[cx].tanY) * fx;
+            XrVector3f dir = {topX + (botX - topX) * fy, topY + (botY - topY) * fy, -1.0f};
+
+            // Same direction in render head space (rotational time warp)
+            XrVector3f warped = {
+                m[0] * dir.x + m[1] * dir.y + m[2] * dir.z,
+                m[3] * dir.x + m[4] * dir.y + m[5] * dir.z,
+                m[6] * dir.x + m[7] * dir.y + m[8] * dir.z,
+            };
+
+            Vec4f color = Vec4Zero();
+
+            for (uint32_t l = 0; l < frame_->layerCount; ++l) {
+                const CompositorLayer& layer = frame_->layers[l];
+                uint32_t viewIndex = eye < layer.viewCount ? eye : 0;
+                const LayerView& view = layerViews_[l][viewIndex];
+                if (!view.valid) {
+                    continue;
+                }
+
+                float u, v;
+                if (layer.type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+                    if (warped.z > -1e-4f) {
+                        continue;
+                    }
+                    float tanX = warped.x / -warped.z;
+                    float tanY = warped.y / -warped.z;
+                    u = (tanX - view.tanLeft) / (view.tanRight - view.tanLeft);
+                    v = (view.tanUp - tanY) / (view.tanUp - view.tanDown);
+                } else {
+                    // Quad: head-locked, so intersect the unwarped ray
+                    if ((layer.eyeVisibility == XR_EYE_VISIBILITY_LEFT && eye != 0) ||
+                        (layer.eyeVisibility == XR_EYE_VISIBILITY_RIGHT && eye != 1)) {
+                        continue;
+                    }
+                    float denom = Dot(dir, view.normal);
+                    if (fabsf(denom) < 1e-6f) {
+                        continue;
+                    }
+                    float t = Dot(view.center, view.normal) / denom;
+                    if (t <= 0.0f) {
+                        continue;
+                    }
+                    XrVector3f rel = {dir.x * t - view.center.x, dir.y * t - view.center.y,
+                                      dir.z * t - view.center.z};
+                    u = Dot(rel, view.right) / layer.size.width + 0.5f;
+                    v = 0.5f - Dot(rel, view.up) / layer.size.height;
+                }
+
+                if (u < 0.0f || u > 1.0f || v < 0.0f || v > 1.0f) {
+                    continue;
+                }
+
+                Vec4f texel = SampleBilinear(view.image, view.imageRect, u, v);
+
+                if (!(layer.layerFlags & XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT)) {
+                    color = texel;  // Opaque
+                    continue;
+                }
+
+                float alpha = Vec4Alpha(texel) * (1.0f / 255.0f);
+                if (layer.layerFlags & XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT) {
+                    texel = Vec4ScaleColor(texel, alpha);
+                }
+                color = Vec4MulAdd(texel, color, 1.0f - alpha);  // Premultiplied "over"
+            }
+
+            StoreTexel(outRow + x * 4, color);
+        }
+    }
+}
+
+bool CpuCompositorBackend::Compose(const CompositorFrame& frame, const CompositorWarp& warp) {
+    if (tileCount_ == 0) {
+        return false;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Head-space warp R^-1 * D. CalculateTimeWarpMatrix(a, b) builds
+    // b * a^-1, so a = D^-1 and b = R^-1.
+    XrPosef displayInverse = warp.displayPose;
+    XrPosef renderInverse = warp.renderPose;
+    displayInverse.orientation = QuatConjugate(warp.displayPose.orientation);
+    renderInverse.orientation = QuatConjugate(warp.renderPose.orientation);
+    float matrix[16];
+    CalculateTimeWarpMatrix(displayInverse, renderInverse, matrix);
+    for (uint32_t r = 0; r < 3; ++r) {
+        for (uint32_t c = 0; c < 3; ++c) {
+            headWarp_[r * 3 + c] = matrix[c * 4 + r];  // Column-major to row-major
+        }
+    }
+
+    // Resolve images and per-view constants once per composition
+    for (uint32_t l = 0; l < frame.layerCount; ++l) {
+        const CompositorLayer& layer = frame.layers[l];
+        for (uint32_t v = 0; v < MAX_COMPOSITOR_VIEWS; ++v) {
+            LayerView& view = layerViews_[l][v];
+            view.valid = false;
+            if (v >= layer.viewCount || !config_.resolveImage) {
+                continue;
+            }
+
+            const CompositorView& source = layer.views[v];
+            if (!config_.resolveImage(config_.context, source, &view.image) || !view.image.pixels) {
+                continue;
+            }
+
+            // Clip the rect to the image
+            XrRect2Di rect = source.imageRect;
+            rect.offset.x = std::max(0, rect.offset.x);
+            rect.offset.y = std::max(0, rect.offset.y);
+            rect.extent.width = std::min(rect.extent.width,
+                                         static_cast<int32_t>(view.image.width) - rect.offset.x);
+            rect.extent.height = std::min(rect.extent.height,
+                                          static_cast<int32_t>(view.image.height) - rect.offset.y);
+            if (rect.extent.width <= 0 || rect.extent.height <= 0) {
+                continue;
+            }
+            view.imageRect = rect;
+
+            if (layer.type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+                view.tanLeft = tanf(source.fov.angleLeft);
+                view.tanRight = tanf(source.fov.angleRight);
+                view.tanUp = tanf(source.fov.angleUp);
+                view.tanDown = tanf(source.fov.angleDown);
+                if (view.tanRight <= view.tanLeft || view.tanUp <= view.tanDown) {
+                    continue;
+                }
+            } else if (layer.type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
+                if (layer.size.width <= 0.0f || layer.size.height <= 0.0f) {
+                    continue;
+                }
+                const XrQuaternionf& q = source.pose.orientation;
+                view.center = source.pose.position;
+                view.right = QuatRotateVector(q, {1.0f, 0.0f, 0.0f});
+                view.up = QuatRotateVector(q, {0.0f, 1.0f, 0.0f});
+                view.normal = QuatRotateVector(q, {0.0f, 0.0f, 1.0f});
+            } else {
+                continue;
+            }
+            view.valid = true;
+        }
+    }
+
+    // Release the tiles to the workers and help out
+    frame_ = &frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tilesDone_.store(0);
+        nextTile_.store(0);
+        generation_++;
+    }
+    workCondition_.notify_all();
+
+    RunTiles();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCondition_.wait(lock, [this]() { return tilesDone_.load() == tileCount_; });
+    }
+    frame_ = nullptr;
+
+    XrDuration elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    composedFrames_.fetch_add(1, std::memory_order_relaxed);
+    composedPixels_.fetch_add(static_cast<uint64_t>(config_.eyeWidth) * config_.eyeHeight * 2,
+                              std::memory_order_relaxed);
+    composeTime_.fetch_add(elapsed, std::memory_order_relaxed);
+    return true;
+}
+
+const HostImage* CpuCompositorBackend::GetEyeOutput(uint32_t eye) const {
+    if (eye >= 2 || !output_[eye].pixels) {
+        return nullptr;
+    }
+    return &output_[eye];
+}
+
+void CpuCompositorBackend::GetStats(CpuCompositorStats* stats) const {
+    if (!stats) {
+        return;
+    }
+
+    stats->composedFrames = composedFrames_.load(std::memory_order_relaxed);
+    stats->composedPixels = composedPixels_.load(std::memory_order_relaxed);
+    stats->composeTime = composeTime_.load(std::memory_order_relaxed);
+    stats->megapixelsPerSecond = stats->composeTime > 0
+        ? static_cast<float>(stats->composedPixels) * 1e3f / static_cast<float>(stats->composeTime)
+        : 0.0f;
+}
@@ -0,0 +1,111 @@
+#ifndef CPU_COMPOSITOR_H
+#define CPU_COMPOSITOR_H
+
+#include <openxr/openxr.h>
+#include "compositor.h"
+#include "graphics_backend.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Looks up the host copy of a view's swapchain image (the image pinned for
+// the frame and the view's array layer). Called on the compositor thread
+// once per layer view per composition. ResolveSwapchainHostImage does this
+// for any graphics backend with host-visible images.
+typedef bool (*HostImageResolver)(void* context, const CompositorView& view, HostImage* image);
+
+// Head poses for a composition; identity poses are used when not set
+typedef bool (*HostPoseSampler)(void* context, XrTime renderTime, XrTime targetTime,
+                                XrPosef* renderPose, XrPosef* displayPose);
+
+struct CpuCompositorConfig {
+    uint32_t eyeWidth;
+    uint32_t eyeHeight;
+    XrFovf eyeFov[2];
+    float distortionK1;          // Radial lens distortion, tangent space
+    float distortionK2;
+    uint32_t meshResolution;     // Distortion mesh cells per axis
+    uint32_t threadCount;        // Worker threads, 0 = one per core
+    HostImageResolver resolveImage;
+    HostPoseSampler samplePoses;
+    void* context;               // Passed to the callbacks
+};
+
+struct CpuCompositorStats {
+    uint64_t composedFrames;
+    uint64_t composedPixels;
+    XrDuration composeTime;      // Total time spent in Compose
+    float megapixelsPerSecond;
+};
+
+// Reference compositor on the CPU: distortion mesh, rotational time warp,
+// bilinear sampling (SSE2/NEON when available) and layer blending, split
+// into tiles across worker threads. Runs without a GPU or QVR device.
+class CpuCompositorBackend : public CompositorBackend {
+public:
+    explicit CpuCompositorBackend(const CpuCompositorConfig& config);
+    ~CpuCompositorBackend() override;
+
+    CpuCompositorBackend(const CpuCompositorBackend&) = delete;
+    CpuCompositorBackend& operator=(const CpuCompositorBackend&) = delete;
+
+    bool Initialize() override;
+    void Shutdown() override;
+    bool SampleWarpPoses(XrTime renderTime, XrTime targetTime,
+                         XrPosef* renderPose, XrPosef* displayPose) override;
+    bool Compose(const CompositorFrame& frame, const CompositorWarp& warp) override;
+
+    // Composed output of the last Compose, eye 0 = left
+    const HostImage* GetEyeOutput(uint32_t eye) const;
+    void GetStats(CpuCompositorStats* stats) const;
+
+private:
+    struct MeshVertex {
+        float tanX, tanY;  // Source direction (tangent space) for the vertex
+    };
+
+    // Per layer view, resolved once per composition
+    struct LayerView {
+        HostImage image;
+        XrRect2Di imageRect;
+        bool valid;
+        float tanLeft, tanRight, tanUp, tanDown;  // Projection views
+        XrVector3f center, right, up, normal;     // Quad plane, head space
+    };
+
+    void BuildDistortionMesh();
+    void WorkerMain();
+    void RunTiles();
+    void ComposeTile(uint32_t tile);
+
+    CpuCompositorConfig config_;
+    std::vector<uint8_t> outputPixels_[2];
+    HostImage output_[2];
+    std::vector<MeshVertex> mesh_[2];
+
+    // Current job, written by Compose before the tiles are released
+    const CompositorFrame* frame_;
+    float headWarp_[9];  // Display head space -> render head space
+    LayerView layerViews_[MAX_COMPOSITOR_LAYERS][MAX_COMPOSITOR_VIEWS];
+    uint32_t tilesX_;
+    uint32_t tilesY_;
+    uint32_t tileCount_;
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable workCondition_;
+    std::condition_variable doneCondition_;
+    uint64_t generation_;
+    bool stopping_;
+    std::atomic<uint32_t> nextTile_;
+    std::atomic<uint32_t> tilesDone_;
+
+    std::atomic<uint64_t> composedFrames_;
+    std::atomic<uint64_t> composedPixels_;
+    std::atomic<int64_t> composeTime_;
+};
+
+#endif // CPU_COMPOSITOR_H
@@ -1,54 +1,108 @@
 #include "display_manager.h"
 #include "qualcomm/xr2_platform.h"
 #include "utils/logger.h"
-#include <EGL/egl.h>
-#include <GLES3/gl3.h>
+#include <atomic>
+#include <mutex>
 #include <vector>
-#include <cstring>
 
-bool CreateSwapchainImages(uint32_t width, uint32_t height, int64_t format, 
-                           uint32_t imageCount, void* images) {
-    LOGI("Creating swapchain images: %ux%u, format: %lld, count: %u", 
-         width, height, format, imageCount);
-    
-    // Create OpenGL ES textures for swapchain images
-    // This is a simplified implementation
-    GLuint* textures = static_cast<GLuint*>(images);
-    
-    glGenTextures(imageCount, textures);
-    
-    for (uint32_t i = 0; i < imageCount; ++i) {
-        glBindTexture(GL_TEXTURE_2D, textures[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, 
-                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+#ifdef __ANDROID__
+#include "gles_graphics_backend.h"
+#else
+#include "host_graphics_backend.h"
+#endif
+
+// Backend first: the pool's destructor still uses it
+#ifdef __ANDROID__
+static GlesGraphicsBackend g_defaultGraphics;
+#else
+static HostGraphicsBackend g_defaultGraphics;
+#endif
+static TexturePool g_swapchainTexturePool(&g_defaultGraphics, SWAPCHAIN_IMAGE_POOL_BUDGET);
+static std::atomic<GraphicsBackend*> g_graphicsBackend(&g_defaultGraphics);
+
+struct DeferredSwapchainDelete {
+    GraphicsBackend* backend;
+    SwapchainImageDesc desc;
+    std::vector<uint32_t> textures;
+    std::vector<GraphicsFence> fences;
+};
+
+static std::mutex g_deferredDeleteMutex;
+static std::vector<DeferredSwapchainDelete> g_deferredDeletes;
+
+void SetGraphicsBackend(GraphicsBackend* backend) {
+    if (!backend) {
+        backend = &g_defaultGraphics;
     }
     
-    glBindTexture(GL_TEXTURE_2D, 0);
-    
-    LOGI("Swapchain images created successfully");
-    return true;
+    // Pooled images belong to the old backend
+    g_swapchainTexturePool.SetBackend(backend);
+    g_graphicsBackend.store(backend, std::memory_order_release);
+    LOGI("Graphics backend: %s", backend->GetName());
+}
+
+GraphicsBackend* GetGraphicsBackend() {
+    return g_graphicsBackend.load(std::memory_order_acquire);
+}
+
+bool CreateSwapchainImages(GraphicsBackend* backend, const SwapchainImageDesc& desc, uint32_t imageCount,
+                           uint32_t* textures) {
+    if (!backend || !textures || imageCount == 0) {
+        return false;
+    }
+    return g_swapchainTexturePool.Acquire(backend, desc, imageCount, textures);
 }
 
-void DestroySwapchainImages(void* images, uint32_t imageCount) {
-    if (!images || imageCount == 0) {
+void DeferSwapchainDelete(GraphicsBackend* backend, const SwapchainImageDesc& desc,
+                          std::vector<uint32_t>&& textures, std::vector<GraphicsFence>&& fences) {
+    if (!backend || (textures.empty() && fences.empty())) {
         return;
     }
     
-    GLuint* textures = static_cast<GLuint*>(images);
-    glDeleteTextures(imageCount, textures);
+    std::lock_guard<std::mutex> lock(g_deferredDeleteMutex);
+    g_deferredDeletes.push_back({backend, desc, std::move(textures), std::move(fences)});
+}
+
+void FlushDeferredSwapchainDeletes() {
+    std::vector<DeferredSwapchainDelete> deletes;
+    {
+        std::lock_guard<std::mutex> lock(g_deferredDeleteMutex);
+        if (g_deferredDeletes.empty()) {
+            return;
+        }
+        deletes.swap(g_deferredDeletes);
+    }
     
-    LOGI("Swapchain images destroyed");
+    // Backend calls outside the lock: the compositor may be queueing more
+    for (DeferredSwapchainDelete& pending : deletes) {
+        for (GraphicsFence fence : pending.fences) {
+            pending.backend->DestroyFence(fence);
+        }
+        if (!pending.textures.empty()) {
+            g_swapchainTexturePool.Release(pending.backend, pending.desc, pending.textures.data(),
+                                           static_cast<uint32_t>(pending.textures.size()));
+        }
+    }
 }
 
-bool GetSupportedSwapchainFormats(std::vector<int64_t>& formats) {
-    // OpenGL ES formats
-    formats.push_back(GL_RGBA8);
-    formats.push_back(GL_RGB8);
-    formats.push_back(GL_RGBA16F);
-    formats.push_back(GL_RGB16F);
+void ReleaseSwapchainImagePool() {
+    FlushDeferredSwapchainDeletes();
     
+    TexturePoolStats stats;
+    g_swapchainTexturePool.GetStats(&stats);
+    LOGI("Swapchain texture pool: %llu hits, %llu misses, releasing %u textures (%llu KB)",
+         static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+         stats.texturesHeld, static_cast<unsigned long long>(stats.bytesHeld / 1024));
+    
+    g_swapchainTexturePool.Clear();
+}
+
+void GetSwapchainImagePoolStats(TexturePoolStats* stats) {
+    g_swapchainTexturePool.GetStats(stats);
+}
+
+bool GetSupportedSwapchainFormats(std::vector<int64_t>& formats) {
+    GetGraphicsBackend()->GetSupportedFormats(formats);
     return true;
 }
 
@@ -2,13 +2,43 @@
 #define DISPLAY_MANAGER_H
 
 #include <openxr/openxr.h>
+#include "graphics_backend.h"
 #include <vector>
 
-// Swapchain image creation
-bool CreateSwapchainImages(uint32_t width, uint32_t height, int64_t format, 
-                           uint32_t imageCount, void* images);
+// Idle swapchain textures kept for reuse after xrDestroySwapchain
+static const uint64_t SWAPCHAIN_IMAGE_POOL_BUDGET = 128ULL * 1024 * 1024;
 
-void DestroySwapchainImages(void* images, uint32_t imageCount);
+// Graphics API behind swapchain images: GLES on Android and host memory
+// elsewhere unless set. Set it before the first swapchain is created;
+// nullptr restores the default.
+void SetGraphicsBackend(GraphicsBackend* backend);
+GraphicsBackend* GetGraphicsBackend();
+
+// Swapchain image creation through the graphics backend: 'imageCount'
+// images (buffers) in 'desc.format'. On GLES, storage is immutable, images
+// with more than one layer are GL_TEXTURE_2D_ARRAY (multiview), storage
+// is single sample (sampleCount > 1 is rendered through
+// EXT_multisampled_render_to_texture) and mipCount is clamped to the full
+// chain. Images come from the swapchain texture pool and go back to it
+// through DeferSwapchainDelete.
+// 'backend' is the one the swapchain was created with; images of a backend
+// that has since been replaced are destroyed rather than pooled.
+bool CreateSwapchainImages(GraphicsBackend* backend, const SwapchainImageDesc& desc, uint32_t imageCount,
+                           uint32_t* textures);
+
+// Images and render fences of a swapchain whose last reference went. That
+// can be the compositor's unpin, on a thread without the app's graphics
+// context, so they are only queued here and handed back on the app's
+// graphics thread by FlushDeferredSwapchainDeletes (xrCreateSwapchain,
+// xrDestroySwapchain, xrEndFrame, session teardown).
+void DeferSwapchainDelete(GraphicsBackend* backend, const SwapchainImageDesc& desc,
+                          std::vector<uint32_t>&& textures, std::vector<GraphicsFence>&& fences);
+void FlushDeferredSwapchainDeletes();
+
+// Destroy the pooled textures (the app's graphics context goes away with
+// its session)
+void ReleaseSwapchainImagePool();
+void GetSwapchainImagePoolStats(TexturePoolStats* stats);
 
 // Supported formats
 bool GetSupportedSwapchainFormats(std::vector<int64_t>& formats);
@@ -0,0 +1,179 @@
+#include "frame_pacer.h"
+#include "frame_sync.h"
+#include "vsync_estimator.h"
+#include "vsync_source.h"
+#include "qualcomm/xr2_platform.h"
+#include "utils/logger.h"
+#include "utils/xr_time.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Fallback period used until the platform reports one
+static const XrDuration DEFAULT_FRAME_PERIOD_NS = 1000000000LL / 90;
+
+// Time reserved after xrEndFrame for composition before scanout
+static const XrDuration COMPOSITOR_MARGIN_NS = 2000000;  // 2 ms
+static const XrDuration MIN_WAKE_OFFSET_NS = 2000000;    // 2 ms
+static const uint32_t MAX_WAKE_OFFSET_PERIODS = 3;
+
+// Registered pacers (one per session). Only touched on session create/destroy
+// and once per vsync, never from the per-call API paths.
+static std::mutex g_pacerRegistryMutex;
+static std::vector<FramePacer*> g_framePacers;
+
+// One display, so one vsync model shared by every pacer
+static VsyncEstimator g_vsyncEstimator(DEFAULT_FRAME_PERIOD_NS);
+
+FramePacer::FramePacer()
+    : vsyncSequence(0), lastDisplayTime(0), displayPeriod(DEFAULT_FRAME_PERIOD_NS),
+      wakeOffset(DEFAULT_FRAME_PERIOD_NS), frameTimeMean(0), frameTimeDeviation(0),
+      cancelled(false) {
+    std::lock_guard<std::mutex> lock(g_pacerRegistryMutex);
+    g_framePacers.push_back(this);
+}
+
+FramePacer::~FramePacer() {
+    std::lock_guard<std::mutex> lock(g_pacerRegistryMutex);
+    g_framePacers.erase(std::remove(g_framePacers.begin(), g_framePacers.end(), this),
+                        g_framePacers.end());
+}
+
+// Target vsync for a frame that may not be displayed before 'earliest'
+static XrTime PredictFrameDisplayTime(const FramePacer* pacer, XrTime earliest, XrDuration* period) {
+    XrTime phase;
+    if (!g_vsyncEstimator.GetModel(&phase, period)) {
+        // No vsync yet: free-run on a grid anchored at the last frame
+        *period = pacer->displayPeriod;
+        phase = pacer->lastDisplayTime != 0 ? pacer->lastDisplayTime : earliest;
+    }
+    return NextVsyncAtOrAfter(phase, *period, earliest);
+}
+
+bool WaitForFramePacer(FramePacer* pacer, XrTime* predictedDisplayTime,
+                       XrDuration* predictedDisplayPeriod) {
+    if (!pacer || !predictedDisplayTime || !predictedDisplayPeriod) {
+        return false;
+    }
+
+    // Without a vsync source, poll the display's newest vsync here
+    if (GetVsyncSourceMode() == VSYNC_SOURCE_NONE) {
+        XrTime lastVsyncTime = 0;
+        XrDuration nominalPeriod = 0;
+        if (GetDisplayVsyncTiming(&lastVsyncTime, &nominalPeriod)) {
+            g_vsyncEstimator.SetNominalPeriod(nominalPeriod);
+            g_vsyncEstimator.AddVsync(lastVsyncTime);
+        }
+    }
+
+    XrTime displayTime;
+    XrDuration period;
+    {
+        std::unique_lock<std::mutex> lock(pacer->mutex);
+
+        // Earliest vsync the app can still make if woken now, and never the
+        // same vsync twice
+        XrTime now = GetXR2CurrentTime();
+        XrDuration lastPeriod = pacer->displayPeriod;
+        XrTime earliest = std::max(now + pacer->wakeOffset, pacer->lastDisplayTime + lastPeriod / 2);
+
+        // Sleep to the wake-up point; every vsync refines the grid, so
+        // re-aim at the same slot when woken by one
+        for (;;) {
+            displayTime = PredictFrameDisplayTime(pacer, earliest, &period);
+            XrTime wakeTime = displayTime - pacer->wakeOffset;
+            if (pacer->cancelled || GetXR2CurrentTime() >= wakeTime) {
+                break;
+            }
+
+            uint64_t sequence = pacer->vsyncSequence;
+            pacer->condition.wait_until(lock, XrTimeToSteadyClock(wakeTime), [pacer, sequence]() {
+                return pacer->cancelled || pacer->vsyncSequence != sequence;
+            });
+        }
+
+        if (pacer->cancelled) {
+            return false;
+        }
+
+        pacer->lastDisplayTime = displayTime;
+        pacer->displayPeriod = period;
+    }
+
+    ScheduleFrame(displayTime);
+
+    *predictedDisplayTime = displayTime;
+    *predictedDisplayPeriod = period;
+    return true;
+}
+
+void EndFramePacerFrame(FramePacer* pacer, XrTime wakeTime) {
+    if (!pacer || wakeTime == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(pacer->mutex);
+
+    XrDuration frameTime = GetXR2CurrentTime() - wakeTime;
+
+    // Smoothed mean and mean deviation (1/8 and 1/4 gains)
+    if (pacer->frameTimeMean == 0) {
+        pacer->frameTimeMean = frameTime;
+        pacer->frameTimeDeviation = frameTime / 2;
+    } else {
+        XrDuration error = frameTime - pacer->frameTimeMean;
+        pacer->frameTimeMean += error / 8;
+        pacer->frameTimeDeviation += ((error < 0 ? -error : error) - pacer->frameTimeDeviation) / 4;
+    }
+
+    // Wake early enough to cover a slow frame plus composition
+    XrDuration offset = pacer->frameTimeMean + 2 * pacer->frameTimeDeviation + COMPOSITOR_MARGIN_NS;
+    XrDuration maxOffset = pacer->displayPeriod * MAX_WAKE_OFFSET_PERIODS;
+    pacer->wakeOffset = std::min(std::max(offset, MIN_WAKE_OFFSET_NS), maxOffset);
+}
+
+void ResetFramePacer(FramePacer* pacer) {
+    if (!pacer) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(pacer->mutex);
+    pacer->lastDisplayTime = 0;
+    pacer->wakeOffset = pacer->displayPeriod;
+    pacer->frameTimeMean = 0;
+    pacer->frameTimeDeviation = 0;
+    pacer->cancelled = false;
+}
+
+void CancelFramePacer(FramePacer* pacer) {
+    if (!pacer) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pacer->mutex);
+        pacer->cancelled = true;
+    }
+    pacer->condition.notify_all();
+}
+
+bool GetFramePacerVsyncModel(XrTime* phase, XrDuration* period) {
+    if (!phase || !period) {
+        return false;
+    }
+    return g_vsyncEstimator.GetModel(phase, period);
+}
+
+void NotifyFramePacersVsync(XrTime vsyncTime) {
+    g_vsyncEstimator.AddVsync(vsyncTime);
+
+    std::lock_guard<std::mutex> registryLock(g_pacerRegistryMutex);
+
+    for (FramePacer* pacer : g_framePacers) {
+        {
+            std::lock_guard<std::mutex> lock(pacer->mutex);
+            pacer->vsyncSequence++;
+        }
+        pacer->condition.notify_all();
+    }
+}
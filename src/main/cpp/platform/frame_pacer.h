@@ -0,0 +1,58 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <openxr/openxr.h>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Per-session frame pacer.
+// xrWaitFrame blocks on the pacer of its own session instead of holding the
+// global session lock, so other threads can keep validating handles while the
+// frame thread sleeps. Display times are placed on the vsync grid estimated
+// from the display's vsync history, and the thread is woken wakeOffset before
+// the target vsync. The offset follows the app's measured frame time. Each
+// published vsync wakes waiters so they re-aim at the refined grid.
+struct FramePacer {
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint64_t vsyncSequence;     // Bumped on every published vsync
+    XrTime lastDisplayTime;     // Display time handed out by the last wait
+    XrDuration displayPeriod;   // Current refresh period estimate
+    XrDuration wakeOffset;      // Wake this long before the target vsync
+    XrDuration frameTimeMean;   // Wake-up to xrEndFrame, smoothed
+    XrDuration frameTimeDeviation;
+    bool cancelled;
+
+    FramePacer();
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+};
+
+// Block until the wake-up point for the next frame, then return its
+// predicted display time (a vsync) and the refresh period. Free-runs at the
+// nominal period when no vsync has been observed.
+bool WaitForFramePacer(FramePacer* pacer, XrTime* predictedDisplayTime,
+                       XrDuration* predictedDisplayPeriod);
+
+// The app finished a frame whose wait returned at 'wakeTime' (xrEndFrame);
+// feeds the frame time that drives the wake-up offset. With several frames
+// in flight this is not necessarily the last wait.
+void EndFramePacerFrame(FramePacer* pacer, XrTime wakeTime);
+
+// Reset the pacer when its session starts running
+void ResetFramePacer(FramePacer* pacer);
+
+// Wake any thread blocked in WaitForFramePacer (session ending/destroyed)
+void CancelFramePacer(FramePacer* pacer);
+
+// Vsync grid shared by every pacer (newest fitted vsync and period); false
+// until a vsync has been observed
+bool GetFramePacerVsyncModel(XrTime* phase, XrDuration* period);
+
+// Called by the vsync source with each vsync timestamp; wakes every pacer
+void NotifyFramePacersVsync(XrTime vsyncTime);
+
+#endif // FRAME_PACER_H
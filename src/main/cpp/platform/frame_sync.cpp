@@ -1,15 +1,31 @@
 #include "frame_sync.h"
+#include "compositor.h"
 #include "qualcomm/xr2_platform.h"
 #include "utils/logger.h"
 #include <chrono>
 
-bool WaitForNextFrame(XrTime* predictedDisplayTime, XrDuration* predictedDisplayPeriod) {
-    if (!predictedDisplayTime || !predictedDisplayPeriod) {
+bool GetDisplayVsyncTiming(XrTime* lastVsyncTime, XrDuration* nominalPeriod) {
+    if (!lastVsyncTime || !nominalPeriod) {
         return false;
     }
     
-    // Wait for next frame from XR2 display
-    return WaitForXR2NextFrame(predictedDisplayTime, predictedDisplayPeriod);
+    // Latest vsync reported by the XR2 display
+    return GetXR2VsyncTiming(lastVsyncTime, nominalPeriod);
+}
+
+void ScheduleFrame(XrTime predictedDisplayTime) {
+    // Per-frame bookkeeping on XR2 (statistics, tracking snapshot)
+    ScheduleXR2Frame(predictedDisplayTime);
+}
+
+bool SetDisplayVsyncCallback(bool enable) {
+    // Deliver XR2 display vsync interrupts to PublishVsync
+    return SetXR2VsyncCallback(enable);
+}
+
+CompositorBackend* GetDisplayCompositorBackend() {
+    // Composition on the XR2 display
+    return GetXR2CompositorBackend();
 }
 
 bool BeginFrameRendering() {
@@ -22,13 +38,15 @@ bool EndFrameRendering() {
     return EndXR2FrameRendering();
 }
 
-bool SubmitFrameLayers(const XrCompositionLayerBaseHeader* const* layers, uint32_t layerCount) {
+CompositorSubmitResult SubmitFrameLayers(uint64_t frameId, XrTime displayTime,
+                                         const XrCompositionLayerBaseHeader* const* layers,
+                                         uint32_t layerCount) {
     if (!layers || layerCount == 0) {
-        return false;
+        return COMPOSITOR_SUBMIT_FAILED;
     }
     
-    // Submit layers to XR2 compositor
-    return SubmitXR2FrameLayers(layers, layerCount);
+    // Hand the frame to the compositor thread; returns without composing
+    return SubmitCompositorLayers(frameId, displayTime, layers, layerCount);
 }
 
 
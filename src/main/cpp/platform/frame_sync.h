@@ -2,14 +2,24 @@
 #define FRAME_SYNC_H
 
 #include <openxr/openxr.h>
+#include "compositor.h"
+#include <cstdint>
 
 // Frame synchronization
-bool WaitForNextFrame(XrTime* predictedDisplayTime, XrDuration* predictedDisplayPeriod);
+bool GetDisplayVsyncTiming(XrTime* lastVsyncTime, XrDuration* nominalPeriod);
+void ScheduleFrame(XrTime predictedDisplayTime);
+bool SetDisplayVsyncCallback(bool enable);
 
 bool BeginFrameRendering();
 bool EndFrameRendering();
 
-bool SubmitFrameLayers(const XrCompositionLayerBaseHeader* const* layers, uint32_t layerCount);
+// Compositor backend for the display; the compositor thread draws with it
+CompositorBackend* GetDisplayCompositorBackend();
+
+// Queue a frame for the compositor thread; frameId keys the frame's
+// telemetry record
+CompositorSubmitResult SubmitFrameLayers(uint64_t frameId, XrTime displayTime,
+                       const XrCompositionLayerBaseHeader* const* layers, uint32_t layerCount);
 
 #endif // FRAME_SYNC_H
 
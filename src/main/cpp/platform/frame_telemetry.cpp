@@ -0,0 +1,258 @@
+#include "frame_telemetry.h"
+#include "qualcomm/xr2_platform.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <atomic>
+
+// Ring slot; fields are atomics so the frame thread, compositor and vsync
+// source can stamp events without locks. frameId is cleared while a slot is
+// being reused, so a reader that sees the same id before and after copying
+// got a record of that frame.
+struct FrameTimingSlot {
+    std::atomic<uint64_t> frameId;
+    std::atomic<XrTime> predictedDisplayTime;
+    std::atomic<XrDuration> predictedDisplayPeriod;
+    std::atomic<XrTime> eventTime[FRAME_EVENT_COUNT];
+};
+
+static FrameTimingSlot g_frameTimings[FRAME_TELEMETRY_CAPACITY];
+static std::atomic<uint64_t> g_newestFrameId(0);
+static std::atomic<uint64_t> g_vsyncFrameCursor(0);  // Next frame to attribute a vsync to
+static std::atomic<uint64_t> g_frameDrops[FRAME_DROP_CAUSE_COUNT];
+
+static FrameTimingSlot* GetFrameTimingSlot(uint64_t frameId) {
+    return &g_frameTimings[frameId % FRAME_TELEMETRY_CAPACITY];
+}
+
+// Oldest frame id that can still be in the ring
+static uint64_t OldestFrameId(uint64_t newest) {
+    return newest >= FRAME_TELEMETRY_CAPACITY ? newest - FRAME_TELEMETRY_CAPACITY + 1 : 1;
+}
+
+static bool ReadFrameTimingSlot(uint64_t frameId, FrameTimingRecord* record) {
+    FrameTimingSlot* slot = GetFrameTimingSlot(frameId);
+    if (frameId == 0 || slot->frameId.load(std::memory_order_acquire) != frameId) {
+        return false;
+    }
+
+    record->frameId = frameId;
+    record->predictedDisplayTime = slot->predictedDisplayTime.load(std::memory_order_relaxed);
+    record->predictedDisplayPeriod = slot->predictedDisplayPeriod.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < FRAME_EVENT_COUNT; ++i) {
+        record->eventTime[i] = slot->eventTime[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->frameId.load(std::memory_order_relaxed) == frameId;
+}
+
+void BeginFrameTiming(uint64_t frameId, XrTime predictedDisplayTime,
+                      XrDuration predictedDisplayPeriod) {
+    if (frameId == 0) {
+        return;
+    }
+
+    FrameTimingSlot* slot = GetFrameTimingSlot(frameId);
+    slot->frameId.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->predictedDisplayTime.store(predictedDisplayTime, std::memory_order_relaxed);
+    slot->predictedDisplayPeriod.store(predictedDisplayPeriod, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < FRAME_EVENT_COUNT; ++i) {
+        slot->eventTime[i].store(0, std::memory_order_relaxed);
+    }
+    slot->eventTime[FRAME_EVENT_WAIT_RETURN].store(GetXR2CurrentTime(), std::memory_order_relaxed);
+
+    slot->frameId.store(frameId, std::memory_order_release);
+    g_newestFrameId.store(frameId, std::memory_order_release);
+}
+
+void RecordFrameEvent(uint64_t frameId, FrameTimingEvent event) {
+    if (frameId == 0 || event >= FRAME_EVENT_COUNT) {
+        return;
+    }
+
+    FrameTimingSlot* slot = GetFrameTimingSlot(frameId);
+    if (slot->frameId.load(std::memory_order_acquire) != frameId) {
+        return;
+    }
+
+    XrTime now = GetXR2CurrentTime();
+    slot->eventTime[event].store(now, std::memory_order_relaxed);
+
+    if (event == FRAME_EVENT_END &&
+        now > slot->predictedDisplayTime.load(std::memory_order_relaxed)) {
+        RecordFrameDrop(FRAME_DROP_LATE_SUBMIT);
+    }
+}
+
+void RecordFrameDrop(FrameDropCause cause) {
+    if (cause < FRAME_DROP_CAUSE_COUNT) {
+        g_frameDrops[cause].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RecordDisplayVsync(XrTime vsyncTime) {
+    uint64_t newest = g_newestFrameId.load(std::memory_order_acquire);
+    uint64_t frameId = std::max(g_vsyncFrameCursor.load(std::memory_order_relaxed),
+                                OldestFrameId(newest));
+
+    for (; frameId <= newest; ++frameId) {
+        FrameTimingSlot* slot = GetFrameTimingSlot(frameId);
+        if (slot->frameId.load(std::memory_order_acquire) != frameId) {
+            continue;  // Already reused
+        }
+        if (slot->eventTime[FRAME_EVENT_VSYNC].load(std::memory_order_relaxed) != 0) {
+            continue;
+        }
+
+        XrTime predicted = slot->predictedDisplayTime.load(std::memory_order_relaxed);
+        XrDuration period = slot->predictedDisplayPeriod.load(std::memory_order_relaxed);
+        XrTime end = slot->eventTime[FRAME_EVENT_END].load(std::memory_order_relaxed);
+
+        if (end == 0) {
+            if (predicted + period < vsyncTime) {
+                continue;  // Discarded, or ending late; never gets a vsync
+            }
+            break;
+        }
+        if (end > vsyncTime || predicted > vsyncTime + period / 2) {
+            break;  // Shown at a later vsync
+        }
+
+        slot->eventTime[FRAME_EVENT_VSYNC].store(vsyncTime, std::memory_order_relaxed);
+
+        // Late submits were already counted at xrEndFrame
+        if (end <= predicted && vsyncTime > predicted + period / 2) {
+            RecordFrameDrop(FRAME_DROP_MISSED_VSYNC);
+        }
+    }
+
+    g_vsyncFrameCursor.store(frameId, std::memory_order_relaxed);
+}
+
+bool GetFrameTiming(uint64_t frameId, FrameTimingRecord* record) {
+    if (!record) {
+        return false;
+    }
+    return ReadFrameTimingSlot(frameId, record);
+}
+
+uint32_t GetRecentFrameTimings(FrameTimingRecord* records, uint32_t capacity) {
+    if (!records || capacity == 0) {
+        return 0;
+    }
+
+    uint64_t newest = g_newestFrameId.load(std::memory_order_acquire);
+    if (newest == 0) {
+        return 0;
+    }
+
+    uint64_t first = OldestFrameId(newest);
+    if (newest - first + 1 > capacity) {
+        first = newest - capacity + 1;
+    }
+
+    uint32_t count = 0;
+    for (uint64_t frameId = first; frameId <= newest; ++frameId) {
+        if (ReadFrameTimingSlot(frameId, &records[count])) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Nearest-rank percentiles; sorts 'durations' in place
+static FrameDurationPercentiles ComputePercentiles(XrDuration* durations, uint32_t count) {
+    FrameDurationPercentiles result = {};
+    result.count = count;
+    if (count == 0) {
+        return result;
+    }
+
+    std::sort(durations, durations + count);
+    result.p50 = durations[(count * 50 + 99) / 100 - 1];
+    result.p90 = durations[(count * 90 + 99) / 100 - 1];
+    result.p99 = durations[(count * 99 + 99) / 100 - 1];
+    result.max = durations[count - 1];
+    return result;
+}
+
+void GetFrameTimingStats(FrameTimingStats* stats) {
+    if (!stats) {
+        return;
+    }
+
+    *stats = {};
+
+    FrameTimingRecord records[FRAME_TELEMETRY_CAPACITY];
+    uint32_t count = GetRecentFrameTimings(records, FRAME_TELEMETRY_CAPACITY);
+
+    XrDuration appCpu[FRAME_TELEMETRY_CAPACITY];
+    XrDuration compositor[FRAME_TELEMETRY_CAPACITY];
+    XrDuration latency[FRAME_TELEMETRY_CAPACITY];
+    uint32_t appCpuCount = 0;
+    uint32_t compositorCount = 0;
+    uint32_t latencyCount = 0;
+    XrTime firstWake = 0;
+    XrTime lastWake = 0;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const XrTime* t = records[i].eventTime;
+        XrTime wake = t[FRAME_EVENT_WAIT_RETURN];
+
+        if (wake != 0 && t[FRAME_EVENT_END] != 0) {
+            appCpu[appCpuCount++] = t[FRAME_EVENT_END] - wake;
+        }
+        if (t[FRAME_EVENT_COMPOSITOR_PICKUP] != 0 && t[FRAME_EVENT_VSYNC] != 0) {
+            compositor[compositorCount++] = t[FRAME_EVENT_VSYNC] - t[FRAME_EVENT_COMPOSITOR_PICKUP];
+        }
+        if (wake != 0 && t[FRAME_EVENT_VSYNC] != 0) {
+            latency[latencyCount++] = t[FRAME_EVENT_VSYNC] - wake;
+        }
+
+        if (wake != 0) {
+            if (firstWake == 0) {
+                firstWake = wake;
+            }
+            lastWake = wake;
+        }
+    }
+
+    stats->frameCount = count;
+    if (count > 1 && lastWake > firstWake) {
+        stats->frameRate = static_cast<float>(count - 1) * 1e9f /
+                           static_cast<float>(lastWake - firstWake);
+    }
+    stats->appCpu = ComputePercentiles(appCpu, appCpuCount);
+    stats->compositor = ComputePercentiles(compositor, compositorCount);
+    stats->latency = ComputePercentiles(latency, latencyCount);
+    for (uint32_t i = 0; i < FRAME_DROP_CAUSE_COUNT; ++i) {
+        stats->drops[i] = g_frameDrops[i].load(std::memory_order_relaxed);
+    }
+}
+
+void LogFrameTimingStats(const FrameTimingStats& stats) {
+    LOGI("Frame timing: %.1f FPS, app p50/p90/p99=%.2f/%.2f/%.2f ms, "
+         "compositor p50/p99=%.2f/%.2f ms, latency p50/p99=%.2f/%.2f ms, "
+         "drops discarded=%llu late=%llu missed=%llu queue=%llu",
+         stats.frameRate,
+         stats.appCpu.p50 / 1e6, stats.appCpu.p90 / 1e6, stats.appCpu.p99 / 1e6,
+         stats.compositor.p50 / 1e6, stats.compositor.p99 / 1e6,
+         stats.latency.p50 / 1e6, stats.latency.p99 / 1e6,
+         static_cast<unsigned long long>(stats.drops[FRAME_DROP_DISCARDED]),
+         static_cast<unsigned long long>(stats.drops[FRAME_DROP_LATE_SUBMIT]),
+         static_cast<unsigned long long>(stats.drops[FRAME_DROP_MISSED_VSYNC]),
+         static_cast<unsigned long long>(stats.drops[FRAME_DROP_QUEUE_FULL]));
+}
+
+void ResetFrameTelemetry() {
+    for (FrameTimingSlot& slot : g_frameTimings) {
+        slot.frameId.store(0, std::memory_order_relaxed);
+    }
+    for (uint32_t i = 0; i < FRAME_DROP_CAUSE_COUNT; ++i) {
+        g_frameDrops[i].store(0, std::memory_order_relaxed);
+    }
+    g_vsyncFrameCursor.store(0, std::memory_order_relaxed);
+    g_newestFrameId.store(0, std::memory_order_release);
+}
@@ -0,0 +1,86 @@
+#ifndef FRAME_TELEMETRY_H
+#define FRAME_TELEMETRY_H
+
+#include <openxr/openxr.h>
+#include <cstdint>
+
+// Frames kept in the timing ring (~2.8 s at 90 Hz)
+static const uint32_t FRAME_TELEMETRY_CAPACITY = 256;
+
+// Frames between periodic stats logs (10 s at 90 Hz); the perf governor
+// thread logs them
+static const uint32_t FRAME_TELEMETRY_LOG_INTERVAL = 900;
+
+// Points in a frame's life, in order
+enum FrameTimingEvent {
+    FRAME_EVENT_WAIT_RETURN = 0,   // xrWaitFrame returned
+    FRAME_EVENT_BEGIN,             // xrBeginFrame
+    FRAME_EVENT_END,               // xrEndFrame
+    FRAME_EVENT_LAYER_SUBMIT,      // Layers handed to the compositor
+    FRAME_EVENT_COMPOSITOR_PICKUP, // Compositor started on the frame
+    FRAME_EVENT_VSYNC,             // Vsync the frame was displayed at
+    FRAME_EVENT_COUNT
+};
+
+enum FrameDropCause {
+    FRAME_DROP_DISCARDED = 0,   // Begun but never ended (XR_FRAME_DISCARDED)
+    FRAME_DROP_LATE_SUBMIT,     // xrEndFrame after the predicted display time
+    FRAME_DROP_MISSED_VSYNC,    // Submitted in time, displayed a vsync late
+    FRAME_DROP_QUEUE_FULL,      // Compositor queue or frame arenas full at xrEndFrame
+    FRAME_DROP_CAUSE_COUNT
+};
+
+// One frame's timestamps; 0 = event not (yet) recorded
+struct FrameTimingRecord {
+    uint64_t frameId;
+    XrTime predictedDisplayTime;
+    XrDuration predictedDisplayPeriod;
+    XrTime eventTime[FRAME_EVENT_COUNT];
+};
+
+struct FrameDurationPercentiles {
+    uint32_t count;  // Frames that contributed
+    XrDuration p50;
+    XrDuration p90;
+    XrDuration p99;
+    XrDuration max;
+};
+
+struct FrameTimingStats {
+    uint32_t frameCount;
+    float frameRate;                       // Frames per second over the window
+    FrameDurationPercentiles appCpu;       // Wait return to xrEndFrame
+    FrameDurationPercentiles compositor;   // Compositor pickup to vsync
+    FrameDurationPercentiles latency;      // Wait return to vsync
+    uint64_t drops[FRAME_DROP_CAUSE_COUNT];  // Since the last reset
+};
+
+// Frame thread: the frame's wait returned. Claims the frame's ring slot and
+// stamps FRAME_EVENT_WAIT_RETURN.
+void BeginFrameTiming(uint64_t frameId, XrTime predictedDisplayTime,
+                      XrDuration predictedDisplayPeriod);
+
+// Stamp one event with the current time; lock-free, any thread. Ignored if
+// the frame has already left the ring.
+void RecordFrameEvent(uint64_t frameId, FrameTimingEvent event);
+
+void RecordFrameDrop(FrameDropCause cause);
+
+// Vsync source thread: attribute a vsync to the ended frames it displayed
+void RecordDisplayVsync(XrTime vsyncTime);
+
+// Copy of one frame's record, false if it has left the ring
+bool GetFrameTiming(uint64_t frameId, FrameTimingRecord* record);
+
+// Copy of the frames in the ring, oldest first. Returns the number copied.
+uint32_t GetRecentFrameTimings(FrameTimingRecord* records, uint32_t capacity);
+
+// Percentiles over the frames in the ring; sorts, so keep it off the
+// per-frame path
+void GetFrameTimingStats(FrameTimingStats* stats);
+void LogFrameTimingStats(const FrameTimingStats& stats);
+
+// Session start
+void ResetFrameTelemetry();
+
+#endif // FRAME_TELEMETRY_H
@@ -0,0 +1,245 @@
+#include "gles_graphics_backend.h"
+#include "utils/logger.h"
+#include <GLES3/gl32.h>
+#include <cstdint>
+
+// Swapchain formats, in preference order, with their size per texel (RGB
+// formats are padded to four components by the driver) and how blits
+// attach them
+struct GlesSwapchainFormat {
+    GLenum internalFormat;
+    uint32_t texelBytes;
+    GLenum attachment;
+    GLbitfield blitMask;
+};
+
+static const GlesSwapchainFormat g_glesSwapchainFormats[] = {
+    {GL_RGBA8, 4, GL_COLOR_ATTACHMENT0, GL_COLOR_BUFFER_BIT},
+    {GL_SRGB8_ALPHA8, 4, GL_COLOR_ATTACHMENT0, GL_COLOR_BUFFER_BIT},
+    {GL_RGB8, 4, GL_COLOR_ATTACHMENT0, GL_COLOR_BUFFER_BIT},
+    {GL_RGBA16F, 8, GL_COLOR_ATTACHMENT0, GL_COLOR_BUFFER_BIT},
+    {GL_RGB16F, 8, GL_COLOR_ATTACHMENT0, GL_COLOR_BUFFER_BIT},
+    {GL_DEPTH_COMPONENT16, 2, GL_DEPTH_ATTACHMENT, GL_DEPTH_BUFFER_BIT},
+    {GL_DEPTH_COMPONENT24, 4, GL_DEPTH_ATTACHMENT, GL_DEPTH_BUFFER_BIT},
+    {GL_DEPTH_COMPONENT32F, 4, GL_DEPTH_ATTACHMENT, GL_DEPTH_BUFFER_BIT},
+    {GL_DEPTH24_STENCIL8, 4, GL_DEPTH_STENCIL_ATTACHMENT, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT},
+};
+
+static const GlesSwapchainFormat* FindGlesSwapchainFormat(int64_t format) {
+    for (const GlesSwapchainFormat& entry : g_glesSwapchainFormats) {
+        if (entry.internalFormat == format) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+// Levels of a full mip chain down to 1x1
+static uint32_t GetMaxMipLevels(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    for (uint32_t size = width > height ? width : height; size > 1; size >>= 1) {
+        ++levels;
+    }
+    return levels;
+}
+
+static uint32_t GetLevelCount(const SwapchainImageDesc& desc) {
+    uint32_t maxLevels = GetMaxMipLevels(desc.width, desc.height);
+    uint32_t levels = desc.mipCount > 0 ? desc.mipCount : 1;
+    return levels < maxLevels ? levels : maxLevels;
+}
+
+GlesGraphicsBackend::GlesGraphicsBackend() {
+}
+
+const char* GlesGraphicsBackend::GetName() const {
+    return "GLES";
+}
+
+void GlesGraphicsBackend::GetSupportedFormats(std::vector<int64_t>& formats) const {
+    for (const GlesSwapchainFormat& entry : g_glesSwapchainFormats) {
+        formats.push_back(entry.internalFormat);
+    }
+}
+
+// Storage is immutable (glTexStorage*): the driver allocates every level up
+// front and can skip completeness checks on each bind
+bool GlesGraphicsBackend::CreateTextures(const SwapchainImageDesc& desc, uint32_t count, uint32_t* textures) {
+    GLenum internalFormat = static_cast<GLenum>(desc.format);
+    if (!FindGlesSwapchainFormat(desc.format)) {
+        LOGE("Unsupported swapchain format: 0x%llx", static_cast<unsigned long long>(desc.format));
+        return false;
+    }
+
+    // Storage is single sample even for sampleCount > 1: the app renders
+    // through EXT_multisampled_render_to_texture (or the OVR_multiview
+    // variant), which keeps the samples in tile memory and resolves on the
+    // way out, so the compositor always samples a resolved image
+    bool layered = desc.arraySize > 1;  // OVR_multiview renders all layers in one pass
+    uint32_t levels = GetLevelCount(desc);
+    GLenum target = layered ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+
+    LOGI("Creating swapchain images: %ux%u, format: 0x%x, layers: %u, samples: %u, levels: %u, count: %u",
+         desc.width, desc.height, internalFormat, desc.arraySize, desc.sampleCount, levels, count);
+
+    while (glGetError() != GL_NO_ERROR) {
+        // Don't blame the allocation for the app's earlier errors
+    }
+
+    glGenTextures(count, textures);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        glBindTexture(target, textures[i]);
+        if (layered) {
+            glTexStorage3D(target, levels, internalFormat, desc.width, desc.height, desc.arraySize);
+        } else {
+            glTexStorage2D(target, levels, internalFormat, desc.width, desc.height);
+        }
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    glBindTexture(target, 0);
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        LOGE("Swapchain image allocation failed: GL error 0x%x", error);
+        glDeleteTextures(count, textures);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t i = 0; i < count; ++i) {
+        textures_[textures[i]] = {target, desc.format, desc.width, desc.height};
+    }
+    return true;
+}
+
+void GlesGraphicsBackend::DestroyTextures(const uint32_t* textures, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (uint32_t i = 0; i < count; ++i) {
+            textures_.erase(textures[i]);
+        }
+    }
+    glDeleteTextures(count, textures);
+}
+
+uint64_t GlesGraphicsBackend::TextureBytes(const SwapchainImageDesc& desc) const {
+    const GlesSwapchainFormat* format = FindGlesSwapchainFormat(desc.format);
+    uint64_t texelBytes = format ? format->texelBytes : 4;
+    uint32_t levels = GetLevelCount(desc);
+
+    uint64_t bytes = 0;
+    uint64_t width = desc.width, height = desc.height;
+    for (uint32_t level = 0; level < levels; ++level) {
+        bytes += width * height;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return bytes * texelBytes * desc.arraySize;  // Samples live in tile memory
+}
+
+GraphicsFence GlesGraphicsBackend::CreateFence() {
+    GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (!sync) {
+        return GRAPHICS_NO_FENCE;
+    }
+
+    // Other contexts only see the fence once it is flushed
+    glFlush();
+    return static_cast<GraphicsFence>(reinterpret_cast<uintptr_t>(sync));
+}
+
+bool GlesGraphicsBackend::WaitFence(GraphicsFence fence, XrDuration timeout) {
+    if (fence == GRAPHICS_NO_FENCE) {
+        return true;
+    }
+
+    GLuint64 glTimeout = timeout == XR_INFINITE_DURATION ? UINT64_MAX
+                       : timeout > 0 ? static_cast<GLuint64>(timeout) : 0;
+    GLsync sync = reinterpret_cast<GLsync>(static_cast<uintptr_t>(fence));
+    GLenum result = glClientWaitSync(sync, 0, glTimeout);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void GlesGraphicsBackend::DestroyFence(GraphicsFence fence) {
+    if (fence != GRAPHICS_NO_FENCE) {
+        glDeleteSync(reinterpret_cast<GLsync>(static_cast<uintptr_t>(fence)));
+    }
+}
+
+bool GlesGraphicsBackend::AttachTexture(uint32_t framebuffer, uint32_t framebufferTarget,
+                                        const TextureInfo& info, uint32_t texture, uint32_t arrayIndex) {
+    const GlesSwapchainFormat* format = FindGlesSwapchainFormat(info.format);
+    if (!format) {
+        return false;
+    }
+
+    glBindFramebuffer(framebufferTarget, framebuffer);
+    if (info.target == GL_TEXTURE_2D_ARRAY) {
+        glFramebufferTextureLayer(framebufferTarget, format->attachment, texture, 0, arrayIndex);
+    } else {
+        glFramebufferTexture2D(framebufferTarget, format->attachment, info.target, texture, 0);
+    }
+    return glCheckFramebufferStatus(framebufferTarget) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+// Framebuffers aren't shared between contexts, so each blit makes its own;
+// blits are rare (resolves, copies), not per-pixel work
+bool GlesGraphicsBackend::BlitImage(const GraphicsImageRegion& source, const GraphicsImageRegion& destination) {
+    TextureInfo sourceInfo, destinationInfo;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto src = textures_.find(source.image);
+        auto dst = textures_.find(destination.image);
+        if (src == textures_.end() || dst == textures_.end()) {
+            return false;
+        }
+        sourceInfo = src->second;
+        destinationInfo = dst->second;
+    }
+
+    const GlesSwapchainFormat* format = FindGlesSwapchainFormat(sourceInfo.format);
+    if (!format) {
+        return false;
+    }
+
+    GLint previousRead = 0, previousDraw = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw);
+
+    GLuint framebuffers[2];
+    glGenFramebuffers(2, framebuffers);
+
+    bool complete =
+        AttachTexture(framebuffers[0], GL_READ_FRAMEBUFFER, sourceInfo, source.image, source.arrayIndex) &&
+        AttachTexture(framebuffers[1], GL_DRAW_FRAMEBUFFER, destinationInfo, destination.image,
+                      destination.arrayIndex);
+    if (complete) {
+        const XrRect2Di& s = source.rect;
+        const XrRect2Di& d = destination.rect;
+        bool scaled = s.extent.width != d.extent.width || s.extent.height != d.extent.height;
+        GLenum filter = scaled && format->blitMask == GL_COLOR_BUFFER_BIT ? GL_LINEAR : GL_NEAREST;
+        glBlitFramebuffer(s.offset.x, s.offset.y, s.offset.x + s.extent.width, s.offset.y + s.extent.height,
+                          d.offset.x, d.offset.y, d.offset.x + d.extent.width, d.offset.y + d.extent.height,
+                          format->blitMask, filter);
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previousRead);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDraw);
+    glDeleteFramebuffers(2, framebuffers);
+
+    return complete && glGetError() == GL_NO_ERROR;
+}
+
+bool GlesGraphicsBackend::MapImage(uint32_t /*image*/, uint32_t /*arrayIndex*/, HostImage* /*hostImage*/) {
+    // Textures live in GPU memory
+    return false;
+}
@@ -0,0 +1,46 @@
+#ifndef GLES_GRAPHICS_BACKEND_H
+#define GLES_GRAPHICS_BACKEND_H
+
+#include "graphics_backend.h"
+#include <mutex>
+#include <unordered_map>
+
+// Swapchain images as GLES textures with immutable storage, fences as GL
+// sync objects. Images are created and blitted on the app's graphics
+// thread (its context current); fences can be waited on from any context
+// in its share group.
+class GlesGraphicsBackend : public GraphicsBackend {
+public:
+    GlesGraphicsBackend();
+
+    const char* GetName() const override;
+    void GetSupportedFormats(std::vector<int64_t>& formats) const override;
+
+    bool CreateTextures(const SwapchainImageDesc& desc, uint32_t count, uint32_t* textures) override;
+    void DestroyTextures(const uint32_t* textures, uint32_t count) override;
+    uint64_t TextureBytes(const SwapchainImageDesc& desc) const override;
+
+    GraphicsFence CreateFence() override;
+    bool WaitFence(GraphicsFence fence, XrDuration timeout) override;
+    void DestroyFence(GraphicsFence fence) override;
+
+    bool BlitImage(const GraphicsImageRegion& source, const GraphicsImageRegion& destination) override;
+    bool MapImage(uint32_t image, uint32_t arrayIndex, HostImage* hostImage) override;
+
+private:
+    // What blits need to attach a texture
+    struct TextureInfo {
+        uint32_t target;
+        int64_t format;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    bool AttachTexture(uint32_t framebuffer, uint32_t framebufferTarget, const TextureInfo& info,
+                       uint32_t texture, uint32_t arrayIndex);
+
+    std::mutex mutex_;
+    std::unordered_map<uint32_t, TextureInfo> textures_;
+};
+
+#endif // GLES_GRAPHICS_BACKEND_H
@@ -0,0 +1,26 @@
+#include "graphics_backend.h"
+#include "compositor.h"
+#include "openxr/swapchain.h"
+
+bool ResolveSwapchainHostImage(void* context, const CompositorView& view, HostImage* image) {
+    GraphicsBackend* backend = static_cast<GraphicsBackend*>(context);
+    if (!backend || !image) {
+        return false;
+    }
+
+    // The pin keeps the swapchain, its image and the fence valid
+    uint32_t swapchainImage;
+    GraphicsFence renderFence;
+    if (!GetSwapchainImage(view.pinned, view.imageIndex, &swapchainImage, &renderFence) ||
+        view.pinned->graphics != backend) {
+        return false;
+    }
+
+    // Don't stall the vsync on a late app; the view is skipped this time
+    if (renderFence != GRAPHICS_NO_FENCE &&
+        !backend->WaitFence(renderFence, GRAPHICS_COMPOSE_FENCE_TIMEOUT)) {
+        return false;
+    }
+
+    return backend->MapImage(swapchainImage, view.imageArrayIndex, image);
+}
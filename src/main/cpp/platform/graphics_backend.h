@@ -0,0 +1,67 @@
+#ifndef GRAPHICS_BACKEND_H
+#define GRAPHICS_BACKEND_H
+
+#include <openxr/openxr.h>
+#include "texture_pool.h"
+#include <cstdint>
+#include <vector>
+
+// RGBA8 image in host memory; stride in bytes
+struct HostImage {
+    uint8_t* pixels;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+};
+
+// Completion of the work submitted before the fence was created
+typedef uint64_t GraphicsFence;
+static const GraphicsFence GRAPHICS_NO_FENCE = 0;
+
+// How long composition waits for the app's rendering to an image before
+// skipping the view
+static const XrDuration GRAPHICS_COMPOSE_FENCE_TIMEOUT = 4000000;  // 4 ms
+
+// One array layer (and rect) of a swapchain image
+struct GraphicsImageRegion {
+    uint32_t image;
+    uint32_t arrayIndex;
+    XrRect2Di rect;
+};
+
+// The graphics API behind swapchain images. Images are allocated through
+// the texture pool interface; fences order the app's rendering before the
+// compositor reads an image. GLES on the device; the host-memory backend
+// runs swapchains and the CPU compositor without a GPU.
+class GraphicsBackend : public TexturePoolBackend {
+public:
+    virtual const char* GetName() const = 0;
+
+    // Swapchain formats, most preferred first
+    virtual void GetSupportedFormats(std::vector<int64_t>& formats) const = 0;
+
+    // Fence after the work the calling thread submitted so far. Waiting
+    // returns false if 'timeout' expired first.
+    virtual GraphicsFence CreateFence() = 0;
+    virtual bool WaitFence(GraphicsFence fence, XrDuration timeout) = 0;
+    virtual void DestroyFence(GraphicsFence fence) = 0;
+
+    // Copy one region to another, scaling and resolving multisample
+    // images as needed
+    virtual bool BlitImage(const GraphicsImageRegion& source, const GraphicsImageRegion& destination) = 0;
+
+    // Host pointer to one layer for sampling on the CPU; false if the
+    // backend's images are not host visible
+    virtual bool MapImage(uint32_t image, uint32_t arrayIndex, HostImage* hostImage) = 0;
+};
+
+struct CompositorView;
+
+// HostImageResolver for the CPU compositor, 'context' being the backend:
+// waits for the app's rendering to the pinned image, then maps it. Goes
+// through the pin rather than the handle, so a frame still shows a
+// swapchain the app destroyed after submitting it. Views of swapchains
+// made with another backend are skipped.
+bool ResolveSwapchainHostImage(void* context, const CompositorView& view, HostImage* image);
+
+#endif // GRAPHICS_BACKEND_H
@@ -0,0 +1,161 @@
+#include "host_graphics_backend.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cstring>
+
+static const uint32_t HOST_TEXEL_BYTES = 4;  // RGBA8
+
+HostGraphicsBackend::HostGraphicsBackend() : nextImage_(1), nextFence_(1) {
+}
+
+HostGraphicsBackend::~HostGraphicsBackend() {
+}
+
+const char* HostGraphicsBackend::GetName() const {
+    return "host";
+}
+
+void HostGraphicsBackend::GetSupportedFormats(std::vector<int64_t>& formats) const {
+    formats.push_back(HOST_FORMAT_RGBA8);
+    formats.push_back(HOST_FORMAT_SRGB8_ALPHA8);
+}
+
+bool HostGraphicsBackend::CreateTextures(const SwapchainImageDesc& desc, uint32_t count, uint32_t* textures) {
+    if (desc.format != HOST_FORMAT_RGBA8 && desc.format != HOST_FORMAT_SRGB8_ALPHA8) {
+        LOGE("Unsupported host swapchain format: 0x%llx", static_cast<unsigned long long>(desc.format));
+        return false;
+    }
+
+    size_t layerBytes = static_cast<size_t>(desc.width) * desc.height * HOST_TEXEL_BYTES;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t i = 0; i < count; ++i) {
+        std::unique_ptr<Image> image(new Image);
+        image->width = desc.width;
+        image->height = desc.height;
+        image->arraySize = desc.arraySize;
+        image->pixels.assign(layerBytes * desc.arraySize, 0);
+
+        textures[i] = nextImage_++;  // 0 stays invalid, like a GL name
+        images_[textures[i]] = std::move(image);
+    }
+    return true;
+}
+
+void HostGraphicsBackend::DestroyTextures(const uint32_t* textures, uint32_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t i = 0; i < count; ++i) {
+        images_.erase(textures[i]);
+    }
+}
+
+uint64_t HostGraphicsBackend::TextureBytes(const SwapchainImageDesc& desc) const {
+    return static_cast<uint64_t>(desc.width) * desc.height * HOST_TEXEL_BYTES * desc.arraySize;
+}
+
+GraphicsFence HostGraphicsBackend::CreateFence() {
+    // Distinct values only to tell fences apart when tracing
+    return nextFence_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool HostGraphicsBackend::WaitFence(GraphicsFence /*fence*/, XrDuration /*timeout*/) {
+    return true;
+}
+
+void HostGraphicsBackend::DestroyFence(GraphicsFence /*fence*/) {
+}
+
+HostGraphicsBackend::Image* HostGraphicsBackend::FindImage(uint32_t image) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = images_.find(image);
+    return it != images_.end() ? it->second.get() : nullptr;
+}
+
+// Clip a region to its image; false if nothing is left
+static bool ClipRect(XrRect2Di* rect, uint32_t width, uint32_t height) {
+    if (rect->offset.x < 0) {
+        rect->extent.width += rect->offset.x;
+        rect->offset.x = 0;
+    }
+    if (rect->offset.y < 0) {
+        rect->extent.height += rect->offset.y;
+        rect->offset.y = 0;
+    }
+    if (rect->offset.x + rect->extent.width > static_cast<int32_t>(width)) {
+        rect->extent.width = static_cast<int32_t>(width) - rect->offset.x;
+    }
+    if (rect->offset.y + rect->extent.height > static_cast<int32_t>(height)) {
+        rect->extent.height = static_cast<int32_t>(height) - rect->offset.y;
+    }
+    return rect->extent.width > 0 && rect->extent.height > 0;
+}
+
+// Nearest texel when the sizes differ, a row copy when they don't.
+// Clipping the destination keeps the scale of the requested rects.
+bool HostGraphicsBackend::BlitImage(const GraphicsImageRegion& source, const GraphicsImageRegion& destination) {
+    HostImage src, dst;
+    if (!MapImage(source.image, source.arrayIndex, &src) ||
+        !MapImage(destination.image, destination.arrayIndex, &dst)) {
+        return false;
+    }
+
+    XrRect2Di s = source.rect;
+    XrRect2Di d = destination.rect;
+    if (!ClipRect(&s, src.width, src.height) || d.extent.width <= 0 || d.extent.height <= 0) {
+        return false;
+    }
+    XrExtent2Di full = d.extent;
+    if (!ClipRect(&d, dst.width, dst.height)) {
+        return false;
+    }
+
+    // Position of the clipped rect within the requested one
+    int32_t skipX = d.offset.x - destination.rect.offset.x;
+    int32_t skipY = d.offset.y - destination.rect.offset.y;
+    bool scaled = s.extent.width != full.width || s.extent.height != full.height;
+    for (int32_t y = 0; y < d.extent.height; ++y) {
+        int32_t sy = scaled ? (skipY + y) * s.extent.height / full.height : skipY + y;
+        if (sy >= s.extent.height) {
+            break;
+        }
+        const uint8_t* srcRow = src.pixels + static_cast<size_t>(s.offset.y + sy) * src.stride +
+                                static_cast<size_t>(s.offset.x) * HOST_TEXEL_BYTES;
+        uint8_t* dstRow = dst.pixels + static_cast<size_t>(d.offset.y + y) * dst.stride +
+                          static_cast<size_t>(d.offset.x) * HOST_TEXEL_BYTES;
+
+        if (!scaled) {
+            int32_t width = std::min(d.extent.width, s.extent.width - skipX);
+            if (width > 0) {
+                memmove(dstRow, srcRow + static_cast<size_t>(skipX) * HOST_TEXEL_BYTES,
+                        static_cast<size_t>(width) * HOST_TEXEL_BYTES);
+            }
+            continue;
+        }
+        for (int32_t x = 0; x < d.extent.width; ++x) {
+            int32_t sx = (skipX + x) * s.extent.width / full.width;
+            memcpy(dstRow + x * HOST_TEXEL_BYTES, srcRow + sx * HOST_TEXEL_BYTES, HOST_TEXEL_BYTES);
+        }
+    }
+    return true;
+}
+
+// The pixels stay put until the image is destroyed; swapchain pinning
+// keeps that from happening while the compositor reads them
+bool HostGraphicsBackend::MapImage(uint32_t image, uint32_t arrayIndex, HostImage* hostImage) {
+    Image* found = FindImage(image);
+    if (!found || arrayIndex >= found->arraySize || !hostImage) {
+        return false;
+    }
+
+    size_t layerBytes = static_cast<size_t>(found->width) * found->height * HOST_TEXEL_BYTES;
+    hostImage->pixels = found->pixels.data() + layerBytes * arrayIndex;
+    hostImage->width = found->width;
+    hostImage->height = found->height;
+    hostImage->stride = found->width * HOST_TEXEL_BYTES;
+    return true;
+}
+
+uint32_t HostGraphicsBackend::GetImageCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<uint32_t>(images_.size());
+}
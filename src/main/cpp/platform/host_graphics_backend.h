@@ -0,0 +1,60 @@
+#ifndef HOST_GRAPHICS_BACKEND_H
+#define HOST_GRAPHICS_BACKEND_H
+
+#include "graphics_backend.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Swapchain image formats of the host backend. The values are the GLES
+// internal formats the app asks for; storage is RGBA8 either way.
+static const int64_t HOST_FORMAT_RGBA8 = 0x8058;         // GL_RGBA8
+static const int64_t HOST_FORMAT_SRGB8_ALPHA8 = 0x8C43;  // GL_SRGB8_ALPHA8
+
+// Swapchain images in host memory, so swapchains, the compositor and frame
+// pacing run on machines without a GPU. Images are RGBA8, first mip level
+// and single sample only; the app writes them through MapImage. CPU writes
+// are done by the time the app releases an image, so fences are always
+// signalled.
+class HostGraphicsBackend : public GraphicsBackend {
+public:
+    HostGraphicsBackend();
+    ~HostGraphicsBackend() override;
+
+    HostGraphicsBackend(const HostGraphicsBackend&) = delete;
+    HostGraphicsBackend& operator=(const HostGraphicsBackend&) = delete;
+
+    const char* GetName() const override;
+    void GetSupportedFormats(std::vector<int64_t>& formats) const override;
+
+    bool CreateTextures(const SwapchainImageDesc& desc, uint32_t count, uint32_t* textures) override;
+    void DestroyTextures(const uint32_t* textures, uint32_t count) override;
+    uint64_t TextureBytes(const SwapchainImageDesc& desc) const override;
+
+    GraphicsFence CreateFence() override;
+    bool WaitFence(GraphicsFence fence, XrDuration timeout) override;
+    void DestroyFence(GraphicsFence fence) override;
+
+    bool BlitImage(const GraphicsImageRegion& source, const GraphicsImageRegion& destination) override;
+    bool MapImage(uint32_t image, uint32_t arrayIndex, HostImage* hostImage) override;
+
+    uint32_t GetImageCount() const;
+
+private:
+    struct Image {
+        uint32_t width;
+        uint32_t height;
+        uint32_t arraySize;
+        std::vector<uint8_t> pixels;  // Layers back to back, never resized
+    };
+
+    Image* FindImage(uint32_t image) const;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint32_t, std::unique_ptr<Image>> images_;
+    uint32_t nextImage_;
+    std::atomic<uint64_t> nextFence_;
+};
+
+#endif // HOST_GRAPHICS_BACKEND_H
@@ -1,63 +1,91 @@
 #include "input_manager.h"
 #include "qualcomm/xr2_platform.h"
 #include "openxr/openxr_api.h"
+#include "openxr/handle_table.h"
+#include "openxr/instance.h"
+#include "openxr/action_state.h"
+#include "openxr/session.h"
 #include "utils/logger.h"
-#include <unordered_map>
 #include <mutex>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <cstring>
-#include <sstream>
+#include <cmath>
+#include <string_view>
 
-struct InteractionProfileBinding {
-    XrPath interactionProfile;
-    std::unordered_map<uintptr_t, XrPath> bindings; // action (as uintptr_t) -> input source (binding path)
-};
+extern HandleTable<XRInstance, XrInstance> g_instances;
 
-// Action to binding path mapping (using uintptr_t as key since XrAction is an opaque handle)
-static std::unordered_map<uintptr_t, XrPath> g_actionToBindingPath;
+// Input samples folded per controller per sync (64 ms at 1 kHz)
+static const uint32_t MAX_FOLDED_SAMPLES = 64;
+static std::mutex g_sampleDrainMutex;  // The sample rings have a single consumer
 
-// Forward declarations
-extern "C" XrResult xrPathToString(XrInstance instance, XrPath path, uint32_t bufferCapacityInput, 
-                                   uint32_t* bufferCountOutput, char* buffer);
-
-// Get current instance (needed for path conversion)
-extern std::mutex g_instanceMutex;
-extern std::unordered_map<XrInstance, std::shared_ptr<struct XRInstance>> g_instances;
-
-XrInstance GetCurrentInstance() {
-    // Try to get any instance from the registry
-    std::lock_guard<std::mutex> lock(g_instanceMutex);
-    if (!g_instances.empty()) {
-        return g_instances.begin()->first;
-    }
-    return XR_NULL_HANDLE;
-}
-
-static std::mutex g_inputMutex;
-static std::vector<InteractionProfileBinding> g_profileBindings;
-static std::unordered_map<XrSession, std::vector<XrActionSet>> g_sessionActionSets;
-static XrInstance g_currentInstance = XR_NULL_HANDLE;
-
-bool RegisterInteractionProfileBindings(XrPath interactionProfile, 
+// Every suggested profile maps onto the same two XR2 controllers, so the
+// bindings are merged regardless of profile
+bool RegisterInteractionProfileBindings(XrInstance instance, XrPath /*interactionProfile*/, 
                                         const XrActionSuggestedBinding* bindings, 
-                                        uint32_t bindingCount) {
-    std::lock_guard<std::mutex> lock(g_inputMutex);
+                                        const XrActionType* actionTypes, uint32_t bindingCount) {
+    XRInstance* xrInstance = g_instances.Lookup(instance);
+    if (!xrInstance) {
+        return false;
+    }
     
-    InteractionProfileBinding profileBinding;
-    profileBinding.interactionProfile = interactionProfile;
+    InputBindingTable& table = *xrInstance->inputBindings;
+    std::lock_guard<std::mutex> lock(table.mutex);
+    if (table.frozen.load(std::memory_order_relaxed)) {
+        return false;  // A session attached while the caller validated
+    }
     
+    uint32_t compiledCount = 0;
     for (uint32_t i = 0; i < bindingCount; ++i) {
-        // Convert XrAction handle to uintptr_t for use as map key
-        uintptr_t actionKey = reinterpret_cast<uintptr_t>(bindings[i].action);
-        profileBinding.bindings[actionKey] = bindings[i].binding;
-        // Store action to binding path mapping
-        g_actionToBindingPath[actionKey] = bindings[i].binding;
+        uint32_t slot = HandleSlotIndex(bindings[i].action);
+        if (slot >= MAX_INPUT_ACTIONS) {
+            continue;
+        }
+        
+        // Parse once here so state queries never touch path strings
+        ParsedInputPath parsed = ParseInputPath(instance, bindings[i].binding);
+        if (!parsed.valid) {
+            LOGW("Unsupported binding path: %llu", static_cast<unsigned long long>(bindings[i].binding));
+            continue;
+        }
+        
+        InputBindingDesc desc = {};
+        if (!CompileXR2InputBinding(parsed, &desc)) {
+            continue;
+        }
+        
+        ActionBindingSlot& entry = table.actions[slot];
+        if (entry.action != bindings[i].action) {
+            entry.action = bindings[i].action;
+            entry.bindingCounts[0] = 0;
+            entry.bindingCounts[1] = 0;
+        }
+        entry.actionType = actionTypes[i];
+        if (!entry.listed) {
+            entry.listed = true;
+            table.boundSlots.push_back(slot);
+        }
+        
+        // Profiles that map to the same input share one binding
+        InputBindingDesc* hand = entry.hands[desc.controllerIndex];
+        uint8_t& handCount = entry.bindingCounts[desc.controllerIndex];
+        bool duplicate = false;
+        for (uint32_t b = 0; b < handCount; ++b) {
+            duplicate = duplicate || memcmp(&hand[b], &desc, sizeof(desc)) == 0;
+        }
+        if (!duplicate) {
+            if (handCount == MAX_HAND_BINDINGS) {
+                LOGW("Too many bindings for one hand, ignoring: %llu",
+                     static_cast<unsigned long long>(bindings[i].binding));
+                continue;
+            }
+            hand[handCount++] = desc;
+        }
+        compiledCount++;
     }
     
-    g_profileBindings.push_back(profileBinding);
-    
-    LOGI("Registered interaction profile bindings: %llu bindings", bindingCount);
+    LOGI("Registered interaction profile bindings: %u/%u bindings", compiledCount, bindingCount);
     return true;
 }
 
@@ -65,53 +93,43 @@ bool RegisterInteractionProfileBindings(XrPath interactionProfile,
 // Example: "/user/hand/left/input/trigger/value" -> controller=0 (left), input="trigger", component="value"
 // Note: ParsedInputPath is already defined in input_manager.h
 
-// Get path string by converting path to string using xrPathToString
-std::string GetPathString(XrInstance instance, XrPath path) {
-    if (instance == XR_NULL_HANDLE || path == XR_NULL_PATH) {
-        return "";
+// Get path string straight from the instance path registry (no copy, no lock)
+std::string_view GetPathString(XrInstance instance, XrPath path) {
+    XRInstance* xrInstance = g_instances.Lookup(instance);
+    if (!xrInstance || path == XR_NULL_PATH) {
+        return std::string_view();
     }
     
-    char buffer[256] = {0};
-    uint32_t bufferCount = 0;
-    
-    XrResult result = xrPathToString(instance, path, sizeof(buffer), &bufferCount, buffer);
-    if (result == XR_SUCCESS && bufferCount > 0 && bufferCount <= sizeof(buffer)) {
-        return std::string(buffer);
-    }
-    
-    return "";
+    return xrInstance->paths.PathToString(path);
 }
 
 // Parse input path - exported for use in xr2_platform
-ParsedInputPath ParseInputPath(XrPath bindingPath) {
+ParsedInputPath ParseInputPath(XrInstance instance, XrPath bindingPath) {
     ParsedInputPath result = {0, "", "", false};
     
     if (bindingPath == XR_NULL_PATH) {
         return result;
     }
     
-    // Get instance for path conversion
-    XrInstance instance = GetCurrentInstance();
-    if (instance == XR_NULL_HANDLE) {
-        return result;
-    }
-    
     // Get path string
-    std::string pathString = GetPathString(instance, bindingPath);
+    std::string_view pathString = GetPathString(instance, bindingPath);
     if (pathString.empty()) {
         return result;
     }
     
     // Parse path: /user/hand/{left|right}/input/{type}/{component}
     // Example: "/user/hand/left/input/trigger/value"
-    std::istringstream iss(pathString);
-    std::string segment;
-    std::vector<std::string> segments;
-    
-    while (std::getline(iss, segment, '/')) {
-        if (!segment.empty()) {
-            segments.push_back(segment);
+    std::vector<std::string_view> segments;
+    size_t start = 0;
+    while (start < pathString.size()) {
+        size_t end = pathString.find('/', start);
+        if (end == std::string_view::npos) {
+            end = pathString.size();
         }
+        if (end > start) {
+            segments.push_back(pathString.substr(start, end - start));
+        }
+        start = end + 1;
     }
     
     if (segments.size() >= 5) {
@@ -132,9 +150,9 @@ ParsedInputPath ParseInputPath(XrPath bindingPath) {
                 return result; // Invalid hand
             }
             
-            result.inputType = segments[4];
+            result.inputType = std::string(segments[4]);
             if (segments.size() > 5) {
-                result.component = segments[5];
+                result.component = std::string(segments[5]);
             } else {
                 result.component = "value"; // Default component
             }
@@ -146,86 +164,190 @@ ParsedInputPath ParseInputPath(XrPath bindingPath) {
     return result;
 }
 
-// Helper function to register path string (called from xrStringToPath)
-void RegisterPathString(XrPath path, const char* pathString) {
-    static std::mutex pathMutex;
-    static std::unordered_map<XrPath, std::string> pathToStringMap;
+// Get controller index from subaction path (0 = left, 1 = right)
+uint32_t GetSubactionControllerIndex(const InputBindingTable& bindings, XrPath subactionPath) {
+    if (subactionPath != XR_NULL_PATH && subactionPath == bindings.handPaths[1]) {
+        return 1; // Right controller
+    }
     
-    std::lock_guard<std::mutex> lock(pathMutex);
-    pathToStringMap[path] = pathString;
+    // Left, none or unknown: default to left (0)
+    return 0;
 }
 
-bool AttachActionSetsToSession(XrSession session, const XrActionSet* actionSets, uint32_t count) {
-    std::lock_guard<std::mutex> lock(g_inputMutex);
+bool AttachActionSetsToSession(XRSession* session, const XrActionSet* actionSets, uint32_t count) {
+    std::lock_guard<std::mutex> sessionLock(session->mutex);
+    if (session->actionSetsAttached.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    
+    session->attachedActionSets.assign(actionSets, actionSets + count);
     
-    std::vector<XrActionSet> sets;
-    for (uint32_t i = 0; i < count; ++i) {
-        sets.push_back(actionSets[i]);
+    // Bindings can no longer change under the lock-free readers
+    {
+        std::lock_guard<std::mutex> lock(session->inputBindings->mutex);
+        session->inputBindings->frozen.store(true, std::memory_order_release);
     }
     
-    g_sessionActionSets[session] = sets;
+    // Published last: readers that see the flag see the sets and bindings
+    session->actionSetsAttached.store(true, std::memory_order_release);
     
     LOGI("Attached %u action sets to session", count);
     return true;
 }
 
-XrPath GetActionBindingPath(XrAction action) {
-    std::lock_guard<std::mutex> lock(g_inputMutex);
-    uintptr_t actionKey = reinterpret_cast<uintptr_t>(action);
-    auto it = g_actionToBindingPath.find(actionKey);
-    if (it != g_actionToBindingPath.end()) {
-        return it->second;
+bool IsActionSetAttached(const XRSession& session, XrActionSet actionSet) {
+    if (!session.actionSetsAttached.load(std::memory_order_acquire)) {
+        return false;
+    }
+    
+    for (XrActionSet attached : session.attachedActionSets) {
+        if (attached == actionSet) {
+            return true;
+        }
     }
-    return XR_NULL_PATH;
+    return false;
 }
 
-bool GetBooleanActionState(XrAction action, XrPath subactionPath, 
-                          bool* currentState, bool* changedSinceLastSync) {
-    if (!currentState || !changedSinceLastSync) {
-        return false;
-    }
+// State of one hand's bindings in one sample: boolean OR, largest
+// magnitude for analog values
+static ActionStateValue EvaluateActionBindings(XrActionType actionType, const InputBindingDesc* bindings,
+                                               uint32_t bindingCount, const XR2ControllerInput& input) {
+    ActionStateValue value = {};
+    value.isActive = input.connected;
     
-    // Get state from XR2 input system
-    return GetXR2BooleanInput(action, subactionPath, currentState, changedSinceLastSync);
+    for (uint32_t i = 0; i < bindingCount; ++i) {
+        switch (actionType) {
+            case XR_ACTION_TYPE_BOOLEAN_INPUT:
+                value.booleanState = value.booleanState || GetXR2BooleanInput(input, bindings[i]);
+                break;
+            case XR_ACTION_TYPE_FLOAT_INPUT: {
+                float state = GetXR2FloatInput(input, bindings[i]);
+                if (std::fabs(state) > std::fabs(value.floatState)) {
+                    value.floatState = state;
+                }
+                break;
+            }
+            case XR_ACTION_TYPE_VECTOR2F_INPUT: {
+                XrVector2f state = GetXR2Vector2fInput(input, bindings[i]);
+                const XrVector2f& best = value.vector2fState;
+                if (state.x * state.x + state.y * state.y > best.x * best.x + best.y * best.y) {
+                    value.vector2fState = state;
+                }
+                break;
+            }
+            default:
+                break; // Pose/haptic actions only report isActive
+        }
+    }
+    return value;
 }
 
-bool GetFloatActionState(XrAction action, XrPath subactionPath, 
-                        float* currentState, bool* changedSinceLastSync) {
-    if (!currentState || !changedSinceLastSync) {
-        return false;
+static bool ActionValueDiffers(XrActionType actionType, const ActionStateValue& a, const ActionStateValue& b) {
+    switch (actionType) {
+        case XR_ACTION_TYPE_BOOLEAN_INPUT:
+            return a.booleanState != b.booleanState;
+        case XR_ACTION_TYPE_FLOAT_INPUT:
+            return a.floatState != b.floatState;
+        case XR_ACTION_TYPE_VECTOR2F_INPUT:
+            return a.vector2fState.x != b.vector2fState.x || a.vector2fState.y != b.vector2fState.y;
+        default:
+            return false;
+    }
+}
+
+// Fold the samples taken since the last sync into one lane. lastChangeTime
+// is the timestamp of the sample where the value changed, and a press that
+// was released again before this sync is latched for one sync so short taps
+// between frames are not lost.
+static ActionStateValue FoldActionSamples(XrActionType actionType, const InputBindingDesc* bindings,
+                                          uint32_t bindingCount, const XR2ControllerInput* samples,
+                                          uint32_t sampleCount, const ActionStateValue& last) {
+    ActionStateValue current = last;
+    bool pressed = false;
+    XrTime pressTime = 0;
+    
+    for (uint32_t i = 0; i < sampleCount; ++i) {
+        ActionStateValue sample = EvaluateActionBindings(actionType, bindings, bindingCount, samples[i]);
+        XrTime timestamp = samples[i].timestamp;
+        
+        if (sample.isActive != current.isActive) {
+            current = sample;
+            current.lastChangeTime = timestamp;
+            continue;
+        }
+        
+        if (sample.isActive && ActionValueDiffers(actionType, sample, current)) {
+            if (actionType == XR_ACTION_TYPE_BOOLEAN_INPUT && sample.booleanState && !pressed) {
+                pressed = true;
+                pressTime = timestamp;
+            }
+            current.booleanState = sample.booleanState;
+            current.floatState = sample.floatState;
+            current.vector2fState = sample.vector2fState;
+            current.lastChangeTime = timestamp;
+        }
     }
     
-    // Get state from XR2 input system
-    return GetXR2FloatInput(action, subactionPath, currentState, changedSinceLastSync);
+    current.changedSinceLastSync = current.isActive && last.isActive &&
+                                   ActionValueDiffers(actionType, current, last);
+    
+    if (pressed && current.isActive && !current.booleanState && !last.booleanState) {
+        current.booleanState = true;
+        current.changedSinceLastSync = last.isActive;
+        current.lastChangeTime = pressTime;
+    }
+    
+    return current;
 }
 
-bool GetVector2fActionState(XrAction action, XrPath subactionPath, 
-                           XrVector2f* currentState, bool* changedSinceLastSync) {
-    if (!currentState || !changedSinceLastSync) {
-        return false;
+// Combine both hands for queries without a subaction path: boolean OR,
+// largest magnitude for analog values
+static void MergeActionState(ActionStateValue* combined, const ActionStateValue& value) {
+    if (!value.isActive) {
+        return;
     }
     
-    // Get state from XR2 input system
-    return GetXR2Vector2fInput(action, subactionPath, currentState, changedSinceLastSync);
+    combined->isActive = true;
+    combined->booleanState = combined->booleanState || value.booleanState;
+    if (std::fabs(value.floatState) > std::fabs(combined->floatState)) {
+        combined->floatState = value.floatState;
+    }
+    const XrVector2f& a = value.vector2fState;
+    const XrVector2f& b = combined->vector2fState;
+    if (a.x * a.x + a.y * a.y > b.x * b.x + b.y * b.y) {
+        combined->vector2fState = a;
+    }
+    if (value.lastChangeTime > combined->lastChangeTime) {
+        combined->lastChangeTime = value.lastChangeTime;
+    }
 }
 
-bool GetPoseActionState(XrAction action, XrPath subactionPath, bool* isActive) {
-    if (!isActive) {
+bool GetActionStateValue(const InputBindingTable& bindings, const ActionStateBuffer& buffer, 
+                         XrAction action, XrPath subactionPath, ActionStateValue* value) {
+    if (!value) {
         return false;
     }
     
-    // Get pose state from XR2 input system
-    return GetXR2PoseInput(action, subactionPath, isActive);
+    uint32_t slot = HandleSlotIndex(action);
+    if (slot >= MAX_INPUT_ACTIONS || bindings.actions[slot].action != action) {
+        // Unbound action: inactive, default state
+        *value = ActionStateValue{};
+        return true;
+    }
+    
+    uint32_t lane = (subactionPath == XR_NULL_PATH) ? ACTION_STATE_LANE_ANY 
+                                                   : GetSubactionControllerIndex(bindings, subactionPath);
+    return ReadActionState(buffer, ActionStateEntry(slot, lane), value);
 }
 
-bool GetActionPose(XrAction action, XrPath subactionPath, XrTime time, 
+bool GetActionPose(uint32_t controllerIndex, XrTime time, 
                   XrPosef* pose, XrSpaceLocationFlags* locationFlags) {
     if (!pose || !locationFlags) {
         return false;
     }
     
     // Get pose from XR2 tracking system
-    return GetXR2ActionPose(action, subactionPath, time, pose, locationFlags);
+    return GetXR2ActionPose(controllerIndex, time, pose, locationFlags);
 }
 
 bool GetCurrentInteractionProfile(XrPath topLevelUserPath, XrPath* interactionProfile) {
@@ -237,9 +359,78 @@ bool GetCurrentInteractionProfile(XrPath topLevelUserPath, XrPath* interactionPr
     return GetXR2CurrentInteractionProfile(topLevelUserPath, interactionProfile);
 }
 
-bool SyncInputActions() {
+bool SyncInputActions(const InputBindingTable& bindings, ActionStateBuffer* buffer) {
+    if (!buffer) {
+        return false;
+    }
+    
     // Sync input from XR2 platform
-    return SyncXR2InputActions();
+    if (!SyncXR2InputActions()) {
+        return false;
+    }
+    
+    XR2ControllerInput latest[2];
+    if (!GetXR2ControllerInputs(latest, 2)) {
+        return false;
+    }
+    
+    // Drain the sample rings, always ending on the current controller state
+    // so an idle sampler or an overflowed ring still syncs correctly
+    XR2ControllerInput samples[2][MAX_FOLDED_SAMPLES + 1];
+    uint32_t sampleCounts[2];
+    {
+        std::lock_guard<std::mutex> drainLock(g_sampleDrainMutex);
+        for (uint32_t c = 0; c < 2; ++c) {
+            uint32_t count = DrainXR2InputSamples(c, samples[c], MAX_FOLDED_SAMPLES);
+            if (count == 0 || latest[c].timestamp > samples[c][count - 1].timestamp) {
+                samples[c][count++] = latest[c];
+            }
+            sampleCounts[c] = count;
+        }
+    }
+    
+    XrTime syncTime = GetCurrentXrTime();
+    
+    std::lock_guard<std::mutex> lock(buffer->writerMutex);
+    const ActionStateSnapshot& previous = buffer->snapshots[buffer->front.load(std::memory_order_relaxed)];
+    ActionStateSnapshot* next = BeginActionStateWrite(buffer);
+    next->syncTime = syncTime;
+    
+    // Bindings are frozen after attach, so the slot list is stable here
+    for (uint32_t slot : bindings.boundSlots) {
+        const ActionBindingSlot& entry = bindings.actions[slot];
+        ActionStateValue combined = {};
+        
+        for (uint32_t hand = 0; hand < 2; ++hand) {
+            if (entry.bindingCounts[hand] == 0) {
+                continue;
+            }
+            
+            uint32_t laneEntry = ActionStateEntry(slot, hand);
+            ActionStateValue last;
+            ReadActionStateUnsynchronized(previous, laneEntry, &last);
+            
+            ActionStateValue value = FoldActionSamples(entry.actionType, entry.hands[hand], 
+                                                       entry.bindingCounts[hand], samples[hand], 
+                                                       sampleCounts[hand], last);
+            StoreActionState(next, laneEntry, value);
+            MergeActionState(&combined, value);
+        }
+        
+        uint32_t anyEntry = ActionStateEntry(slot, ACTION_STATE_LANE_ANY);
+        ActionStateValue lastCombined;
+        ReadActionStateUnsynchronized(previous, anyEntry, &lastCombined);
+        
+        combined.changedSinceLastSync = combined.isActive && lastCombined.isActive &&
+                                        ActionValueDiffers(entry.actionType, combined, lastCombined);
+        if (!combined.changedSinceLastSync && combined.isActive == lastCombined.isActive) {
+            combined.lastChangeTime = lastCombined.lastChangeTime;
+        }
+        StoreActionState(next, anyEntry, combined);
+    }
+    
+    PublishActionState(buffer);
+    return true;
 }
 
 XrTime GetCurrentXrTime() {
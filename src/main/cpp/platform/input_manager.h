@@ -2,20 +2,77 @@
 #define INPUT_MANAGER_H
 
 #include <openxr/openxr.h>
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 // Forward declaration
 typedef struct XrInstance_T* XrInstance;
+struct ActionStateBuffer;
+struct ActionStateValue;
+struct XRSession;
+
+// Upper bound on live actions; bindings are stored per action handle slot
+static const uint32_t MAX_INPUT_ACTIONS = 1024;
+
+// Bindings one action can have on one hand, e.g. trigger and grip
+static const uint32_t MAX_HAND_BINDINGS = 4;
+
+// Component addressed by a binding path (last path segment)
+enum InputComponent : uint8_t {
+    INPUT_COMPONENT_VALUE = 0,
+    INPUT_COMPONENT_CLICK,
+    INPUT_COMPONENT_TOUCH,
+    INPUT_COMPONENT_FORCE,
+    INPUT_COMPONENT_X,
+    INPUT_COMPONENT_Y,
+    INPUT_COMPONENT_POSE,
+};
+
+// Binding compiled once at suggest time and read directly by state queries
+struct InputBindingDesc {
+    uint8_t controllerIndex;  // 0 = left, 1 = right
+    uint8_t analog1DIndex;    // Slot in ControllerState::analog1D
+    uint8_t analog2DIndex;    // Slot in ControllerState::analog2D
+    uint8_t component;        // InputComponent
+    uint32_t buttonBit;       // 0 = no dedicated button
+};
+
+// Compiled bindings of one action, indexed by the action's handle slot.
+// Several bindings on one hand combine: boolean OR, largest magnitude for
+// analog values.
+struct ActionBindingSlot {
+    XrAction action;        // Owner of this slot, guards against slot reuse
+    XrActionType actionType;
+    uint8_t bindingCounts[2];  // Per controller index; 0 = hand not bound
+    bool listed;            // Already in boundSlots
+    InputBindingDesc hands[2][MAX_HAND_BINDINGS];
+};
 
-// Interaction profile bindings
-bool RegisterInteractionProfileBindings(XrPath interactionProfile, 
+// Bindings of one instance, shared with its sessions. Written under mutex
+// while bindings are suggested; read without a lock once a session has
+// attached action sets, after which suggestions are rejected.
+struct InputBindingTable {
+    std::mutex mutex;
+    ActionBindingSlot actions[MAX_INPUT_ACTIONS] = {};
+    std::vector<uint32_t> boundSlots;  // Slots evaluated by each sync
+    std::atomic<bool> frozen{false};   // A session attached action sets
+    XrPath handPaths[2] = {XR_NULL_PATH, XR_NULL_PATH};  // /user/hand/left, /user/hand/right
+};
+
+// Interaction profile bindings, compiled into the instance's binding table
+bool RegisterInteractionProfileBindings(XrInstance instance, XrPath interactionProfile, 
                                         const XrActionSuggestedBinding* bindings, 
-                                        uint32_t bindingCount);
+                                        const XrActionType* actionTypes, uint32_t bindingCount);
 
-bool AttachActionSetsToSession(XrSession session, const XrActionSet* actionSets, uint32_t count);
+// Attach once per session; false if the session already has action sets.
+// Freezes the bindings of the session's instance.
+bool AttachActionSetsToSession(XRSession* session, const XrActionSet* actionSets, uint32_t count);
 
-// Get binding path for an action
-XrPath GetActionBindingPath(XrAction action);
+// Action state is only synced and queried for attached action sets
+bool IsActionSetAttached(const XRSession& session, XrActionSet actionSet);
 
 // Parsed input path structure
 struct ParsedInputPath {
@@ -26,35 +83,29 @@ struct ParsedInputPath {
 };
 
 // Parse input path from binding path
-ParsedInputPath ParseInputPath(XrPath bindingPath);
-
-// Get current instance (for path conversion)
-XrInstance GetCurrentInstance();
-
-// Get path string from path
-std::string GetPathString(XrInstance instance, XrPath path);
-
-// Action state queries
-bool GetBooleanActionState(XrAction action, XrPath subactionPath, 
-                          bool* currentState, bool* changedSinceLastSync);
+ParsedInputPath ParseInputPath(XrInstance instance, XrPath bindingPath);
 
-bool GetFloatActionState(XrAction action, XrPath subactionPath, 
-                        float* currentState, bool* changedSinceLastSync);
+// Controller index for a subaction path such as /user/hand/right (0 = left,
+// 1 = right); compares against the hand paths interned with the instance
+uint32_t GetSubactionControllerIndex(const InputBindingTable& bindings, XrPath subactionPath);
 
-bool GetVector2fActionState(XrAction action, XrPath subactionPath, 
-                           XrVector2f* currentState, bool* changedSinceLastSync);
+// Get path string from path; the view stays valid while the instance lives
+std::string_view GetPathString(XrInstance instance, XrPath path);
 
-bool GetPoseActionState(XrAction action, XrPath subactionPath, bool* isActive);
+// Action state query, served lock-free from the session's last synced snapshot
+bool GetActionStateValue(const InputBindingTable& bindings, const ActionStateBuffer& buffer, 
+                         XrAction action, XrPath subactionPath, ActionStateValue* value);
 
-// Action pose queries
-bool GetActionPose(XrAction action, XrPath subactionPath, XrTime time, 
+// Action pose queries; the controller index is resolved when the action
+// space is created
+bool GetActionPose(uint32_t controllerIndex, XrTime time, 
                   XrPosef* pose, XrSpaceLocationFlags* locationFlags);
 
 // Interaction profile
 bool GetCurrentInteractionProfile(XrPath topLevelUserPath, XrPath* interactionProfile);
 
-// Sync actions
-bool SyncInputActions();
+// Sync actions: sample controllers and publish a new snapshot into buffer
+bool SyncInputActions(const InputBindingTable& bindings, ActionStateBuffer* buffer);
 
 // Current time
 XrTime GetCurrentXrTime();
@@ -0,0 +1,148 @@
+#include "texture_pool.h"
+#include <vector>
+
+TexturePool::TexturePool(TexturePoolBackend* backend, uint64_t budgetBytes)
+    : backend_(backend), budgetBytes_(budgetBytes), bytesHeld_(0), hits_(0), misses_(0),
+      evictions_(0) {
+}
+
+TexturePool::~TexturePool() {
+    Clear();
+}
+
+bool TexturePool::Acquire(TexturePoolBackend* backend, const SwapchainImageDesc& desc, uint32_t count,
+                          uint32_t* textures) {
+    if (!backend || !textures || count == 0) {
+        return false;
+    }
+
+    uint32_t reused = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = idle_.begin(); backend == backend_ && it != idle_.end() && reused < count;) {
+            if (!(it->desc == desc)) {
+                ++it;
+                continue;
+            }
+            textures[reused++] = it->texture;
+            bytesHeld_ -= it->bytes;
+            it = idle_.erase(it);
+        }
+        hits_ += reused;
+        misses_ += count - reused;
+    }
+
+    if (reused == count) {
+        return true;
+    }
+
+    // Create the rest outside the lock
+    if (!backend->CreateTextures(desc, count - reused, textures + reused)) {
+        Release(backend, desc, textures, reused);  // Don't leak what was reused
+        return false;
+    }
+    return true;
+}
+
+void TexturePool::Release(TexturePoolBackend* backend, const SwapchainImageDesc& desc,
+                          const uint32_t* textures, uint32_t count) {
+    if (!backend || !textures || count == 0) {
+        return;
+    }
+
+    std::vector<uint32_t> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (backend == backend_) {
+            uint64_t bytes = backend_->TextureBytes(desc);
+            for (uint32_t i = 0; i < count; ++i) {
+                idle_.push_front({desc, textures[i], bytes});
+                bytesHeld_ += bytes;
+            }
+            EvictToBudget(&evicted);
+            textures = evicted.data();
+            count = static_cast<uint32_t>(evicted.size());
+        }
+    }
+
+    // Evicted, or created before a backend switch so nothing can reuse them
+    if (count > 0) {
+        backend->DestroyTextures(textures, count);
+    }
+}
+
+void TexturePool::SetBudget(uint64_t budgetBytes) {
+    std::vector<uint32_t> evicted;
+    TexturePoolBackend* backend;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budgetBytes_ = budgetBytes;
+        EvictToBudget(&evicted);
+        backend = backend_;
+    }
+    DestroyEvicted(backend, evicted);
+}
+
+void TexturePool::SetBackend(TexturePoolBackend* backend) {
+    std::vector<uint32_t> evicted;
+    TexturePoolBackend* oldBackend;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (backend == backend_) {
+            return;
+        }
+
+        uint64_t budget = budgetBytes_;
+        budgetBytes_ = 0;
+        EvictToBudget(&evicted);
+        budgetBytes_ = budget;
+        oldBackend = backend_;
+        backend_ = backend;
+    }
+    DestroyEvicted(oldBackend, evicted);
+}
+
+void TexturePool::Clear() {
+    std::vector<uint32_t> evicted;
+    TexturePoolBackend* backend;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t budget = budgetBytes_;
+        budgetBytes_ = 0;
+        EvictToBudget(&evicted);
+        budgetBytes_ = budget;
+        backend = backend_;
+    }
+    DestroyEvicted(backend, evicted);
+}
+
+// Called with mutex_ held; the caller destroys 'evicted' after unlocking
+void TexturePool::EvictToBudget(std::vector<uint32_t>* evicted) {
+    while (bytesHeld_ > budgetBytes_ && !idle_.empty()) {
+        const Entry& oldest = idle_.back();
+        evicted->push_back(oldest.texture);
+        bytesHeld_ -= oldest.bytes;
+        idle_.pop_back();
+    }
+    evictions_ += evicted->size();
+}
+
+void TexturePool::DestroyEvicted(TexturePoolBackend* backend, const std::vector<uint32_t>& evicted) {
+    if (!evicted.empty()) {
+        backend->DestroyTextures(evicted.data(), static_cast<uint32_t>(evicted.size()));
+    }
+}
+
+void TexturePool::GetStats(TexturePoolStats* stats) const {
+    if (!stats) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats->hits = hits_;
+    stats->misses = misses_;
+    stats->evictions = evictions_;
+    stats->bytesHeld = bytesHeld_;
+    stats->texturesHeld = static_cast<uint32_t>(idle_.size());
+    stats->budgetBytes = budgetBytes_;
+}
@@ -0,0 +1,102 @@
+#ifndef TEXTURE_POOL_H
+#define TEXTURE_POOL_H
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <vector>
+
+// Storage of one swapchain image; textures are only reused for an
+// identical description
+struct SwapchainImageDesc {
+    uint32_t width;
+    uint32_t height;
+    int64_t format;       // Graphics API format
+    uint32_t sampleCount;
+    uint32_t arraySize;   // Layers
+    uint32_t mipCount;
+};
+
+inline bool operator==(const SwapchainImageDesc& a, const SwapchainImageDesc& b) {
+    return a.width == b.width && a.height == b.height && a.format == b.format &&
+           a.sampleCount == b.sampleCount && a.arraySize == b.arraySize && a.mipCount == b.mipCount;
+}
+
+// Creates and destroys the actual textures; swapped for a mock to test the
+// pool without a GPU
+class TexturePoolBackend {
+public:
+    virtual ~TexturePoolBackend() {}
+
+    virtual bool CreateTextures(const SwapchainImageDesc& desc, uint32_t count, uint32_t* textures) = 0;
+    virtual void DestroyTextures(const uint32_t* textures, uint32_t count) = 0;
+
+    // Memory one texture of 'desc' takes, for the budget
+    virtual uint64_t TextureBytes(const SwapchainImageDesc& desc) const = 0;
+};
+
+struct TexturePoolStats {
+    uint64_t hits;          // Textures handed out from the pool
+    uint64_t misses;        // Textures the backend had to create
+    uint64_t evictions;     // Idle textures destroyed (budget or Clear)
+    uint64_t bytesHeld;     // Idle textures kept for reuse
+    uint32_t texturesHeld;
+    uint64_t budgetBytes;
+};
+
+// Keeps the textures of destroyed swapchains for the next swapchain with
+// the same description (recreate on resume, dynamic resolution steps).
+// Idle textures beyond the memory budget are destroyed least recently
+// released first. Thread-safe; the backend is never called with the pool
+// locked, and only from the thread calling into the pool.
+class TexturePool {
+public:
+    TexturePool(TexturePoolBackend* backend, uint64_t budgetBytes);
+    ~TexturePool();
+
+    TexturePool(const TexturePool&) = delete;
+    TexturePool& operator=(const TexturePool&) = delete;
+
+    // Reuse matching idle textures (most recently released first) and
+    // create the rest with 'backend'; false if it fails. Only the pool's
+    // own backend gets idle textures.
+    bool Acquire(TexturePoolBackend* backend, const SwapchainImageDesc& desc, uint32_t count,
+                 uint32_t* textures);
+
+    // Return textures 'backend' created for reuse, evicting to stay within
+    // the budget. Textures of any backend but the pool's are destroyed.
+    void Release(TexturePoolBackend* backend, const SwapchainImageDesc& desc, const uint32_t* textures,
+                 uint32_t count);
+
+    void SetBudget(uint64_t budgetBytes);
+
+    // Destroy the idle textures with the current backend and pool those of
+    // 'backend' from now on
+    void SetBackend(TexturePoolBackend* backend);
+
+    // Destroy every idle texture (graphics context going away)
+    void Clear();
+
+    void GetStats(TexturePoolStats* stats) const;
+
+private:
+    struct Entry {
+        SwapchainImageDesc desc;
+        uint32_t texture;
+        uint64_t bytes;
+    };
+
+    void EvictToBudget(std::vector<uint32_t>* evicted);
+    static void DestroyEvicted(TexturePoolBackend* backend, const std::vector<uint32_t>& evicted);
+
+    TexturePoolBackend* backend_;
+    mutable std::mutex mutex_;
+    std::list<Entry> idle_;  // Front = most recently released
+    uint64_t budgetBytes_;
+    uint64_t bytesHeld_;
+    uint64_t hits_;
+    uint64_t misses_;
+    uint64_t evictions_;
+};
+
+#endif // TEXTURE_POOL_H
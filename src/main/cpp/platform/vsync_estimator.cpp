@@ -0,0 +1,128 @@
+#include "vsync_estimator.h"
+#include <cmath>
+
+// Fitted periods further than this from the nominal one are rejected
+static const double MAX_PERIOD_DEVIATION = 0.1;
+
+VsyncEstimator::VsyncEstimator(XrDuration nominalPeriod)
+    : nominalPeriod_(nominalPeriod), sampleCount_(0), nextSample_(0), newest_(0),
+      phase_(0), period_(nominalPeriod) {
+}
+
+void VsyncEstimator::SetNominalPeriod(XrDuration nominalPeriod) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (nominalPeriod <= 0 || nominalPeriod == nominalPeriod_) {
+        return;
+    }
+
+    // Refresh rate changed; the old samples describe a different display mode
+    nominalPeriod_ = nominalPeriod;
+    period_ = nominalPeriod;
+    sampleCount_ = 0;
+    nextSample_ = 0;
+}
+
+void VsyncEstimator::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampleCount_ = 0;
+    nextSample_ = 0;
+    newest_ = 0;
+    period_ = nominalPeriod_;
+}
+
+void VsyncEstimator::AddVsync(XrTime vsyncTime) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (sampleCount_ > 0 && vsyncTime <= newest_) {
+        return;
+    }
+
+    // A vsync far off the predicted grid means the display re-synced
+    // (mode switch, resume); start over instead of fitting across it
+    if (sampleCount_ > 0) {
+        XrDuration sinceNewest = vsyncTime - phase_;
+        double cycles = static_cast<double>(sinceNewest) / static_cast<double>(period_);
+        double error = std::fabs(cycles - std::round(cycles));
+        if (error > 0.25) {
+            sampleCount_ = 0;
+            nextSample_ = 0;
+            period_ = nominalPeriod_;
+        }
+    }
+
+    samples_[nextSample_] = vsyncTime;
+    nextSample_ = (nextSample_ + 1) % VSYNC_HISTORY_SIZE;
+    if (sampleCount_ < VSYNC_HISTORY_SIZE) {
+        sampleCount_++;
+    }
+    newest_ = vsyncTime;
+
+    Fit();
+}
+
+void VsyncEstimator::Fit() {
+    phase_ = newest_;
+    if (sampleCount_ < 2) {
+        return;
+    }
+
+    // Oldest sample is the origin; work in doubles relative to it
+    uint32_t oldestSlot = (nextSample_ + VSYNC_HISTORY_SIZE - sampleCount_) % VSYNC_HISTORY_SIZE;
+    XrTime origin = samples_[oldestSlot];
+    double indexPeriod = static_cast<double>(period_);
+
+    double sumK = 0.0, sumT = 0.0, sumKK = 0.0, sumKT = 0.0;
+    double lastK = 0.0;
+    for (uint32_t i = 0; i < sampleCount_; ++i) {
+        double t = static_cast<double>(samples_[(oldestSlot + i) % VSYNC_HISTORY_SIZE] - origin);
+        double k = std::round(t / indexPeriod);
+        sumK += k;
+        sumT += t;
+        sumKK += k * k;
+        sumKT += k * t;
+        lastK = k;
+    }
+
+    double n = static_cast<double>(sampleCount_);
+    double denominator = n * sumKK - sumK * sumK;
+    if (denominator <= 0.0) {
+        return;
+    }
+
+    double slope = (n * sumKT - sumK * sumT) / denominator;
+    double intercept = (sumT - slope * sumK) / n;
+
+    double nominal = static_cast<double>(nominalPeriod_);
+    if (std::fabs(slope - nominal) > nominal * MAX_PERIOD_DEVIATION) {
+        return;  // Keep the previous estimate
+    }
+
+    period_ = static_cast<XrDuration>(std::llround(slope));
+    phase_ = origin + static_cast<XrTime>(std::llround(intercept + slope * lastK));
+}
+
+bool VsyncEstimator::GetModel(XrTime* phase, XrDuration* period) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (sampleCount_ == 0 || !phase || !period) {
+        return false;
+    }
+
+    *phase = phase_;
+    *period = period_;
+    return true;
+}
+
+XrTime NextVsyncAtOrAfter(XrTime phase, XrDuration period, XrTime time) {
+    if (period <= 0) {
+        return time;
+    }
+
+    XrDuration delta = time - phase;
+    int64_t cycles = delta / period;
+    if (delta > 0 && delta % period != 0) {
+        cycles++;
+    }
+    return phase + cycles * period;
+}
@@ -0,0 +1,47 @@
+#ifndef VSYNC_ESTIMATOR_H
+#define VSYNC_ESTIMATOR_H
+
+#include <openxr/openxr.h>
+#include <cstdint>
+#include <mutex>
+
+// Vsync timestamps kept for the fit (~350 ms at 90 Hz)
+static const uint32_t VSYNC_HISTORY_SIZE = 32;
+
+// Estimates the display's true refresh period and phase from observed vsync
+// timestamps with a least-squares fit of t = phase + k * period. Missed
+// vsyncs are fine: each sample is assigned its vsync index before fitting.
+class VsyncEstimator {
+public:
+    explicit VsyncEstimator(XrDuration nominalPeriod);
+
+    // Period reported by the display; used to index samples and as the
+    // fallback estimate. Resets the history if it changes.
+    void SetNominalPeriod(XrDuration nominalPeriod);
+
+    // Duplicates and timestamps older than the newest sample are ignored
+    void AddVsync(XrTime vsyncTime);
+
+    // Fitted time of the newest vsync and the refresh period. False until at
+    // least one vsync has been observed.
+    bool GetModel(XrTime* phase, XrDuration* period) const;
+
+    void Reset();
+
+private:
+    void Fit();
+
+    mutable std::mutex mutex_;
+    XrDuration nominalPeriod_;
+    XrTime samples_[VSYNC_HISTORY_SIZE];
+    uint32_t sampleCount_;
+    uint32_t nextSample_;
+    XrTime newest_;
+    XrTime phase_;
+    XrDuration period_;
+};
+
+// First vsync of the model (phase + k * period) at or after 'time'
+XrTime NextVsyncAtOrAfter(XrTime phase, XrDuration period, XrTime time);
+
+#endif // VSYNC_ESTIMATOR_H
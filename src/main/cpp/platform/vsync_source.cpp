@@ -0,0 +1,154 @@
+#include "vsync_source.h"
+#include "frame_sync.h"
+#include "frame_pacer.h"
+#include "frame_telemetry.h"
+#include "qualcomm/xr2_platform.h"
+#include "utils/logger.h"
+#include "utils/seqlock.h"
+#include "utils/xr_time.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// Period for the simulated source when the display reports none
+static const XrDuration SIMULATED_VSYNC_PERIOD_NS = 1000000000LL / 90;
+
+// Poll this long after the predicted vsync so the new timestamp is visible
+static const XrDuration VSYNC_POLL_LATENCY_NS = 500000;  // 0.5 ms
+
+// Newest vsync, published by a single writer and read without locks. Its
+// seqlock sequence counts the vsyncs published.
+static SeqLocked<XrTime> g_vsyncTime;
+
+static std::mutex g_vsyncSourceMutex;  // Start/stop only
+static std::atomic<int> g_vsyncSourceMode(VSYNC_SOURCE_NONE);
+static std::atomic<bool> g_vsyncThreadRunning(false);
+static std::thread g_vsyncThread;
+
+void PublishVsync(XrTime vsyncTime) {
+    g_vsyncTime.Store(vsyncTime);
+
+    RecordDisplayVsync(vsyncTime);
+    NotifyFramePacersVsync(vsyncTime);
+}
+
+uint64_t GetLatestVsync(XrTime* vsyncTime) {
+    XrTime time;
+    uint64_t sequence = g_vsyncTime.Load(&time);
+    if (vsyncTime) {
+        *vsyncTime = time;
+    }
+    return sequence / 2;
+}
+
+// Poll the display's last interrupt timestamp shortly after each expected
+// vsync and publish it when it changes
+static void VsyncPollingThreadMain() {
+    XrTime lastPublished = 0;
+
+    while (g_vsyncThreadRunning.load(std::memory_order_acquire)) {
+        XrTime vsyncTime = 0;
+        XrDuration period = SIMULATED_VSYNC_PERIOD_NS;
+        XrTime nextPoll = GetXR2CurrentTime() + period / 4;
+
+        if (GetDisplayVsyncTiming(&vsyncTime, &period) && period > 0) {
+            if (vsyncTime > lastPublished) {
+                PublishVsync(vsyncTime);
+                lastPublished = vsyncTime;
+            }
+            XrTime now = GetXR2CurrentTime();
+            nextPoll = vsyncTime + period + VSYNC_POLL_LATENCY_NS;
+            while (nextPoll <= now) {
+                nextPoll += period;
+            }
+        }
+
+        std::this_thread::sleep_until(XrTimeToSteadyClock(nextPoll));
+    }
+}
+
+// Free-running vsync at a fixed period, for hosts without a display
+static void VsyncSimulatedThreadMain() {
+    XrTime nextVsync = GetXR2CurrentTime() + SIMULATED_VSYNC_PERIOD_NS;
+
+    while (g_vsyncThreadRunning.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_until(XrTimeToSteadyClock(nextVsync));
+        PublishVsync(nextVsync);
+
+        nextVsync += SIMULATED_VSYNC_PERIOD_NS;
+        XrTime now = GetXR2CurrentTime();
+        while (nextVsync <= now) {
+            nextVsync += SIMULATED_VSYNC_PERIOD_NS;  // Skip missed ticks
+        }
+    }
+}
+
+VsyncSourceMode StartVsyncSource(VsyncSourceMode preferred) {
+    std::lock_guard<std::mutex> lock(g_vsyncSourceMutex);
+
+    VsyncSourceMode current = static_cast<VsyncSourceMode>(g_vsyncSourceMode.load());
+    if (current != VSYNC_SOURCE_NONE) {
+        return current;
+    }
+
+    VsyncSourceMode mode = VSYNC_SOURCE_NONE;
+
+    if (preferred <= VSYNC_SOURCE_CALLBACK && SetDisplayVsyncCallback(true)) {
+        mode = VSYNC_SOURCE_CALLBACK;
+    }
+
+    if (mode == VSYNC_SOURCE_NONE && preferred <= VSYNC_SOURCE_POLLING) {
+        XrTime vsyncTime;
+        XrDuration period;
+        if (GetDisplayVsyncTiming(&vsyncTime, &period)) {
+            mode = VSYNC_SOURCE_POLLING;
+        }
+    }
+
+    // A simulated vsync is not tied to the panel, so frames would tear or
+    // judder; only fall back to it on hosts or when asked for it
+#ifdef __ANDROID__
+    bool allowSimulated = preferred == VSYNC_SOURCE_SIMULATED;
+#else
+    bool allowSimulated = true;
+#endif
+    if (mode == VSYNC_SOURCE_NONE && allowSimulated) {
+        mode = VSYNC_SOURCE_SIMULATED;
+    }
+
+    if (mode == VSYNC_SOURCE_NONE) {
+        LOGE("No display vsync source available");
+        return VSYNC_SOURCE_NONE;
+    }
+
+    if (mode != VSYNC_SOURCE_CALLBACK) {
+        g_vsyncThreadRunning.store(true, std::memory_order_release);
+        g_vsyncThread = std::thread(mode == VSYNC_SOURCE_POLLING ? VsyncPollingThreadMain 
+                                                                 : VsyncSimulatedThreadMain);
+    }
+
+    static const char* const modeNames[] = {"none", "callback", "polling", "simulated"};
+    LOGI("Vsync source: %s", modeNames[mode]);
+
+    g_vsyncSourceMode.store(mode, std::memory_order_release);
+    return mode;
+}
+
+void StopVsyncSource() {
+    std::lock_guard<std::mutex> lock(g_vsyncSourceMutex);
+
+    VsyncSourceMode mode = static_cast<VsyncSourceMode>(g_vsyncSourceMode.exchange(VSYNC_SOURCE_NONE));
+    if (mode == VSYNC_SOURCE_CALLBACK) {
+        SetDisplayVsyncCallback(false);
+    }
+
+    g_vsyncThreadRunning.store(false, std::memory_order_release);
+    if (g_vsyncThread.joinable()) {
+        g_vsyncThread.join();
+    }
+}
+
+VsyncSourceMode GetVsyncSourceMode() {
+    return static_cast<VsyncSourceMode>(g_vsyncSourceMode.load(std::memory_order_acquire));
+}
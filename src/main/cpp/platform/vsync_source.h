@@ -0,0 +1,31 @@
+#ifndef VSYNC_SOURCE_H
+#define VSYNC_SOURCE_H
+
+#include <openxr/openxr.h>
+#include <cstdint>
+
+// Where vsync events come from, best first
+enum VsyncSourceMode {
+    VSYNC_SOURCE_NONE = 0,
+    VSYNC_SOURCE_CALLBACK,   // QVR display interrupt callback
+    VSYNC_SOURCE_POLLING,    // Thread polling the last interrupt timestamp
+    VSYNC_SOURCE_SIMULATED,  // Generated from the system clock (host testing)
+};
+
+// Start the first source that works, beginning at 'preferred' and falling
+// back down the list. The simulated source is a fallback on host builds
+// only; on devices it must be asked for. Returns the mode in use, NONE if
+// nothing could be started.
+VsyncSourceMode StartVsyncSource(VsyncSourceMode preferred);
+void StopVsyncSource();
+VsyncSourceMode GetVsyncSourceMode();
+
+// Publish one vsync timestamp. Called by the active source only (callback
+// or source thread); wakes the frame pacers.
+void PublishVsync(XrTime vsyncTime);
+
+// Lock-free read of the newest vsync. Returns its sequence number, 0 if no
+// vsync has been published yet.
+uint64_t GetLatestVsync(XrTime* vsyncTime);
+
+#endif // VSYNC_SOURCE_H
@@ -0,0 +1,170 @@
+#include "perf_governor.h"
+#include "xr2_platform.h"
+#include "platform/frame_telemetry.h"
+#include "utils/logger.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Frames needed in the telemetry window before the governor acts
+static const uint32_t PERF_GOVERNOR_MIN_FRAMES = 30;
+
+static std::mutex g_governorMutex;
+static std::condition_variable g_governorCondition;
+static std::thread g_governorThread;
+static bool g_governorRunning = false;
+
+PerfGovernorConfig GetDefaultPerfGovernorConfig(uint32_t maxLevel) {
+    PerfGovernorConfig config;
+    config.maxLevel = maxLevel;
+    config.raiseHeadroom = 0.10f;
+    config.lowerHeadroom = 0.25f;
+    config.levelSpeedup = 1.25f;
+    config.lowerAfterSamples = 10;  // 5 s
+    config.cooldownSamples = 6;     // 3 s, longer than the telemetry window
+    return config;
+}
+
+static float Headroom(XrDuration time, XrDuration period) {
+    return 1.0f - static_cast<float>(time) / static_cast<float>(period);
+}
+
+// Level for one unit; 'forceRaise' is set when a drop was blamed on it
+static uint32_t DecideUnitLevel(const PerfGovernorConfig& config, uint32_t level, XrDuration time,
+                                XrDuration period, bool forceRaise, uint32_t* calmSamples) {
+    float headroom = Headroom(time, period);
+
+    if (forceRaise || headroom < config.raiseHeadroom) {
+        *calmSamples = 0;
+        return level < config.maxLevel ? level + 1 : level;
+    }
+
+    XrDuration slowerTime = static_cast<XrDuration>(time * config.levelSpeedup);
+    if (level > 0 && Headroom(slowerTime, period) > config.lowerHeadroom) {
+        if (++*calmSamples >= config.lowerAfterSamples) {
+            *calmSamples = 0;
+            return level - 1;
+        }
+        return level;
+    }
+
+    *calmSamples = 0;
+    return level;
+}
+
+bool UpdatePerfGovernor(const PerfGovernorConfig& config, const PerfGovernorSample& sample,
+                        PerfGovernorState* state) {
+    if (!state || sample.displayPeriod <= 0) {
+        return false;
+    }
+
+    // Let the telemetry window fill with frames from the new levels
+    if (state->cooldown > 0) {
+        state->cooldown--;
+        return false;
+    }
+
+    bool dropped = sample.newDrops > 0;
+    uint32_t cpuLevel, gpuLevel;
+
+    if (sample.gpuTime < 0) {
+        // Drops can't be blamed on either unit, so both move together
+        cpuLevel = DecideUnitLevel(config, state->cpuLevel, sample.cpuTime, sample.displayPeriod,
+                                   dropped, &state->cpuCalmSamples);
+        gpuLevel = cpuLevel;
+        state->gpuCalmSamples = state->cpuCalmSamples;
+    } else {
+        // Blame drops on the unit with less headroom
+        bool cpuBound = sample.cpuTime >= sample.gpuTime;
+
+        cpuLevel = DecideUnitLevel(config, state->cpuLevel, sample.cpuTime, sample.displayPeriod,
+                                   dropped && cpuBound, &state->cpuCalmSamples);
+        gpuLevel = DecideUnitLevel(config, state->gpuLevel, sample.gpuTime, sample.displayPeriod,
+                                   dropped && !cpuBound, &state->gpuCalmSamples);
+    }
+
+    if (cpuLevel == state->cpuLevel && gpuLevel == state->gpuLevel) {
+        return false;
+    }
+
+    state->cpuLevel = cpuLevel;
+    state->gpuLevel = gpuLevel;
+    state->cooldown = config.cooldownSamples;
+    return true;
+}
+
+static void PerfGovernorThreadMain() {
+    PerfGovernorConfig config = GetDefaultPerfGovernorConfig(XR2_MAX_PERF_LEVEL);
+    PerfGovernorState state = {};
+    uint64_t lastDrops = 0;
+    uint64_t lastLoggedFrame = 0;
+
+    std::unique_lock<std::mutex> lock(g_governorMutex);
+    while (g_governorRunning) {
+        g_governorCondition.wait_for(lock, std::chrono::nanoseconds(PERF_GOVERNOR_INTERVAL_NS));
+        if (!g_governorRunning) {
+            break;
+        }
+        lock.unlock();
+
+        FrameTimingStats stats;
+        GetFrameTimingStats(&stats);
+
+        FrameTimingRecord newest;
+        bool haveFrames = GetRecentFrameTimings(&newest, 1) == 1;
+        uint64_t drops = 0;
+        for (uint32_t i = 0; i < FRAME_DROP_CAUSE_COUNT; ++i) {
+            drops += stats.drops[i];
+        }
+
+        // Periodic stats log, kept off the frame thread
+        if (haveFrames && newest.frameId >= lastLoggedFrame + FRAME_TELEMETRY_LOG_INTERVAL) {
+            LogFrameTimingStats(stats);
+            lastLoggedFrame = newest.frameId;
+        }
+
+        if (stats.appCpu.count >= PERF_GOVERNOR_MIN_FRAMES && haveFrames) {
+            PerfGovernorSample sample;
+            sample.displayPeriod = newest.predictedDisplayPeriod;
+            sample.cpuTime = stats.appCpu.p90;
+            // Compositor pickup to vsync is mostly waiting, not the app's
+            // GPU work; that needs render fence signal times
+            sample.gpuTime = PERF_GOVERNOR_GPU_TIME_UNKNOWN;
+            sample.newDrops = static_cast<uint32_t>(drops >= lastDrops ? drops - lastDrops : drops);
+
+            if (UpdatePerfGovernor(config, sample, &state)) {
+                LOGI("Performance levels: CPU=%u GPU=%u (CPU p90=%.2f ms)",
+                     state.cpuLevel, state.gpuLevel, sample.cpuTime / 1e6);
+                SetXR2OperatingLevels(state.cpuLevel, state.gpuLevel);
+            }
+        }
+        lastDrops = drops;
+
+        lock.lock();
+    }
+}
+
+bool StartPerfGovernor() {
+    std::lock_guard<std::mutex> lock(g_governorMutex);
+
+    if (g_governorRunning) {
+        return true;
+    }
+
+    g_governorRunning = true;
+    g_governorThread = std::thread(PerfGovernorThreadMain);
+    return true;
+}
+
+void StopPerfGovernor() {
+    {
+        std::lock_guard<std::mutex> lock(g_governorMutex);
+        g_governorRunning = false;
+    }
+    g_governorCondition.notify_all();
+
+    if (g_governorThread.joinable()) {
+        g_governorThread.join();
+    }
+}
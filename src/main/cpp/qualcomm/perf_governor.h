@@ -0,0 +1,56 @@
+#ifndef PERF_GOVERNOR_H
+#define PERF_GOVERNOR_H
+
+#include <openxr/openxr.h>
+#include <cstdint>
+
+// How often the governor thread re-evaluates the levels
+static const XrDuration PERF_GOVERNOR_INTERVAL_NS = 500000000;  // 500 ms
+
+// Thresholds are fractions of the display period left unused (headroom).
+// A unit is raised as soon as its headroom drops below raiseHeadroom, and
+// lowered only if its time scaled by levelSpeedup (the cost of one level
+// down) would still leave lowerHeadroom, sustained for lowerAfterSamples
+// evaluations. The gap between the two keeps the levels from oscillating.
+struct PerfGovernorConfig {
+    uint32_t maxLevel;
+    float raiseHeadroom;
+    float lowerHeadroom;
+    float levelSpeedup;
+    uint32_t lowerAfterSamples;
+    uint32_t cooldownSamples;  // Evaluations skipped after a change
+};
+
+// gpuTime when nothing measures the app's GPU work
+static const XrDuration PERF_GOVERNOR_GPU_TIME_UNKNOWN = -1;
+
+// One evaluation's input, from the frame telemetry ring
+struct PerfGovernorSample {
+    XrDuration displayPeriod;
+    XrDuration cpuTime;     // App CPU time (p90)
+    XrDuration gpuTime;     // App GPU time (p90), or PERF_GOVERNOR_GPU_TIME_UNKNOWN
+    uint32_t newDrops;      // Frames dropped since the previous evaluation
+};
+
+struct PerfGovernorState {
+    uint32_t cpuLevel;
+    uint32_t gpuLevel;
+    uint32_t cpuCalmSamples;  // Consecutive evaluations with room to lower
+    uint32_t gpuCalmSamples;
+    uint32_t cooldown;
+};
+
+PerfGovernorConfig GetDefaultPerfGovernorConfig(uint32_t maxLevel);
+
+// Pure decision step; no clocks or platform calls, so a recorded sample
+// sequence replays deterministically. Without a GPU time the GPU level
+// follows the CPU level. Returns true if a level changed.
+bool UpdatePerfGovernor(const PerfGovernorConfig& config, const PerfGovernorSample& sample,
+                        PerfGovernorState* state);
+
+// Governor thread: reads the frame telemetry every PERF_GOVERNOR_INTERVAL_NS
+// and applies level changes itself, off the frame thread
+bool StartPerfGovernor();
+void StopPerfGovernor();
+
+#endif // PERF_GOVERNOR_H
@@ -0,0 +1,128 @@
+#include "pose_history.h"
+#include "utils/pose_math.h"
+
+static_assert((POSE_HISTORY_CAPACITY & (POSE_HISTORY_CAPACITY - 1)) == 0,
+              "POSE_HISTORY_CAPACITY must be a power of two");
+
+// Tracking flags come from whichever sample is closer in time
+static void InterpolateSamples(const HeadPoseSample& a, const HeadPoseSample& b, XrTime time,
+                               HeadPoseSample* result) {
+    float t = static_cast<float>(time - a.time) / static_cast<float>(b.time - a.time);
+    *result = (t < 0.5f) ? a : b;
+    result->time = time;
+    result->pose = PoseInterpolate(a.pose, b.pose, t);
+}
+
+PoseHistory::PoseHistory() : count_(0), lastTime_(0) {}
+
+void PoseHistory::Push(const HeadPoseSample& sample) {
+    uint64_t index = count_.load(std::memory_order_relaxed);
+    if (index > 0 && sample.time <= lastTime_) {
+        return;  // Tracker returned the same sample again
+    }
+
+    Slot slot;
+    slot.index = index;
+    slot.sample = sample;
+    slots_[index & (POSE_HISTORY_CAPACITY - 1)].Store(slot);
+
+    count_.store(index + 1, std::memory_order_release);
+    lastTime_ = sample.time;
+}
+
+void PoseHistory::Clear() {
+    count_.store(0, std::memory_order_release);
+    lastTime_ = 0;
+}
+
+// Returns false if the slot no longer holds push 'index'
+bool PoseHistory::ReadSlot(uint64_t index, HeadPoseSample* sample) const {
+    Slot slot;
+    slots_[index & (POSE_HISTORY_CAPACITY - 1)].Load(&slot);
+    *sample = slot.sample;
+    return slot.index == index;
+}
+
+bool PoseHistory::Latest(HeadPoseSample* sample) const {
+    if (!sample) {
+        return false;
+    }
+
+    for (;;) {
+        uint64_t count = count_.load(std::memory_order_acquire);
+        if (count == 0) {
+            return false;
+        }
+        if (ReadSlot(count - 1, sample)) {
+            return true;
+        }
+    }
+}
+
+bool PoseHistory::Sample(XrTime time, HeadPoseSample* sample) const {
+    if (!sample) {
+        return false;
+    }
+
+    // Restart whenever the producer laps a slot we need
+    for (;;) {
+        uint64_t count = count_.load(std::memory_order_acquire);
+        if (count == 0) {
+            return false;
+        }
+
+        uint64_t newestIndex = count - 1;
+        HeadPoseSample newest;
+        if (!ReadSlot(newestIndex, &newest)) {
+            continue;
+        }
+
+        if (time >= newest.time) {
+            *sample = newest;  // Prediction is left to the caller
+            return true;
+        }
+
+        // The slot after the newest is the next one to be overwritten
+        uint64_t oldestIndex = (count >= POSE_HISTORY_CAPACITY) ? count - POSE_HISTORY_CAPACITY + 1 : 0;
+        HeadPoseSample oldest;
+        if (!ReadSlot(oldestIndex, &oldest)) {
+            continue;
+        }
+
+        if (time <= oldest.time) {
+            *sample = oldest;
+            return true;
+        }
+
+        // Binary search for lo.time < time <= hi.time
+        uint64_t lo = oldestIndex;
+        uint64_t hi = newestIndex;
+        HeadPoseSample loSample = oldest;
+        HeadPoseSample hiSample = newest;
+        bool lapped = false;
+
+        while (hi - lo > 1) {
+            uint64_t mid = lo + (hi - lo) / 2;
+            HeadPoseSample midSample;
+            if (!ReadSlot(mid, &midSample)) {
+                lapped = true;
+                break;
+            }
+
+            if (midSample.time < time) {
+                lo = mid;
+                loSample = midSample;
+            } else {
+                hi = mid;
+                hiSample = midSample;
+            }
+        }
+
+        if (lapped) {
+            continue;
+        }
+
+        InterpolateSamples(loSample, hiSample, time, sample);
+        return true;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef POSE_HISTORY_H
+#define POSE_HISTORY_H
+
+#include <openxr/openxr.h>
+#include "utils/seqlock.h"
+#include <atomic>
+#include <cstdint>
+
+// One head tracking sample, timestamped in XrTime
+struct HeadPoseSample {
+    XrTime time;
+    XrPosef pose;
+    uint16_t trackingState;   // QVR tracking_state bits
+    uint16_t warningFlags;    // QVR tracking_warning_flags bits
+    float quality;
+};
+
+static const uint32_t POSE_HISTORY_CAPACITY = 512;  // ~1 s at 500 Hz
+
+// Fixed-capacity ring of head poses in increasing time order.
+// One producer (the tracking thread) pushes; any number of threads sample
+// it without locking. Each slot is a seqlock, and readers restart if the
+// producer overwrites a slot they are looking at.
+class PoseHistory {
+public:
+    PoseHistory();
+
+    PoseHistory(const PoseHistory&) = delete;
+    PoseHistory& operator=(const PoseHistory&) = delete;
+
+    // Producer only. Samples not newer than the last one are ignored.
+    void Push(const HeadPoseSample& sample);
+
+    // Only from the producer thread, or while no producer is running
+    void Clear();
+
+    bool Latest(HeadPoseSample* sample) const;
+
+    // Pose at an arbitrary time, interpolated between the two surrounding
+    // samples. Outside the window the oldest or newest sample is returned
+    // unchanged, with its own timestamp; see PredictHeadPose for the future.
+    bool Sample(XrTime time, HeadPoseSample* sample) const;
+
+    uint64_t Count() const { return count_.load(std::memory_order_acquire); }
+
+private:
+    struct Slot {
+        uint64_t index;  // Which push this slot holds
+        HeadPoseSample sample;
+    };
+
+    bool ReadSlot(uint64_t index, HeadPoseSample* sample) const;
+
+    SeqLocked<Slot> slots_[POSE_HISTORY_CAPACITY];
+    std::atomic<uint64_t> count_;
+    XrTime lastTime_;  // Producer only
+};
+
+#endif // POSE_HISTORY_H
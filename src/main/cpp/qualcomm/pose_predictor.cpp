@@ -0,0 +1,116 @@
+#include "pose_predictor.h"
+#include "utils/pose_math.h"
+
+static inline XrVector3f Scale(const XrVector3f& v, float s) {
+    return {v.x * s, v.y * s, v.z * s};
+}
+
+static inline XrVector3f Add(const XrVector3f& a, const XrVector3f& b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+static inline XrVector3f Sub(const XrVector3f& a, const XrVector3f& b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+// Average linear and angular velocity between two samples
+static void VelocityBetween(const HeadPoseSample& a, const HeadPoseSample& b, float dt,
+                            XrVector3f* linear, XrVector3f* angular) {
+    *linear = Scale(Sub(b.pose.position, a.pose.position), 1.0f / dt);
+
+    // World-space delta: b = delta * a
+    XrQuaternionf delta = QuatMultiply(b.pose.orientation, QuatConjugate(a.pose.orientation));
+    *angular = Scale(QuatToRotationVector(delta), 1.0f / dt);
+}
+
+bool EstimatePoseMotion(const HeadPoseSample& s0, const HeadPoseSample& s1, const HeadPoseSample& s2,
+                        PoseMotion* motion) {
+    if (!motion) {
+        return false;
+    }
+
+    float dt1 = static_cast<float>(s1.time - s0.time) / 1e9f;
+    float dt2 = static_cast<float>(s2.time - s1.time) / 1e9f;
+    if (dt2 <= 0.0f) {
+        return false;
+    }
+
+    XrVector3f linear2, angular2;
+    VelocityBetween(s1, s2, dt2, &linear2, &angular2);
+
+    motion->linearAcceleration = {0.0f, 0.0f, 0.0f};
+    motion->angularAcceleration = {0.0f, 0.0f, 0.0f};
+    motion->linearVelocity = linear2;
+    motion->angularVelocity = angular2;
+
+    if (dt1 <= 0.0f) {
+        return true;
+    }
+
+    XrVector3f linear1, angular1;
+    VelocityBetween(s0, s1, dt1, &linear1, &angular1);
+
+    // The two velocities belong to the interval midpoints
+    float span = 0.5f * (dt1 + dt2);
+    motion->linearAcceleration = Scale(Sub(linear2, linear1), 1.0f / span);
+    motion->angularAcceleration = Scale(Sub(angular2, angular1), 1.0f / span);
+
+    // Carry the newest velocity from its midpoint to s2
+    motion->linearVelocity = Add(linear2, Scale(motion->linearAcceleration, 0.5f * dt2));
+    motion->angularVelocity = Add(angular2, Scale(motion->angularAcceleration, 0.5f * dt2));
+    return true;
+}
+
+XrPosef PredictPose(const XrPosef& pose, const PoseMotion& motion, float dt, PosePredictionModel model) {
+    XrVector3f translation = Scale(motion.linearVelocity, dt);
+    XrVector3f rotation = Scale(motion.angularVelocity, dt);
+
+    if (model == POSE_PREDICTION_CONSTANT_ACCELERATION) {
+        float halfDt2 = 0.5f * dt * dt;
+        translation = Add(translation, Scale(motion.linearAcceleration, halfDt2));
+        rotation = Add(rotation, Scale(motion.angularAcceleration, halfDt2));
+    }
+
+    XrPosef predicted;
+    predicted.position = Add(pose.position, translation);
+    predicted.orientation = QuatNormalize(QuatMultiply(QuatFromRotationVector(rotation), pose.orientation));
+    return predicted;
+}
+
+bool PredictHeadPose(const PoseHistory& history, XrTime time, PosePredictionModel model,
+                     HeadPoseSample* sample) {
+    if (!sample) {
+        return false;
+    }
+
+    HeadPoseSample newest;
+    if (!history.Latest(&newest)) {
+        return false;
+    }
+
+    if (time <= newest.time) {
+        return history.Sample(time, sample);
+    }
+
+    *sample = newest;
+    sample->time = time;
+
+    // Older samples clamp to the oldest one (with its own timestamp), which
+    // EstimatePoseMotion sees as an empty interval
+    HeadPoseSample s0, s1;
+    history.Sample(newest.time - 2 * POSE_MOTION_WINDOW_NS, &s0);
+    history.Sample(newest.time - POSE_MOTION_WINDOW_NS, &s1);
+
+    PoseMotion motion;
+    if (!EstimatePoseMotion(s0, s1, newest, &motion)) {
+        return true;  // Not enough history yet, hold the newest pose
+    }
+
+    XrDuration ahead = time - newest.time;
+    if (ahead > MAX_POSE_PREDICTION_NS) {
+        ahead = MAX_POSE_PREDICTION_NS;
+    }
+
+    sample->pose = PredictPose(newest.pose, motion, static_cast<float>(ahead) / 1e9f, model);
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef POSE_PREDICTOR_H
+#define POSE_PREDICTOR_H
+
+#include <openxr/openxr.h>
+#include "pose_history.h"
+
+// How far ahead of the newest sample a pose may be predicted
+static const XrDuration MAX_POSE_PREDICTION_NS = 50000000;  // 50 ms
+
+// Spacing of the history samples used to estimate motion. Wider than the
+// tracker period so single-sample jitter does not dominate the derivative.
+static const XrDuration POSE_MOTION_WINDOW_NS = 8000000;    // 8 ms
+
+enum PosePredictionModel {
+    POSE_PREDICTION_CONSTANT_VELOCITY = 0,
+    POSE_PREDICTION_CONSTANT_ACCELERATION = 1,
+};
+
+// Head motion at the newest sample. Angular terms are world-space rotation
+// vectors (axis * rad/s, rad/s^2).
+struct PoseMotion {
+    XrVector3f linearVelocity;
+    XrVector3f linearAcceleration;
+    XrVector3f angularVelocity;
+    XrVector3f angularAcceleration;
+};
+
+// Finite differences over three samples, oldest first. Returns false if the
+// newest interval is empty; acceleration is zero if the older one is.
+bool EstimatePoseMotion(const HeadPoseSample& s0, const HeadPoseSample& s1, const HeadPoseSample& s2,
+                        PoseMotion* motion);
+
+// Integrate 'pose' forward by dt seconds. Orientation is advanced with the
+// quaternion exponential of the accumulated rotation vector.
+XrPosef PredictPose(const XrPosef& pose, const PoseMotion& motion, float dt, PosePredictionModel model);
+
+// Head pose at 'time' from the history: interpolated for past times,
+// predicted (at most MAX_POSE_PREDICTION_NS past the newest sample) for
+// future ones
+bool PredictHeadPose(const PoseHistory& history, XrTime time, PosePredictionModel model,
+                     HeadPoseSample* sample);
+
+#endif // POSE_PREDICTOR_H
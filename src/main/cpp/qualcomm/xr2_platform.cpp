@@ -1,9 +1,19 @@
 #include "xr2_platform.h"
 #include "qvr_api_wrapper.h"
 #include "spaces_sdk_wrapper.h"
+#include "pose_history.h"
+#include "pose_predictor.h"
 #include "platform/input_manager.h"
+#include "platform/vsync_source.h"
+#include "platform/compositor.h"
 #include "utils/logger.h"
+#include "utils/spsc_ring.h"
+#include "utils/pose_math.h"
+#include "utils/seqlock.h"
+#include "utils/trace.h"
 #include <mutex>
+#include <atomic>
+#include <thread>
 #include <chrono>
 #include <cstring>
 #include <vector>
@@ -20,11 +30,6 @@ static bool g_handTrackingInitialized = false; // Separate flag for hand trackin
 static bool g_renderingActive = false;
 static std::mutex g_xr2Mutex;
 
-// Prediction coefficients for pose prediction
-static float g_predictionCoeffS[3] = {0.0f, 0.0f, 0.0f}; // Velocity coefficients
-static float g_predictionCoeffB[3] = {0.0f, 0.0f, 0.0f}; // Acceleration coefficients
-static float g_predictionCoeffBdt[3] = {0.0f, 0.0f, 0.0f}; // Higher order terms
-
 // Display properties (XR2 typical values)
 static const uint32_t XR2_RECOMMENDED_WIDTH = 1832;
 static const uint32_t XR2_RECOMMENDED_HEIGHT = 1920;
@@ -32,18 +37,8 @@ static const uint32_t XR2_MAX_WIDTH = 1832;
 static const uint32_t XR2_MAX_HEIGHT = 1920;
 static const uint32_t XR2_REFRESH_RATE = 90; // Hz
 
-// Performance monitoring
-static uint64_t g_frameCount = 0;
-static XrTime g_lastFrameTime = 0;
-static float g_currentFPS = 0.0f;
-static float g_averageFrameTime = 0.0f;
-static uint32_t g_droppedFrames = 0;
-static const uint32_t FPS_SAMPLE_COUNT = 60;
-
-// Power management
+// Power management (levels are chosen by the performance governor thread)
 static bool g_powerOptimizationEnabled = false;
-static uint32_t g_currentPerfLevel = 0; // 0 = balanced, higher = more performance
-static const uint32_t XR2_MAX_PERF_LEVEL = 3;
 
 bool InitializeXR2Platform() {
     std::lock_guard<std::mutex> lock(g_xr2Mutex);
@@ -80,6 +75,8 @@ void ShutdownXR2Platform() {
     
     LOGI("Shutting down XR2 platform");
     
+    StopXR2InputSampling();
+    
     if (g_renderingActive) {
         StopXR2Rendering();
     }
@@ -121,22 +118,12 @@ bool InitializeXR2Display() {
         return false;
     }
     
-    // Configure VSYNC interrupt for frame synchronization
-    qvrservice_vsync_interrupt_config_t vsyncConfig = {};
-    vsyncConfig.cb = nullptr; // We'll use polling instead of callback
-    vsyncConfig.ctx = nullptr;
-    
-    int result = QVRServiceClient_SetDisplayInterruptConfigWrapper(
-        qvrClient, DISP_INTERRUPT_VSYNC, &vsyncConfig, sizeof(vsyncConfig));
-    
-    if (result != QVR_SUCCESS && result != QVR_CALLBACK_NOT_SUPPORTED) {
-        LOGW("Failed to configure VSYNC interrupt: %d", result);
-        // Continue anyway, we can use polling
-    }
+    // The VSYNC interrupt callback is installed by the vsync source when a
+    // session starts (SetXR2VsyncCallback)
     
     // Verify display is working
     qvrservice_ts_t* ts = nullptr;
-    result = QVRServiceClient_GetDisplayInterruptTimestampWrapper(qvrClient, DISP_INTERRUPT_VSYNC, &ts);
+    int result = QVRServiceClient_GetDisplayInterruptTimestampWrapper(qvrClient, DISP_INTERRUPT_VSYNC, &ts);
     if (result != QVR_SUCCESS) {
         LOGW("Warning: Cannot get display interrupt timestamp, display may not be working properly");
         // Continue anyway - we'll use fallback timing
@@ -172,11 +159,6 @@ void ShutdownXR2Display() {
     
     // Reset display state
     g_displayInitialized = false;
-    g_frameCount = 0;
-    g_lastFrameTime = 0;
-    g_currentFPS = 0.0f;
-    g_averageFrameTime = 0.0f;
-    g_droppedFrames = 0;
     
     LOGI("XR2 display shut down");
 }
@@ -315,28 +297,44 @@ void StopXR2Rendering() {
     LOGI("XR2 rendering stopped");
 }
 
-// Tracking state
-static float g_trackingQuality = 0.0f;
-static uint16_t g_trackingState = 0;
-static uint16_t g_trackingWarningFlags = 0;
-static bool g_relocationInProgress = false;
+// QVR tracking_state bits
+static const uint16_t XR2_TRACKING_RELOCATING = 0x1;
+static const uint16_t XR2_TRACKING_SUSPENDED = 0x2;
+static const uint16_t XR2_TRACKING_ACTIVE = 0x4;
+static const uint16_t XR2_TRACKING_FATAL_ERROR = 0x8;
 
-bool InitializeXR2Tracking() {
-    std::lock_guard<std::mutex> lock(g_xr2Mutex);
-    
-    if (g_trackingInitialized) {
-        return true;
-    }
-    
-    LOGI("Initializing XR2 tracking (SLAM system)");
-    
+// Tracker restarts after a fatal error, at most one per second
+static const uint32_t XR2_TRACKING_RECOVERY_ATTEMPTS = 3;
+
+// Head pose history, filled by the tracking thread so pose queries for any
+// XrTime are answered without a QVR round-trip
+static const uint32_t XR2_POSE_SAMPLE_RATE_HZ = 500;
+static PoseHistory g_headPoseHistory;
+static std::thread g_trackingThread;
+static std::atomic<bool> g_trackingThreadRunning(false);
+static std::atomic<int> g_posePredictionModel(POSE_PREDICTION_CONSTANT_VELOCITY);
+
+static bool FetchXR2HeadPoseSample(HeadPoseSample* sample) {
     QVRServiceClientHandle qvrClient = GetQVRClient();
     if (!qvrClient) {
-        LOGE("QVR client not available");
         return false;
     }
     
-    // Check tracking mode support
+    qvrservice_head_tracking_data_t* trackingData = nullptr;
+    int result = QVRServiceClient_GetHeadTrackingDataWrapper(qvrClient, &trackingData);
+    if (result != QVR_SUCCESS || !trackingData) {
+        return false;
+    }
+    
+    sample->time = QVRTimeToXrTime(trackingData->ts);
+    QVRPoseToXrPose(trackingData, &sample->pose);
+    sample->trackingState = trackingData->tracking_state;
+    sample->warningFlags = trackingData->tracking_warning_flags;
+    sample->quality = trackingData->pose_quality;
+    return true;
+}
+
+static bool ConfigureXR2TrackingMode(QVRServiceClientHandle qvrClient) {
     QVRSERVICE_TRACKING_MODE currentMode;
     uint32_t supportedModes;
     int result = QVRServiceClient_GetTrackingModeWrapper(qvrClient, &currentMode, &supportedModes);
@@ -356,12 +354,196 @@ bool InitializeXR2Tracking() {
             LOGW("Failed to set tracking mode to POSITIONAL: %d", result);
         }
     }
+    return true;
+}
+
+static void InvalidateFrameTracking();
+
+// Tracking thread: the tracker reported a fatal error. Set the tracking
+// mode again and drop the poses from before; pose queries meanwhile see
+// the error in the samples and report nothing tracked.
+static void RecoverXR2Tracking(uint32_t attempt) {
+    // ShutdownXR2Tracking holds the lock while it joins this thread
+    std::unique_lock<std::mutex> lock(g_xr2Mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    
+    LOGI("Attempting tracking recovery (attempt %u)", attempt);
+    QVRServiceClientHandle qvrClient = GetQVRClient();
+    if (!qvrClient || !ConfigureXR2TrackingMode(qvrClient)) {
+        LOGW("Tracking recovery failed");
+        return;
+    }
+    
+    g_headPoseHistory.Clear();
+    InvalidateFrameTracking();
+}
+
+static void TrackingThreadMain() {
+    const auto period = std::chrono::nanoseconds(1000000000ULL / XR2_POSE_SAMPLE_RATE_HZ);
+    auto nextPoll = std::chrono::steady_clock::now();
+    uint32_t failures = 0;
+    uint32_t recoveryAttempts = 0;
+    uint32_t sinceRecovery = XR2_POSE_SAMPLE_RATE_HZ;
+    
+    while (g_trackingThreadRunning.load(std::memory_order_acquire)) {
+        HeadPoseSample sample;
+        if (FetchXR2HeadPoseSample(&sample)) {
+            g_headPoseHistory.Push(sample);
+            failures = 0;
+            
+            if (!(sample.trackingState & XR2_TRACKING_FATAL_ERROR)) {
+                recoveryAttempts = 0;
+            } else if (sinceRecovery >= XR2_POSE_SAMPLE_RATE_HZ) {
+                if (recoveryAttempts < XR2_TRACKING_RECOVERY_ATTEMPTS) {
+                    RecoverXR2Tracking(++recoveryAttempts);
+                } else if (recoveryAttempts++ == XR2_TRACKING_RECOVERY_ATTEMPTS) {
+                    LOGE("Tracking recovery failed after %u attempts", XR2_TRACKING_RECOVERY_ATTEMPTS);
+                }
+                sinceRecovery = 0;
+            }
+        } else if (++failures == XR2_POSE_SAMPLE_RATE_HZ) {
+            LOGW("No head tracking data for 1 s");
+        }
+        sinceRecovery++;
+        
+        nextPoll += period;
+        auto now = std::chrono::steady_clock::now();
+        if (nextPoll < now) {
+            nextPoll = now;  // Fell behind, don't burst to catch up
+        }
+        std::this_thread::sleep_until(nextPoll);
+    }
+}
+
+static PosePredictionModel GetXR2PosePredictionModel() {
+    return static_cast<PosePredictionModel>(g_posePredictionModel.load(std::memory_order_relaxed));
+}
+
+// Tracking snapshot per frame, keyed by predicted display time. The first
+// pose query for a frame's display time captures the head pose; views,
+// spaces and time warp for that frame then all read the same sample.
+static const uint32_t FRAME_TRACKING_SNAPSHOTS = XR2_MAX_FRAMES_IN_FLIGHT + 1;
+
+struct FrameTrackingSnapshot {
+    XrTime displayTime;
+    bool captured;
+    HeadPoseSample head;
+};
+
+static SeqLocked<FrameTrackingSnapshot> g_frameTracking[FRAME_TRACKING_SNAPSHOTS];
+static uint32_t g_frameTrackingNext = 0;
+static std::mutex g_frameTrackingMutex;  // Serializes writers only
+
+static void WriteFrameTracking(SeqLocked<FrameTrackingSnapshot>* snapshot, XrTime displayTime, bool captured,
+                               const HeadPoseSample& head) {
+    FrameTrackingSnapshot value = {};
+    value.displayTime = displayTime;
+    value.captured = captured;
+    value.head = head;
+    snapshot->Store(value);
+}
+
+// Register the display time of a new frame (frame thread, once per frame)
+static void BeginXR2FrameTracking(XrTime displayTime) {
+    std::lock_guard<std::mutex> lock(g_frameTrackingMutex);
+    
+    SeqLocked<FrameTrackingSnapshot>* snapshot = &g_frameTracking[g_frameTrackingNext % FRAME_TRACKING_SNAPSHOTS];
+    g_frameTrackingNext++;
+    WriteFrameTracking(snapshot, displayTime, false, HeadPoseSample{});
+}
+
+// Head pose for a registered frame display time; false for any other time
+static bool GetXR2FrameTracking(XrTime displayTime, HeadPoseSample* head) {
+    for (const SeqLocked<FrameTrackingSnapshot>& snapshot : g_frameTracking) {
+        FrameTrackingSnapshot value = snapshot.Load();
+        if (value.captured && value.displayTime == displayTime) {
+            *head = value.head;
+            return true;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(g_frameTrackingMutex);
+    
+    // Only writers change snapshots and we hold the writer lock
+    for (SeqLocked<FrameTrackingSnapshot>& snapshot : g_frameTracking) {
+        FrameTrackingSnapshot value = snapshot.Load();
+        if (value.displayTime != displayTime) {
+            continue;
+        }
+        
+        if (value.captured) {
+            *head = value.head;
+            return true;
+        }
+        
+        if (!PredictHeadPose(g_headPoseHistory, displayTime, GetXR2PosePredictionModel(), head)) {
+            return false;
+        }
+        WriteFrameTracking(&snapshot, displayTime, true, *head);
+        return true;
+    }
+    
+    return false;
+}
+
+// Head pose at 'time': the frame's shared snapshot if 'time' is a frame
+// display time, otherwise from the history, or straight from QVR before the
+// tracking thread has produced its first sample
+static bool GetXR2HeadPoseSample(XrTime time, HeadPoseSample* sample) {
+    if (GetXR2FrameTracking(time, sample)) {
+        return true;
+    }
+    
+    if (PredictHeadPose(g_headPoseHistory, time, GetXR2PosePredictionModel(), sample)) {
+        return true;
+    }
+    
+    if (!FetchXR2HeadPoseSample(sample)) {
+        LOGE("Failed to get head tracking data");
+        return false;
+    }
+    return true;
+}
+
+// Frame snapshots captured from an old history are stale
+static void InvalidateFrameTracking() {
+    std::lock_guard<std::mutex> lock(g_frameTrackingMutex);
+    for (SeqLocked<FrameTrackingSnapshot>& snapshot : g_frameTracking) {
+        WriteFrameTracking(&snapshot, 0, false, HeadPoseSample{});
+    }
+}
+
+void SetXR2PosePredictionModel(PosePredictionModel model) {
+    g_posePredictionModel.store(model, std::memory_order_relaxed);
+    LOGI("Pose prediction model: %s", 
+         model == POSE_PREDICTION_CONSTANT_ACCELERATION ? "constant acceleration" : "constant velocity");
+}
+
+bool InitializeXR2Tracking() {
+    std::lock_guard<std::mutex> lock(g_xr2Mutex);
+    
+    if (g_trackingInitialized) {
+        return true;
+    }
+    
+    LOGI("Initializing XR2 tracking (SLAM system)");
+    
+    QVRServiceClientHandle qvrClient = GetQVRClient();
+    if (!qvrClient) {
+        LOGE("QVR client not available");
+        return false;
+    }
+    
+    if (!ConfigureXR2TrackingMode(qvrClient)) {
+        return false;
+    }
     
-    // Initialize tracking state
-    g_trackingQuality = 0.0f;
-    g_trackingState = 0;
-    g_trackingWarningFlags = 0;
-    g_relocationInProgress = false;
+    // Start filling the pose history
+    g_headPoseHistory.Clear();
+    g_trackingThreadRunning.store(true, std::memory_order_release);
+    g_trackingThread = std::thread(TrackingThreadMain);
     
     g_trackingInitialized = true;
     
@@ -378,11 +560,12 @@ void ShutdownXR2Tracking() {
     
     LOGI("Shutting down XR2 tracking");
     
-    // Reset tracking state
-    g_trackingQuality = 0.0f;
-    g_trackingState = 0;
-    g_trackingWarningFlags = 0;
-    g_relocationInProgress = false;
+    g_trackingThreadRunning.store(false, std::memory_order_release);
+    if (g_trackingThread.joinable()) {
+        g_trackingThread.join();
+    }
+    
+    InvalidateFrameTracking();
     
     g_trackingInitialized = false;
     LOGI("XR2 tracking shut down");
@@ -394,208 +577,77 @@ bool GetXR2ViewPoses(XrTime time, XrSpace space, XrView* views, uint32_t count,
         return false;
     }
     
-    QVRServiceClientHandle qvrClient = GetQVRClient();
-    if (!qvrClient) {
+    // Head pose at the requested time
+    HeadPoseSample headSample;
+    if (!GetXR2HeadPoseSample(time, &headSample)) {
         return false;
     }
+    const XrPosef& headPose = headSample.pose;
     
-    // Get head tracking data from QVR
-    qvrservice_head_tracking_data_t* trackingData = nullptr;
-    int result = QVRServiceClient_GetHeadTrackingDataWrapper(qvrClient, &trackingData);
-    if (result != QVR_SUCCESS || !trackingData) {
-        LOGE("Failed to get head tracking data: %d", result);
+    // Cached eye calibration (no QVR queries here)
+    XR2EyeCalibration calibration;
+    if (!GetXR2EyeCalibration(&calibration)) {
         return false;
     }
     
-    // Convert QVR pose to OpenXR pose
-    XrPosef headPose;
-    QVRPoseToXrPose(trackingData, &headPose);
-    
-    // Get eye offsets and FOV
-    XrVector3f leftEyeOffset = {0, 0, 0};
-    XrVector3f rightEyeOffset = {0, 0, 0};
-    XrFovf leftEyeFov = {0, 0, 0, 0};
-    XrFovf rightEyeFov = {0, 0, 0, 0};
-    
-    GetXR2EyeOffsets(&leftEyeOffset, &rightEyeOffset);
-    GetXR2ViewFOV(&leftEyeFov, &rightEyeFov);
-    
     // Set view poses with eye offsets
     for (uint32_t i = 0; i < count && i < 2; ++i) {
         views[i].type = XR_TYPE_VIEW;
         
         // Apply eye offset to head pose
-        XrVector3f eyeOffset = (i == 0) ? leftEyeOffset : rightEyeOffset;
-        
-        // Transform eye offset by head rotation using quaternion rotation
-        // Correct formula: v' = q * v * q^-1, where v is treated as pure quaternion (0, x, y, z)
-        float qx = headPose.orientation.x;
-        float qy = headPose.orientation.y;
-        float qz = headPose.orientation.z;
-        float qw = headPose.orientation.w;
-        
-        // Rotate vector by quaternion: v' = q * v * q^-1
-        // For pure quaternion v = (0, x, y, z), this simplifies to:
-        // v' = 2 * dot(q.xyz, v) * q.xyz + (qw^2 - dot(q.xyz, q.xyz)) * v + 2 * qw * cross(q.xyz, v)
-        // Or using the standard formula:
-        // t = 2 * cross(q.xyz, v)
-        // v' = v + qw * t + cross(q.xyz, t)
-        
-        // Cross product: q.xyz × eyeOffset
-        float crossX = qy * eyeOffset.z - qz * eyeOffset.y;
-        float crossY = qz * eyeOffset.x - qx * eyeOffset.z;
-        float crossZ = qx * eyeOffset.y - qy * eyeOffset.x;
+        const XrVector3f& eyeOffset = calibration.eyeOffset[i];
         
-        // t = 2 * cross
-        float tx = 2.0f * crossX;
-        float ty = 2.0f * crossY;
-        float tz = 2.0f * crossZ;
+        // Transform eye offset by head rotation
+        XrVector3f rotated = QuatRotateVector(headPose.orientation, eyeOffset);
         
-        // v' = v + qw * t + cross(q.xyz, t)
-        float rotatedX = eyeOffset.x + qw * tx + (qy * tz - qz * ty);
-        float rotatedY = eyeOffset.y + qw * ty + (qz * tx - qx * tz);
-        float rotatedZ = eyeOffset.z + qw * tz + (qx * ty - qy * tx);
-        
-        views[i].pose.position.x = headPose.position.x + rotatedX;
-        views[i].pose.position.y = headPose.position.y + rotatedY;
-        views[i].pose.position.z = headPose.position.z + rotatedZ;
+        views[i].pose.position.x = headPose.position.x + rotated.x;
+        views[i].pose.position.y = headPose.position.y + rotated.y;
+        views[i].pose.position.z = headPose.position.z + rotated.z;
         views[i].pose.orientation = headPose.orientation;
         
         // Set FOV
-        views[i].fov = (i == 0) ? leftEyeFov : rightEyeFov;
+        views[i].fov = calibration.fov[i];
     }
     
-    // Update tracking state and quality
-    g_trackingState = trackingData->tracking_state;
-    g_trackingWarningFlags = trackingData->tracking_warning_flags;
-    g_trackingQuality = trackingData->pose_quality;
-    g_relocationInProgress = (trackingData->tracking_state & 0x1) != 0; // RELOCATION_IN_PROGRESS bit
-    
-    // Check tracking state
+    // Flags from the same sample as the pose, never another query's
     *viewStateFlags = 0;
-    
-    // TRACKING bit (bit 2)
-    if (g_trackingState & 0x4) {
+    uint16_t trackingState = headSample.trackingState;
+    if ((trackingState & XR2_TRACKING_ACTIVE) &&
+        !(trackingState & (XR2_TRACKING_SUSPENDED | XR2_TRACKING_FATAL_ERROR))) {
         *viewStateFlags |= XR_VIEW_STATE_ORIENTATION_TRACKED_BIT;
         *viewStateFlags |= XR_VIEW_STATE_POSITION_TRACKED_BIT;
     }
     
-    // Log tracking quality and warnings
-    if (g_trackingQuality < 0.5f) {
-        LOGW("Low tracking quality: %.2f", g_trackingQuality);
+    // Trace tracking quality and warnings (rate limited). Warning bits:
+    // 0x1 low feature count, 0x2 low light, 0x4 bright light,
+    // 0x8 stereo camera calibration
+    if (headSample.quality < 0.5f) {
+        TRACEW(TRACE_TRACKING_LOW_QUALITY, headSample.quality);
     }
     
-    if (g_trackingWarningFlags != 0) {
-        if (g_trackingWarningFlags & 0x1) {
-            LOGW("Tracking warning: LOW_FEATURE_COUNT_ERROR");
-        }
-        if (g_trackingWarningFlags & 0x2) {
-            LOGW("Tracking warning: LOW_LIGHT_ERROR");
-        }
-        if (g_trackingWarningFlags & 0x4) {
-            LOGW("Tracking warning: BRIGHT_LIGHT_ERROR");
-        }
-        if (g_trackingWarningFlags & 0x8) {
-            LOGW("Tracking warning: STEREO_CAMERA_CALIBRATION_ERROR");
-        }
+    if (headSample.warningFlags != 0) {
+        TRACEW(TRACE_TRACKING_WARNING, headSample.warningFlags);
     }
     
-    if (g_relocationInProgress) {
-        LOGI("Tracking: Relocation in progress");
+    if (trackingState & XR2_TRACKING_RELOCATING) {
+        TRACEI(TRACE_TRACKING_RELOCATING);
     }
     
     return true;
 }
 
-// Predict pose forward in time using QVR prediction coefficients
-static void PredictPose(const qvrservice_head_tracking_data_t* trackingData, 
-                        XrTime targetTime, XrPosef* predictedPose) {
-    if (!trackingData || !predictedPose) {
-        return;
-    }
-    
-    // Get current pose
-    QVRPoseToXrPose(trackingData, predictedPose);
-    
-    // Calculate prediction delta time in seconds
-    XrTime currentTime = QVRTimeToXrTime(trackingData->ts);
-    XrDuration deltaTimeNs = targetTime - currentTime;
-    float deltaTimeS = static_cast<float>(deltaTimeNs) / 1e9f;
-    
-    if (deltaTimeS <= 0.0f || deltaTimeS > 0.1f) {
-        // No prediction needed or prediction too far in future
-        return;
-    }
-    
-    // Apply prediction coefficients (using QVR prediction model)
-    // QVR provides prediction coefficients for velocity (s), acceleration (b), 
-    // and higher order terms (bdt, bdt2)
-    float predX = g_predictionCoeffS[0] * deltaTimeS + 
-                  g_predictionCoeffB[0] * deltaTimeS * deltaTimeS +
-                  g_predictionCoeffBdt[0] * deltaTimeS * deltaTimeS * deltaTimeS;
-    float predY = g_predictionCoeffS[1] * deltaTimeS + 
-                  g_predictionCoeffB[1] * deltaTimeS * deltaTimeS +
-                  g_predictionCoeffBdt[1] * deltaTimeS * deltaTimeS * deltaTimeS;
-    float predZ = g_predictionCoeffS[2] * deltaTimeS + 
-                  g_predictionCoeffB[2] * deltaTimeS * deltaTimeS +
-                  g_predictionCoeffBdt[2] * deltaTimeS * deltaTimeS * deltaTimeS;
-    
-    // Apply position prediction
-    predictedPose->position.x += predX;
-    predictedPose->position.y += predY;
-    predictedPose->position.z += predZ;
-    
-    // Apply rotation prediction using quaternion interpolation
-    // Use angular velocity approximation for rotation prediction
-    // Extract angular velocity from prediction coefficients if available
-    // For now, use SLERP (Spherical Linear Interpolation) based on time delta
-    
-    // Calculate rotation prediction using quaternion exponentiation
-    // q(t) = q(0) * exp(0.5 * omega * t), where omega is angular velocity
-    // Simplified: use quaternion slerp with a small rotation based on time delta
-    
-    // Get current rotation quaternion
-    XrQuaternionf currentRot = predictedPose->orientation;
-    
-    // For small time deltas, approximate rotation change
-    // This is a simplified approach - full implementation would use angular velocity
-    if (deltaTimeS > 0.0f && deltaTimeS < 0.1f) {
-        // Use identity quaternion as base (no rotation change prediction for now)
-        // In a full implementation, we'd extract angular velocity from tracking data
-        // and apply it: q_predicted = q_current * q_angular_velocity_delta
-        // For now, keep current rotation (rotation prediction requires angular velocity data)
-    }
-    
-    // Note: Orientation prediction would require quaternion math
-    // For now, we only predict position
-}
-
 bool LocateXR2ReferenceSpace(XrReferenceSpaceType space, XrReferenceSpaceType baseSpace,
                              XrTime time, XrPosef* pose, XrSpaceLocationFlags* locationFlags) {
     if (!pose || !locationFlags) {
         return false;
     }
     
-    QVRServiceClientHandle qvrClient = GetQVRClient();
-    if (!qvrClient) {
+    // Interpolated for past times, predicted (bounded) for future ones
+    HeadPoseSample headSample;
+    if (!GetXR2HeadPoseSample(time, &headSample)) {
         return false;
     }
-    
-    // Get head tracking data from QVR
-    qvrservice_head_tracking_data_t* trackingData = nullptr;
-    int result = QVRServiceClient_GetHeadTrackingDataWrapper(qvrClient, &trackingData);
-    if (result != QVR_SUCCESS || !trackingData) {
-        LOGE("Failed to get head tracking data: %d", result);
-        return false;
-    }
-    
-    // Convert QVR pose to OpenXR pose
-    QVRPoseToXrPose(trackingData, pose);
-    
-    // Apply pose prediction if target time is in the future
-    if (time > QVRTimeToXrTime(trackingData->ts)) {
-        PredictPose(trackingData, time, pose);
-    }
+    *pose = headSample.pose;
     
     // Transform between reference spaces if needed
     if (space != baseSpace && baseSpace == XR_REFERENCE_SPACE_TYPE_LOCAL) {
@@ -603,69 +655,37 @@ bool LocateXR2ReferenceSpace(XrReferenceSpaceType space, XrReferenceSpaceType ba
         // In a full implementation, we would transform between spaces
     }
     
-    // Update tracking state
-    g_trackingState = trackingData->tracking_state;
-    g_trackingWarningFlags = trackingData->tracking_warning_flags;
-    g_trackingQuality = trackingData->pose_quality;
-    g_relocationInProgress = (trackingData->tracking_state & 0x1) != 0;
-    
-    // Set location flags based on tracking state
+    // Flags from the same sample as the pose, never another query's
     *locationFlags = 0;
+    uint16_t trackingState = headSample.trackingState;
     
-    // TRACKING bit (bit 2)
-    if (g_trackingState & 0x4) {
+    // Fatal tracker error: nothing is valid. The tracking thread restarts
+    // the tracker.
+    if (trackingState & XR2_TRACKING_FATAL_ERROR) {
+        return false;
+    }
+    
+    if (trackingState & XR2_TRACKING_ACTIVE) {
         *locationFlags |= XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
         *locationFlags |= XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
     }
     
-    // Check if position is valid (for positional tracking)
-    if (g_trackingQuality > 0.0f) {
+    // Check if position is valid (for positional tracking); during
+    // relocation it may not be
+    if (headSample.quality > 0.0f && !(trackingState & XR2_TRACKING_RELOCATING)) {
         *locationFlags |= XR_SPACE_LOCATION_POSITION_VALID_BIT;
     }
     
-    // Handle relocation state
-    if (g_relocationInProgress) {
-        // During relocation, position may be invalid
-        *locationFlags &= ~XR_SPACE_LOCATION_POSITION_VALID_BIT;
-    }
-    
-    // Handle tracking suspension (bit 1)
-    if (g_trackingState & 0x2) {
+    if (trackingState & XR2_TRACKING_SUSPENDED) {
         LOGW("Tracking suspended");
         *locationFlags &= ~(XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | 
                           XR_SPACE_LOCATION_POSITION_TRACKED_BIT);
     }
     
-    // Handle fatal error (bit 3)
-    if (g_trackingState & 0x8) {
-        LOGE("Tracking fatal error - attempting recovery");
-        *locationFlags = 0;
-        
-        // Attempt recovery by reinitializing tracking
-        static uint32_t recoveryAttempts = 0;
-        if (recoveryAttempts < 3) {
-            recoveryAttempts++;
-            LOGI("Attempting tracking recovery (attempt %u)", recoveryAttempts);
-            
-            // Reinitialize tracking
-            ShutdownXR2Tracking();
-            if (InitializeXR2Tracking()) {
-                LOGI("Tracking recovery successful");
-                recoveryAttempts = 0;
-            } else {
-                LOGW("Tracking recovery failed");
-            }
-        } else {
-            LOGE("Tracking recovery failed after %u attempts", recoveryAttempts);
-        }
-        
-        return false;
-    }
-    
     return true;
 }
 
-bool GetXR2ViewFOV(XrFovf* leftEyeFov, XrFovf* rightEyeFov) {
+static bool QueryXR2ViewFOV(XrFovf* leftEyeFov, XrFovf* rightEyeFov) {
     if (!leftEyeFov || !rightEyeFov) {
         return false;
     }
@@ -674,8 +694,8 @@ bool GetXR2ViewFOV(XrFovf* leftEyeFov, XrFovf* rightEyeFov) {
     if (!qvrClient) {
         // Default FOV values (typical for XR2: ~90 degrees horizontal)
         float defaultFov = 1.0f; // ~57.3 degrees in radians (tan(57.3/2) ≈ 0.5)
-        *leftEyeFov = {-defaultFov, defaultFov, -defaultFov, defaultFov};
-        *rightEyeFov = {-defaultFov, defaultFov, -defaultFov, defaultFov};
+        *leftEyeFov = {-defaultFov, defaultFov, defaultFov, -defaultFov};
+        *rightEyeFov = {-defaultFov, defaultFov, defaultFov, -defaultFov};
         return true;
     }
     
@@ -698,9 +718,9 @@ bool GetXR2ViewFOV(XrFovf* leftEyeFov, XrFovf* rightEyeFov) {
         vFov = static_cast<float>(atof(value));
     }
     
-    // Set FOV (left/right, up/down angles in radians)
-    *leftEyeFov = {-hFov, hFov, -vFov, vFov};
-    *rightEyeFov = {-hFov, hFov, -vFov, vFov};
+    // Set FOV (left/right, up/down angles in radians; up is positive)
+    *leftEyeFov = {-hFov, hFov, vFov, -vFov};
+    *rightEyeFov = {-hFov, hFov, vFov, -vFov};
     
     LOGI("View FOV: left=[%.3f, %.3f, %.3f, %.3f], right=[%.3f, %.3f, %.3f, %.3f]",
          leftEyeFov->angleLeft, leftEyeFov->angleRight,
@@ -711,7 +731,7 @@ bool GetXR2ViewFOV(XrFovf* leftEyeFov, XrFovf* rightEyeFov) {
     return true;
 }
 
-bool GetXR2EyeOffsets(XrVector3f* leftEyeOffset, XrVector3f* rightEyeOffset) {
+static bool QueryXR2EyeOffsets(XrVector3f* leftEyeOffset, XrVector3f* rightEyeOffset) {
     if (!leftEyeOffset || !rightEyeOffset) {
         return false;
     }
@@ -728,6 +748,9 @@ bool GetXR2EyeOffsets(XrVector3f* leftEyeOffset, XrVector3f* rightEyeOffset) {
         return true;
     }
     
+    *leftEyeOffset = {0.0f, 0.0f, 0.0f};
+    *rightEyeOffset = {0.0f, 0.0f, 0.0f};
+    
     // Get eye offsets from hardware transforms
     uint32_t numTransforms = 0;
     int result = QVRServiceClient_GetHwTransformsWrapper(qvrClient, &numTransforms, nullptr);
@@ -767,6 +790,83 @@ bool GetXR2EyeOffsets(XrVector3f* leftEyeOffset, XrVector3f* rightEyeOffset) {
     return true;
 }
 
+// Eye calibration cache. Reads are lock-free (seqlock) so xrLocateViews
+// never queries QVR; refreshes are rare and serialized.
+static SeqLocked<XR2EyeCalibration> g_eyeCalibration;
+static std::atomic<bool> g_eyeCalibrationValid(false);
+static std::mutex g_eyeCalibrationMutex;
+
+static void ComputeXR2EyeProjection(const XrFovf& fov, XR2EyeProjection* projection) {
+    projection->tanLeft = tanf(fov.angleLeft);
+    projection->tanRight = tanf(fov.angleRight);
+    projection->tanUp = tanf(fov.angleUp);
+    projection->tanDown = tanf(fov.angleDown);
+    
+    float width = projection->tanRight - projection->tanLeft;
+    float height = projection->tanUp - projection->tanDown;
+    projection->scaleX = 2.0f / width;
+    projection->scaleY = 2.0f / height;
+    projection->offsetX = -(projection->tanRight + projection->tanLeft) / width;
+    projection->offsetY = -(projection->tanUp + projection->tanDown) / height;
+}
+
+bool RefreshXR2EyeCalibration() {
+    std::lock_guard<std::mutex> lock(g_eyeCalibrationMutex);
+    
+    XR2EyeCalibration calibration = {};
+    if (!QueryXR2ViewFOV(&calibration.fov[0], &calibration.fov[1]) ||
+        !QueryXR2EyeOffsets(&calibration.eyeOffset[0], &calibration.eyeOffset[1])) {
+        LOGE("Failed to query eye calibration");
+        return false;
+    }
+    
+    for (uint32_t eye = 0; eye < 2; ++eye) {
+        ComputeXR2EyeProjection(calibration.fov[eye], &calibration.projection[eye]);
+    }
+    
+    g_eyeCalibration.Store(calibration);
+    g_eyeCalibrationValid.store(true, std::memory_order_release);
+    
+    LOGI("Eye calibration refreshed");
+    return true;
+}
+
+bool GetXR2EyeCalibration(XR2EyeCalibration* calibration) {
+    if (!calibration) {
+        return false;
+    }
+    
+    // Nothing cached yet (no session started): fill it once now
+    if (!g_eyeCalibrationValid.load(std::memory_order_acquire) && !RefreshXR2EyeCalibration()) {
+        return false;
+    }
+    
+    g_eyeCalibration.Load(calibration);
+    return true;
+}
+
+bool GetXR2ViewFOV(XrFovf* leftEyeFov, XrFovf* rightEyeFov) {
+    XR2EyeCalibration calibration;
+    if (!leftEyeFov || !rightEyeFov || !GetXR2EyeCalibration(&calibration)) {
+        return false;
+    }
+    
+    *leftEyeFov = calibration.fov[0];
+    *rightEyeFov = calibration.fov[1];
+    return true;
+}
+
+bool GetXR2EyeOffsets(XrVector3f* leftEyeOffset, XrVector3f* rightEyeOffset) {
+    XR2EyeCalibration calibration;
+    if (!leftEyeOffset || !rightEyeOffset || !GetXR2EyeCalibration(&calibration)) {
+        return false;
+    }
+    
+    *leftEyeOffset = calibration.eyeOffset[0];
+    *rightEyeOffset = calibration.eyeOffset[1];
+    return true;
+}
+
 bool GetXR2StageBounds(XrExtent2Df* bounds) {
     if (!bounds) {
         return false;
@@ -804,8 +904,35 @@ bool GetXR2StageBounds(XrExtent2Df* bounds) {
     return true;
 }
 
-bool WaitForXR2NextFrame(XrTime* predictedDisplayTime, XrDuration* predictedDisplayPeriod) {
-    if (!predictedDisplayTime || !predictedDisplayPeriod) {
+// QVR display interrupt callback; runs on a QVR service thread
+static void XR2VsyncCallback(void* /*ctx*/, uint64_t ts) {
+    PublishVsync(QVRTimeToXrTime(ts));
+}
+
+bool SetXR2VsyncCallback(bool enable) {
+    QVRServiceClientHandle qvrClient = GetQVRClient();
+    if (!qvrClient) {
+        return false;
+    }
+    
+    qvrservice_vsync_interrupt_config_t vsyncConfig = {};
+    vsyncConfig.cb = enable ? XR2VsyncCallback : nullptr;
+    vsyncConfig.ctx = nullptr;
+    
+    int result = QVRServiceClient_SetDisplayInterruptConfigWrapper(
+        qvrClient, DISP_INTERRUPT_VSYNC, &vsyncConfig, sizeof(vsyncConfig));
+    if (result != QVR_SUCCESS) {
+        if (enable) {
+            LOGW("VSYNC interrupt callback not available: %d", result);
+        }
+        return false;
+    }
+    
+    return true;
+}
+
+bool GetXR2VsyncTiming(XrTime* lastVsyncTime, XrDuration* nominalPeriod) {
+    if (!lastVsyncTime || !nominalPeriod) {
         return false;
     }
     
@@ -817,71 +944,20 @@ bool WaitForXR2NextFrame(XrTime* predictedDisplayTime, XrDuration* predictedDisp
     // Get display interrupt timestamp (VSYNC)
     qvrservice_ts_t* ts = nullptr;
     int result = QVRServiceClient_GetDisplayInterruptTimestampWrapper(qvrClient, DISP_INTERRUPT_VSYNC, &ts);
-    
-    XrTime currentTime = 0;
-    if (result == QVR_SUCCESS && ts) {
-        // Convert QVR timestamp to OpenXR time
-        currentTime = QVRTimeToXrTime(ts->ts);
-        // Calculate period from refresh rate
-        *predictedDisplayPeriod = 1000000000ULL / XR2_REFRESH_RATE;
-    } else {
-        // Fallback: use current time
-        auto now = std::chrono::steady_clock::now();
-        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
-        currentTime = static_cast<XrTime>(nanos);
-        *predictedDisplayPeriod = 1000000000ULL / XR2_REFRESH_RATE;
-    }
-    
-    // Performance monitoring: Calculate FPS and frame time
-    if (g_lastFrameTime > 0) {
-        XrDuration frameTime = currentTime - g_lastFrameTime;
-        float frameTimeMs = static_cast<float>(frameTime) / 1e6f;
-        
-        // Update average frame time (exponential moving average)
-        if (g_averageFrameTime == 0.0f) {
-            g_averageFrameTime = frameTimeMs;
-        } else {
-            g_averageFrameTime = g_averageFrameTime * 0.9f + frameTimeMs * 0.1f;
-        }
-        
-        // Calculate FPS
-        g_currentFPS = 1000.0f / g_averageFrameTime;
-        
-        // Detect dropped frames (frame time > 1.5x expected)
-        float expectedFrameTime = 1000.0f / XR2_REFRESH_RATE;
-        if (frameTimeMs > expectedFrameTime * 1.5f) {
-            g_droppedFrames++;
-            LOGW("Frame drop detected: frameTime=%.2f ms, expected=%.2f ms", 
-                 frameTimeMs, expectedFrameTime);
-        }
-        
-        // Log performance stats periodically
-        if (g_frameCount % FPS_SAMPLE_COUNT == 0) {
-            LOGI("Performance: FPS=%.1f, AvgFrameTime=%.2f ms, DroppedFrames=%u",
-                 g_currentFPS, g_averageFrameTime, g_droppedFrames);
-        }
+    if (result != QVR_SUCCESS || !ts) {
+        return false;
     }
     
-    g_lastFrameTime = currentTime;
-    g_frameCount++;
-    *predictedDisplayTime = currentTime + *predictedDisplayPeriod;
-    
+    // Convert QVR timestamp to OpenXR time
+    *lastVsyncTime = QVRTimeToXrTime(ts->ts);
+    *nominalPeriod = 1000000000LL / XR2_REFRESH_RATE;
     return true;
 }
 
-// Frame rendering state (for time warp)
-static XrTime g_lastHeadPoseTime = 0;
-static XrTime g_currentHeadPoseTime = 0;
-static XrPosef g_lastHeadPose = {{0, 0, 0, 1}, {0, 0, 0}};
-static XrPosef g_currentHeadPose = {{0, 0, 0, 1}, {0, 0, 0}};
-static XrPosef g_smoothedHeadPose = {{0, 0, 0, 1}, {0, 0, 0}};
-
-// Pose prediction coefficients (from QVR tracking data)
-// Note: These are already defined at the top of the file, removing duplicate definitions
-static float g_predictionCoeffBdt2[3] = {0, 0, 0};
-
-// Smoothing factor for pose (0.0 = no smoothing, 1.0 = full smoothing)
-static const float POSE_SMOOTHING_FACTOR = 0.1f;
+void ScheduleXR2Frame(XrTime predictedDisplayTime) {
+    // Frame statistics are recorded by the frame telemetry ring
+    BeginXR2FrameTracking(predictedDisplayTime);
+}
 
 bool BeginXR2FrameRendering() {
     std::lock_guard<std::mutex> lock(g_xr2Mutex);
@@ -890,42 +966,7 @@ bool BeginXR2FrameRendering() {
         return false;
     }
     
-    // Adaptive quality and power management
-    if (g_averageFrameTime > 0.0f) {
-        // Adjust performance level based on FPS
-        if (g_currentFPS < XR2_REFRESH_RATE * 0.7f && g_currentPerfLevel < XR2_MAX_PERF_LEVEL) {
-            // Increase performance level if FPS is low
-            g_currentPerfLevel++;
-            SetXR2PerformanceLevel(g_currentPerfLevel);
-            LOGI("Increased performance level to %u (FPS: %.1f)", g_currentPerfLevel, g_currentFPS);
-        } else if (g_currentFPS > XR2_REFRESH_RATE * 0.95f && g_currentPerfLevel > 0) {
-            // Decrease performance level if FPS is stable (save power)
-            g_currentPerfLevel--;
-            SetXR2PerformanceLevel(g_currentPerfLevel);
-            LOGI("Decreased performance level to %u (FPS: %.1f) - power saving", 
-                 g_currentPerfLevel, g_currentFPS);
-        }
-        
-        // Warn if FPS is still low after adjustment
-        if (g_currentFPS < XR2_REFRESH_RATE * 0.7f) {
-            LOGW("Low FPS detected: %.1f (target: %u), consider reducing quality", 
-                 g_currentFPS, XR2_REFRESH_RATE);
-        }
-    }
-    
-    // Get current head pose for time warp prediction
-    QVRServiceClientHandle qvrClient = GetQVRClient();
-    if (qvrClient) {
-        qvrservice_head_tracking_data_t* trackingData = nullptr;
-        int result = QVRServiceClient_GetHeadTrackingDataWrapper(qvrClient, &trackingData);
-        if (result == QVR_SUCCESS && trackingData) {
-            g_lastHeadPose = g_currentHeadPose;
-            QVRPoseToXrPose(trackingData, &g_currentHeadPose);
-            g_lastHeadPoseTime = g_currentHeadPoseTime;
-            g_currentHeadPoseTime = QVRTimeToXrTime(trackingData->ts);
-        }
-    }
-    
+    // CPU/GPU levels are adjusted by the performance governor thread
     return true;
 }
 
@@ -934,176 +975,70 @@ bool EndXR2FrameRendering() {
     return true;
 }
 
-// Calculate time warp matrix for a given eye and predicted display time
-static void CalculateTimeWarpMatrix(const XrPosef& renderPose, const XrPosef& displayPose,
-                                    const XrFovf& fov, float* warpMatrix) {
-    if (!warpMatrix) {
-        return;
+// XR2 display backend for the compositor thread
+class XR2CompositorBackend : public CompositorBackend {
+public:
+    bool Initialize() override {
+        return GetQVRClient() != nullptr;
     }
     
-    // Calculate rotation difference between render pose and display pose
-    // Time warp corrects for head movement between render time and display time
-    
-    // Get quaternion inverse of render pose
-    XrQuaternionf renderInv = {
-        -renderPose.orientation.x,
-        -renderPose.orientation.y,
-        -renderPose.orientation.z,
-        renderPose.orientation.w
-    };
-    
-    // Calculate relative rotation: displayPose * renderPose^-1
-    // This gives the rotation needed to correct from render pose to display pose
-    XrQuaternionf relativeRot;
-    relativeRot.x = displayPose.orientation.w * renderInv.x + displayPose.orientation.x * renderInv.w +
-                    displayPose.orientation.y * renderInv.z - displayPose.orientation.z * renderInv.y;
-    relativeRot.y = displayPose.orientation.w * renderInv.y - displayPose.orientation.x * renderInv.z +
-                    displayPose.orientation.y * renderInv.w + displayPose.orientation.z * renderInv.x;
-    relativeRot.z = displayPose.orientation.w * renderInv.z + displayPose.orientation.x * renderInv.y -
-                    displayPose.orientation.y * renderInv.x + displayPose.orientation.z * renderInv.w;
-    relativeRot.w = displayPose.orientation.w * renderInv.w - displayPose.orientation.x * renderInv.x -
-                    displayPose.orientation.y * renderInv.y - displayPose.orientation.z * renderInv.z;
-    
-    // Normalize quaternion
-    float len = sqrtf(relativeRot.x * relativeRot.x + relativeRot.y * relativeRot.y + 
-                     relativeRot.z * relativeRot.z + relativeRot.w * relativeRot.w);
-    if (len > 0.0001f) {
-        relativeRot.x /= len;
-        relativeRot.y /= len;
-        relativeRot.z /= len;
-        relativeRot.w /= len;
-    }
-    
-    // Convert quaternion to rotation matrix (column-major for OpenGL)
-    float x = relativeRot.x, y = relativeRot.y, z = relativeRot.z, w = relativeRot.w;
-    
-    // Rotation matrix from quaternion
-    warpMatrix[0] = 1.0f - 2.0f * (y * y + z * z);
-    warpMatrix[1] = 2.0f * (x * y + z * w);
-    warpMatrix[2] = 2.0f * (x * z - y * w);
-    warpMatrix[3] = 0.0f;
-    
-    warpMatrix[4] = 2.0f * (x * y - z * w);
-    warpMatrix[5] = 1.0f - 2.0f * (x * x + z * z);
-    warpMatrix[6] = 2.0f * (y * z + x * w);
-    warpMatrix[7] = 0.0f;
-    
-    warpMatrix[8] = 2.0f * (x * z + y * w);
-    warpMatrix[9] = 2.0f * (y * z - x * w);
-    warpMatrix[10] = 1.0f - 2.0f * (x * x + y * y);
-    warpMatrix[11] = 0.0f;
-    
-    warpMatrix[12] = 0.0f;
-    warpMatrix[13] = 0.0f;
-    warpMatrix[14] = 0.0f;
-    warpMatrix[15] = 1.0f;
-}
-
-bool SubmitXR2FrameLayers(const XrCompositionLayerBaseHeader* const* layers, uint32_t layerCount) {
-    if (!layers || layerCount == 0) {
-        return false;
+    void Shutdown() override {
     }
     
-    std::lock_guard<std::mutex> lock(g_xr2Mutex);
-    
-    if (!g_renderingActive) {
-        LOGE("Cannot submit layers: rendering not active");
-        return false;
-    }
-    
-    QVRServiceClientHandle qvrClient = GetQVRClient();
-    if (!qvrClient) {
-        LOGE("Cannot submit layers: QVR client not available");
-        return false;
-    }
-    
-    // Get predicted display time for time warp
-    // Use late-latching: predict pose as close to VSYNC as possible
-    XrTime predictedDisplayTime = 0;
-    XrDuration predictedDisplayPeriod = 0;
-    WaitForXR2NextFrame(&predictedDisplayTime, &predictedDisplayPeriod);
-    
-    // Optimize motion-to-photon latency by predicting pose at display time
-    // This reduces the time between pose capture and display
-    
-    // Get current head pose for time warp
-    qvrservice_head_tracking_data_t* trackingData = nullptr;
-    int result = QVRServiceClient_GetHeadTrackingDataWrapper(qvrClient, &trackingData);
-    if (result != QVR_SUCCESS || !trackingData) {
-        LOGW("Failed to get head tracking data for time warp");
-    }
-    
-    XrPosef displayPose = g_currentHeadPose;
-    if (trackingData) {
-        QVRPoseToXrPose(trackingData, &displayPose);
+    bool SampleWarpPoses(XrTime renderTime, XrTime targetTime,
+                         XrPosef* renderPose, XrPosef* displayPose) override {
+        // Render pose: the frame's tracking snapshot. Display pose: the
+        // newest prediction for the vsync being composed.
+        HeadPoseSample renderSample;
+        if (!GetXR2HeadPoseSample(renderTime, &renderSample)) {
+            return false;
+        }
+        
+        HeadPoseSample displaySample = renderSample;
+        PredictHeadPose(g_headPoseHistory, targetTime, GetXR2PosePredictionModel(), &displaySample);
+        
+        *renderPose = renderSample.pose;
+        *displayPose = displaySample.pose;
+        return true;
     }
     
-    // Process each layer
-    for (uint32_t i = 0; i < layerCount; ++i) {
-        const XrCompositionLayerBaseHeader* layer = layers[i];
-        if (!layer) {
-            continue;
+    bool Compose(const CompositorFrame& frame, const CompositorWarp& warp) override {
+        if (!g_renderingActive) {
+            return false;
         }
         
-        switch (layer->type) {
-            case XR_TYPE_COMPOSITION_LAYER_PROJECTION: {
-                const XrCompositionLayerProjection* projLayer = 
-                    reinterpret_cast<const XrCompositionLayerProjection*>(layer);
-                
-                // Validate layer
-                if (!projLayer->views || projLayer->viewCount == 0) {
-                    LOGW("Invalid projection layer: no views");
-                    continue;
-                }
-                
-                // Process each view (eye)
-                for (uint32_t viewIdx = 0; viewIdx < projLayer->viewCount && viewIdx < 2; ++viewIdx) {
-                    const XrCompositionLayerProjectionView* view = &projLayer->views[viewIdx];
-                    
-                    // Get FOV for this eye
-                    XrFovf fov = view->fov;
-                    
-                    // Calculate time warp matrix
-                    float warpMatrix[16];
-                    CalculateTimeWarpMatrix(g_currentHeadPose, displayPose, fov, warpMatrix);
-                    
-                    // In a real implementation, we would:
-                    // 1. Submit the swapchain image to the compositor
-                    // 2. Apply time warp using the calculated matrix
-                    // 3. Apply lens distortion correction
-                    // 4. Render to the display
-                    
-                    LOGI("Submitting layer %u, view %u: image=%llu, pose=(%.3f,%.3f,%.3f)",
-                         i, viewIdx, 
-                         reinterpret_cast<uint64_t>(view->subImage.swapchain),
-                         view->pose.position.x, view->pose.position.y, view->pose.position.z);
-                }
-                break;
-            }
+        for (uint32_t i = 0; i < frame.layerCount; ++i) {
+            const CompositorLayer& layer = frame.layers[i];
             
-            case XR_TYPE_COMPOSITION_LAYER_QUAD: {
-                const XrCompositionLayerQuad* quadLayer = 
-                    reinterpret_cast<const XrCompositionLayerQuad*>(layer);
+            switch (layer.type) {
+                case XR_TYPE_COMPOSITION_LAYER_PROJECTION:
+                    // Projection views are reprojected with warp.matrix
+                    for (uint32_t viewIdx = 0; viewIdx < layer.viewCount; ++viewIdx) {
+                        const CompositorView& view = layer.views[viewIdx];
+                        TRACEV(TRACE_COMPOSE_PROJECTION_VIEW, i, viewIdx, view.swapchain,
+                               view.pose.position.x, view.pose.position.y, view.pose.position.z);
+                    }
+                    break;
+                
+                case XR_TYPE_COMPOSITION_LAYER_QUAD:
+                    // Quad layers don't need time warp (they're head-locked)
+                    TRACEV(TRACE_COMPOSE_QUAD, i, layer.views[0].swapchain);
+                    break;
                 
-                // Quad layers don't need time warp (they're head-locked)
-                LOGI("Submitting quad layer %u: image=%llu", i,
-                     reinterpret_cast<uint64_t>(quadLayer->subImage.swapchain));
-                break;
+                default:
+                    break;
             }
-            
-            default:
-                LOGW("Unsupported layer type: %u", layer->type);
-                break;
         }
+        
+        TRACED(TRACE_COMPOSE_FRAME, frame.frameId, frame.layerCount, warp.reused);
+        return true;
     }
-    
-    // In a real implementation, we would:
-    // - Submit all layers to the compositor
-    // - Trigger VSYNC
-    // - Apply asynchronous time warp just before display refresh
-    
-    LOGI("Submitted %u layers to compositor", layerCount);
-    return true;
+};
+
+static XR2CompositorBackend g_xr2CompositorBackend;
+
+CompositorBackend* GetXR2CompositorBackend() {
+    return &g_xr2CompositorBackend;
 }
 
 // Controller state
@@ -1114,9 +1049,6 @@ struct ControllerState {
     XrVector2f analog2D[4];
     XrPosef pose;
     uint64_t timestamp;
-    uint32_t lastButtonState;
-    float lastAnalog1D[8];
-    XrVector2f lastAnalog2D[4];
     int controllerHandle;  // QVR controller handle
 };
 
@@ -1124,6 +1056,15 @@ static ControllerState g_controllers[2] = {};
 static bool g_controllersInitialized = false;
 static std::mutex g_controllerMutex;
 
+// Input sampling thread: one SPSC ring per controller, consumed by xrSyncActions
+static const uint32_t INPUT_SAMPLE_RING_SIZE = 256;  // ~256 ms at 1 kHz
+static SpscRing<XR2ControllerInput, INPUT_SAMPLE_RING_SIZE> g_inputSampleRings[2];
+static std::mutex g_inputSamplingMutex;
+static std::thread g_inputSamplingThread;
+static std::atomic<bool> g_inputSamplingRunning(false);
+static uint32_t g_inputSampleRateHz = XR2_DEFAULT_INPUT_SAMPLE_RATE_HZ;
+static std::atomic<uint64_t> g_inputSamplesDropped(0);
+
 // Initialize controllers
 static bool InitializeControllers() {
     std::lock_guard<std::mutex> lock(g_controllerMutex);
@@ -1145,12 +1086,9 @@ static bool InitializeControllers() {
         g_controllers[i].connected = false;
         g_controllers[i].buttonState = 0;
         g_controllers[i].timestamp = 0;
-        g_controllers[i].lastButtonState = 0;
         g_controllers[i].controllerHandle = -1;
         memset(g_controllers[i].analog1D, 0, sizeof(g_controllers[i].analog1D));
         memset(g_controllers[i].analog2D, 0, sizeof(g_controllers[i].analog2D));
-        memset(g_controllers[i].lastAnalog1D, 0, sizeof(g_controllers[i].lastAnalog1D));
-        memset(g_controllers[i].lastAnalog2D, 0, sizeof(g_controllers[i].lastAnalog2D));
         g_controllers[i].pose = XrPosef{{0, 0, 0, 1}, {0, 0, 0}};
     }
     
@@ -1170,63 +1108,47 @@ static bool InitializeControllers() {
     return true;
 }
 
-// Get controller index from subaction path (0 = left, 1 = right)
-static uint32_t GetControllerIndex(XrPath subactionPath) {
-    if (subactionPath == XR_NULL_PATH) {
-        return 0; // Default to left if no subaction specified
-    }
-    
-    // Parse subaction path: /user/hand/{left|right}
-    // Use ParseInputPath helper but with a simplified path
-    // For subaction paths, we can check if it's a hand path
-    
-    // Try to get path string
-    XrInstance instance = GetCurrentInstance();
-    if (instance != XR_NULL_HANDLE) {
-        std::string pathString = GetPathString(instance, subactionPath);
-        
-        if (!pathString.empty()) {
-            // Check if path contains "right"
-            if (pathString.find("/right") != std::string::npos || 
-                pathString.find("right") != std::string::npos) {
-                return 1; // Right controller
-            } else if (pathString.find("/left") != std::string::npos || 
-                      pathString.find("left") != std::string::npos) {
-                return 0; // Left controller
-            }
-        }
-    }
-    
-    // Default to left (0)
-    return 0;
+static uint8_t ParseInputComponent(const std::string& component) {
+    if (component == "click") {
+        return INPUT_COMPONENT_CLICK;
+    } else if (component == "touch") {
+        return INPUT_COMPONENT_TOUCH;
+    } else if (component == "force") {
+        return INPUT_COMPONENT_FORCE;
+    } else if (component == "x") {
+        return INPUT_COMPONENT_X;
+    } else if (component == "y") {
+        return INPUT_COMPONENT_Y;
+    } else if (component == "pose") {
+        return INPUT_COMPONENT_POSE;
+    }
+    return INPUT_COMPONENT_VALUE;
 }
 
 // Map input type and component to controller input index
-static uint32_t MapInputToControllerIndex(const std::string& inputType, const std::string& component) {
+static uint8_t MapInputToControllerIndex(const std::string& inputType, uint8_t component) {
     // Map OpenXR input paths to controller input indices
     // This maps to sxrControllerState structure indices
     
-    if (inputType == "trigger" && component == "value") {
-        return 0; // PrimaryIndexTrigger
-    } else if (inputType == "trigger" && component == "click") {
-        return 0; // Same as value for boolean
-    } else if (inputType == "squeeze" && component == "value") {
+    if (inputType == "trigger") {
+        return 0; // PrimaryIndexTrigger (value and click)
+    } else if (inputType == "squeeze" && component == INPUT_COMPONENT_VALUE) {
         return 2; // PrimaryHandTrigger
-    } else if (inputType == "thumbstick" && component == "x") {
-        return 0; // PrimaryThumbstick X
-    } else if (inputType == "thumbstick" && component == "y") {
-        return 0; // PrimaryThumbstick Y
-    } else if (inputType == "trackpad" && component == "x") {
-        return 0; // Trackpad X
-    } else if (inputType == "trackpad" && component == "y") {
-        return 0; // Trackpad Y
     }
     
-    return 0; // Default
+    return 0; // Default (thumbstick/trackpad axes read analog2D)
+}
+
+// Map input type to 2D analog index
+static uint8_t MapInputToAnalog2DIndex(const std::string& inputType) {
+    if (inputType == "trackpad") {
+        return 1; // Trackpad
+    }
+    return 0; // PrimaryThumbstick
 }
 
 // Map input type to button bitmask
-static uint32_t MapInputToButtonBit(const std::string& inputType, const std::string& component) {
+static uint32_t MapInputToButtonBit(const std::string& inputType, uint8_t component) {
     // Map to sxrControllerButton enum values
     if (inputType == "a" || inputType == "button_a") {
         return 0x00000001; // Button One
@@ -1236,72 +1158,36 @@ static uint32_t MapInputToButtonBit(const std::string& inputType, const std::str
         return 0x00000004; // Button Three
     } else if (inputType == "y" || inputType == "button_y") {
         return 0x00000008; // Button Four
-    } else if (inputType == "thumbstick" && component == "click") {
+    } else if (inputType == "thumbstick" && component == INPUT_COMPONENT_CLICK) {
         return 0x00010000; // Thumbstick click
-    } else if (inputType == "trackpad" && component == "click") {
+    } else if (inputType == "trackpad" && component == INPUT_COMPONENT_CLICK) {
         return 0x00020000; // Trackpad click
-    } else if (inputType == "trigger" && component == "click") {
+    } else if (inputType == "trigger" && component == INPUT_COMPONENT_CLICK) {
         return 0x00040000; // Trigger click
-    } else if (inputType == "squeeze" && component == "click") {
+    } else if (inputType == "squeeze" && component == INPUT_COMPONENT_CLICK) {
         return 0x00080000; // Squeeze click
     }
     
     return 0;
 }
 
-bool GetXR2BooleanInput(XrAction action, XrPath subactionPath, bool* state, bool* changed) {
-    if (!state || !changed) {
-        return false;
-    }
-    
-    if (!g_controllersInitialized) {
-        InitializeControllers();
-    }
-    
-    std::lock_guard<std::mutex> lock(g_controllerMutex);
-    
-    // Get binding path for this action
-    XrPath bindingPath = GetActionBindingPath(action);
-    
-    uint32_t controllerIdx = 0;
-    uint32_t buttonBit = 0;
-    
-    if (bindingPath != XR_NULL_PATH) {
-        // Parse binding path to get controller and input info
-        ParsedInputPath parsed = ParseInputPath(bindingPath);
-        if (parsed.valid) {
-            controllerIdx = parsed.controllerIndex;
-            buttonBit = MapInputToButtonBit(parsed.inputType, parsed.component);
-        } else {
-            // Fallback to subaction path
-            controllerIdx = GetControllerIndex(subactionPath);
-        }
-    } else {
-        // No binding, use subaction path
-        controllerIdx = GetControllerIndex(subactionPath);
-    }
-    
-    if (controllerIdx >= 2) {
+bool CompileXR2InputBinding(const ParsedInputPath& parsed, InputBindingDesc* binding) {
+    if (!binding || !parsed.valid || parsed.controllerIndex >= 2) {
         return false;
     }
     
-    ControllerState& controller = g_controllers[controllerIdx];
-    
-    // Read button state
-    if (buttonBit != 0) {
-        *state = (controller.buttonState & buttonBit) != 0;
-        *changed = ((controller.buttonState ^ controller.lastButtonState) & buttonBit) != 0;
-    } else {
-        // Default: check if any button is pressed
-        *state = (controller.buttonState != 0);
-        *changed = (controller.buttonState != controller.lastButtonState);
-    }
+    uint8_t component = ParseInputComponent(parsed.component);
     
+    binding->controllerIndex = static_cast<uint8_t>(parsed.controllerIndex);
+    binding->component = component;
+    binding->analog1DIndex = MapInputToControllerIndex(parsed.inputType, component);
+    binding->analog2DIndex = MapInputToAnalog2DIndex(parsed.inputType);
+    binding->buttonBit = MapInputToButtonBit(parsed.inputType, component);
     return true;
 }
 
-bool GetXR2FloatInput(XrAction action, XrPath subactionPath, float* state, bool* changed) {
-    if (!state || !changed) {
+bool GetXR2ControllerInputs(XR2ControllerInput* inputs, uint32_t count) {
+    if (!inputs || count == 0) {
         return false;
     }
     
@@ -1309,120 +1195,48 @@ bool GetXR2FloatInput(XrAction action, XrPath subactionPath, float* state, bool*
         InitializeControllers();
     }
     
+    // Copy out once per sync so evaluating bindings needs no lock
     std::lock_guard<std::mutex> lock(g_controllerMutex);
     
-    // Get binding path for this action
-    XrPath bindingPath = GetActionBindingPath(action);
-    
-    uint32_t controllerIdx = 0;
-    uint32_t analogIndex = 0;
-    
-    if (bindingPath != XR_NULL_PATH) {
-        ParsedInputPath parsed = ParseInputPath(bindingPath);
-        if (parsed.valid) {
-            controllerIdx = parsed.controllerIndex;
-            analogIndex = MapInputToControllerIndex(parsed.inputType, parsed.component);
-        } else {
-            controllerIdx = GetControllerIndex(subactionPath);
-        }
-    } else {
-        controllerIdx = GetControllerIndex(subactionPath);
-    }
-    
-    if (controllerIdx >= 2) {
-        return false;
-    }
-    
-    ControllerState& controller = g_controllers[controllerIdx];
-    
-    // Read analog input (trigger, squeeze, etc.)
-    if (analogIndex < 8) {
-        *state = controller.analog1D[analogIndex];
-        *changed = (controller.analog1D[analogIndex] != controller.lastAnalog1D[analogIndex]);
-    } else {
-        *state = 0.0f;
-        *changed = false;
+    for (uint32_t i = 0; i < count && i < 2; ++i) {
+        const ControllerState& controller = g_controllers[i];
+        inputs[i].timestamp = static_cast<XrTime>(controller.timestamp);
+        inputs[i].connected = controller.connected;
+        inputs[i].buttonState = controller.buttonState;
+        memcpy(inputs[i].analog1D, controller.analog1D, sizeof(inputs[i].analog1D));
+        memcpy(inputs[i].analog2D, controller.analog2D, sizeof(inputs[i].analog2D));
     }
     
     return true;
 }
 
-bool GetXR2Vector2fInput(XrAction action, XrPath subactionPath, XrVector2f* state, bool* changed) {
-    if (!state || !changed) {
-        return false;
-    }
-    
-    if (!g_controllersInitialized) {
-        InitializeControllers();
-    }
-    
-    std::lock_guard<std::mutex> lock(g_controllerMutex);
-    
-    // Get binding path for this action
-    XrPath bindingPath = GetActionBindingPath(action);
-    
-    uint32_t controllerIdx = 0;
-    uint32_t analog2DIndex = 0;
-    
-    if (bindingPath != XR_NULL_PATH) {
-        ParsedInputPath parsed = ParseInputPath(bindingPath);
-        if (parsed.valid) {
-            controllerIdx = parsed.controllerIndex;
-            // Map thumbstick/trackpad to analog2D index
-            if (parsed.inputType == "thumbstick") {
-                analog2DIndex = 0; // PrimaryThumbstick
-            } else if (parsed.inputType == "trackpad") {
-                analog2DIndex = 1; // Trackpad
-            }
-        } else {
-            controllerIdx = GetControllerIndex(subactionPath);
-        }
-    } else {
-        controllerIdx = GetControllerIndex(subactionPath);
+bool GetXR2BooleanInput(const XR2ControllerInput& input, const InputBindingDesc& binding) {
+    if (binding.buttonBit != 0) {
+        return (input.buttonState & binding.buttonBit) != 0;
     }
     
-    if (controllerIdx >= 2) {
-        return false;
-    }
-    
-    ControllerState& controller = g_controllers[controllerIdx];
-    
-    // Read 2D analog input (thumbstick, trackpad)
-    if (analog2DIndex < 4) {
-        *state = controller.analog2D[analog2DIndex];
-        *changed = (controller.analog2D[analog2DIndex].x != controller.lastAnalog2D[analog2DIndex].x ||
-                   controller.analog2D[analog2DIndex].y != controller.lastAnalog2D[analog2DIndex].y);
-    } else {
-        *state = {0.0f, 0.0f};
-        *changed = false;
-    }
-    
-    return true;
+    // Default: check if any button is pressed
+    return input.buttonState != 0;
 }
 
-bool GetXR2PoseInput(XrAction action, XrPath subactionPath, bool* isActive) {
-    if (!isActive) {
-        return false;
-    }
-    
-    if (!g_controllersInitialized) {
-        InitializeControllers();
+float GetXR2FloatInput(const XR2ControllerInput& input, const InputBindingDesc& binding) {
+    // Single axis of a thumbstick/trackpad
+    if (binding.component == INPUT_COMPONENT_X) {
+        return input.analog2D[binding.analog2DIndex].x;
+    } else if (binding.component == INPUT_COMPONENT_Y) {
+        return input.analog2D[binding.analog2DIndex].y;
     }
     
-    std::lock_guard<std::mutex> lock(g_controllerMutex);
-    
-    uint32_t controllerIdx = GetControllerIndex(subactionPath);
-    if (controllerIdx >= 2) {
-        return false;
-    }
-    
-    ControllerState& controller = g_controllers[controllerIdx];
-    *isActive = controller.connected;
-    
-    return true;
+    // Analog input (trigger, squeeze, etc.)
+    return input.analog1D[binding.analog1DIndex];
+}
+
+XrVector2f GetXR2Vector2fInput(const XR2ControllerInput& input, const InputBindingDesc& binding) {
+    // 2D analog input (thumbstick, trackpad)
+    return input.analog2D[binding.analog2DIndex];
 }
 
-bool GetXR2ActionPose(XrAction action, XrPath subactionPath, XrTime time, 
+bool GetXR2ActionPose(uint32_t controllerIdx, XrTime time, 
                       XrPosef* pose, XrSpaceLocationFlags* locationFlags) {
     if (!pose || !locationFlags) {
         return false;
@@ -1434,7 +1248,6 @@ bool GetXR2ActionPose(XrAction action, XrPath subactionPath, XrTime time,
     
     std::lock_guard<std::mutex> lock(g_controllerMutex);
     
-    uint32_t controllerIdx = GetControllerIndex(subactionPath);
     if (controllerIdx >= 2) {
         return false;
     }
@@ -1470,7 +1283,10 @@ bool GetXR2CurrentInteractionProfile(XrPath topLevelUserPath, XrPath* interactio
     return false;
 }
 
-bool SyncXR2InputActions() {
+// Refresh controller state from the QVR controller source and copy it out.
+// Called at the sampling rate by the input thread, or from xrSyncActions
+// when no input thread is running.
+static bool PollXR2Controllers(XR2ControllerInput* inputs) {
     if (!g_controllersInitialized) {
         InitializeControllers();
     }
@@ -1482,49 +1298,145 @@ bool SyncXR2InputActions() {
         return false;
     }
     
+    XrTime now = GetXR2CurrentTime();
+    
     // Update controller states from QVR API
     for (int i = 0; i < 2; ++i) {
         ControllerState& controller = g_controllers[i];
         
-        if (!controller.connected || controller.controllerHandle < 0) {
-            continue;
-        }
-        
-        // Save previous state for change detection
-        controller.lastButtonState = controller.buttonState;
-        memcpy(controller.lastAnalog1D, controller.analog1D, sizeof(controller.lastAnalog1D));
-        memcpy(controller.lastAnalog2D, controller.analog2D, sizeof(controller.lastAnalog2D));
-        
-        // Get controller state from QVR
-        // Note: QVR controller API may use different structure
-        // For now, we'll use a simplified approach that queries controller state
-        // In a full implementation, we'd use QVRServiceClient_GetControllerStateWrapper
-        
-        // Check if controller is still connected by querying its state
-        // This is a placeholder - actual implementation would read full controller state
-        // For now, we'll assume controller remains connected if handle is valid
-        if (controller.controllerHandle >= 0) {
+        if (controller.connected && controller.controllerHandle >= 0) {
+            // Get controller state from QVR
+            // Note: QVR controller API may use different structure
+            // For now, we'll use a simplified approach that queries controller state
+            // In a full implementation, we'd use QVRServiceClient_GetControllerStateWrapper
+            
+            // Check if controller is still connected by querying its state
+            // This is a placeholder - actual implementation would read full controller state
+            // For now, we'll assume controller remains connected if handle is valid
             controller.connected = true;
             // TODO: Read actual controller state from QVR API when available
             // The controller state structure depends on QVR SDK version
             // For now, state remains unchanged (will be updated when API is integrated)
-        } else {
-            controller.connected = false;
+        }
+        
+        controller.timestamp = static_cast<uint64_t>(now);
+        
+        if (inputs) {
+            inputs[i].timestamp = now;
+            inputs[i].connected = controller.connected;
+            inputs[i].buttonState = controller.buttonState;
+            memcpy(inputs[i].analog1D, controller.analog1D, sizeof(inputs[i].analog1D));
+            memcpy(inputs[i].analog2D, controller.analog2D, sizeof(inputs[i].analog2D));
         }
     }
     
     return true;
 }
 
-bool TriggerXR2HapticFeedback(XrAction action, XrPath subactionPath, 
-                              float amplitude, XrDuration duration) {
+bool SyncXR2InputActions() {
+    // The input thread keeps controller state fresh while it runs
+    if (g_inputSamplingRunning.load(std::memory_order_acquire)) {
+        return true;
+    }
+    
+    return PollXR2Controllers(nullptr);
+}
+
+static void InputSamplingThreadMain() {
+    LOGI("Input sampling thread started at %u Hz", g_inputSampleRateHz);
+    
+    auto period = std::chrono::nanoseconds(1000000000LL / g_inputSampleRateHz);
+    auto next = std::chrono::steady_clock::now();
+    
+    while (g_inputSamplingRunning.load(std::memory_order_acquire)) {
+        XR2ControllerInput inputs[2];
+        if (PollXR2Controllers(inputs)) {
+            for (uint32_t i = 0; i < 2; ++i) {
+                if (!g_inputSampleRings[i].Push(inputs[i])) {
+                    // App is not syncing; the newest state is still read at sync time
+                    g_inputSamplesDropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            next = now; // Fell behind (thread was descheduled); don't burst to catch up
+        }
+        std::this_thread::sleep_until(next);
+    }
+    
+    LOGI("Input sampling thread stopped (%llu samples dropped)", 
+         static_cast<unsigned long long>(g_inputSamplesDropped.load()));
+}
+
+bool StartXR2InputSampling(uint32_t rateHz) {
+    std::lock_guard<std::mutex> lock(g_inputSamplingMutex);
+    
+    if (g_inputSamplingRunning.load()) {
+        return true;
+    }
+    
+    if (rateHz < XR2_MIN_INPUT_SAMPLE_RATE_HZ) {
+        rateHz = XR2_MIN_INPUT_SAMPLE_RATE_HZ;
+    } else if (rateHz > XR2_MAX_INPUT_SAMPLE_RATE_HZ) {
+        rateHz = XR2_MAX_INPUT_SAMPLE_RATE_HZ;
+    }
+    g_inputSampleRateHz = rateHz;
+    g_inputSamplesDropped.store(0);
+    
+    // Stale samples from a previous run must not be folded into the next sync
+    for (auto& ring : g_inputSampleRings) {
+        ring.Clear();
+    }
+    
+    g_inputSamplingRunning.store(true, std::memory_order_release);
+    g_inputSamplingThread = std::thread(InputSamplingThreadMain);
+    return true;
+}
+
+void StopXR2InputSampling() {
+    std::lock_guard<std::mutex> lock(g_inputSamplingMutex);
+    
+    if (!g_inputSamplingRunning.exchange(false)) {
+        return;
+    }
+    
+    if (g_inputSamplingThread.joinable()) {
+        g_inputSamplingThread.join();
+    }
+}
+
+uint32_t DrainXR2InputSamples(uint32_t controllerIndex, XR2ControllerInput* samples, uint32_t maxSamples) {
+    if (controllerIndex >= 2 || !samples) {
+        return 0;
+    }
+    
+    auto& ring = g_inputSampleRings[controllerIndex];
+    
+    // Keep only the most recent samples if the app fell far behind
+    XR2ControllerInput discarded;
+    uint32_t queued = ring.Size();
+    while (queued > maxSamples && ring.Pop(&discarded)) {
+        queued--;
+    }
+    
+    uint32_t count = 0;
+    while (count < maxSamples && ring.Pop(&samples[count])) {
+        count++;
+    }
+    
+    return count;
+}
+
+bool TriggerXR2HapticFeedback(uint32_t controllerIdx, float amplitude, XrDuration duration) {
     if (!g_controllersInitialized) {
         InitializeControllers();
     }
     
     std::lock_guard<std::mutex> lock(g_controllerMutex);
     
-    uint32_t controllerIdx = GetControllerIndex(subactionPath);
     if (controllerIdx >= 2) {
         return false;
     }
@@ -1545,9 +1457,12 @@ bool TriggerXR2HapticFeedback(XrAction action, XrPath subactionPath,
     return true;
 }
 
-bool SetXR2PerformanceLevel(uint32_t level) {
-    if (level > XR2_MAX_PERF_LEVEL) {
-        level = XR2_MAX_PERF_LEVEL;
+bool SetXR2OperatingLevels(uint32_t cpuLevel, uint32_t gpuLevel) {
+    if (cpuLevel > XR2_MAX_PERF_LEVEL) {
+        cpuLevel = XR2_MAX_PERF_LEVEL;
+    }
+    if (gpuLevel > XR2_MAX_PERF_LEVEL) {
+        gpuLevel = XR2_MAX_PERF_LEVEL;
     }
     
     QVRServiceClientHandle qvrClient = GetQVRClient();
@@ -1555,12 +1470,12 @@ bool SetXR2PerformanceLevel(uint32_t level) {
         return false;
     }
     
-    // Map performance level to QVR performance levels
+    // Map performance levels 0-2 to QVR PERF_LEVEL_1-3
     qvrservice_perf_level_t perfLevels[2];
     perfLevels[0].hw_type = HW_TYPE_CPU;
-    perfLevels[0].perf_level = (QVRSERVICE_PERF_LEVEL)(level + 1); // Map 0-3 to PERF_LEVEL_1-3
+    perfLevels[0].perf_level = (QVRSERVICE_PERF_LEVEL)(cpuLevel + 1);
     perfLevels[1].hw_type = HW_TYPE_GPU;
-    perfLevels[1].perf_level = (QVRSERVICE_PERF_LEVEL)(level + 1); // Map 0-3 to PERF_LEVEL_1-3
+    perfLevels[1].perf_level = (QVRSERVICE_PERF_LEVEL)(gpuLevel + 1);
     
     int result = QVRServiceClient_SetOperatingLevelWrapper(qvrClient, perfLevels, 2);
     if (result != QVR_SUCCESS) {
@@ -1568,11 +1483,14 @@ bool SetXR2PerformanceLevel(uint32_t level) {
         return false;
     }
     
-    g_currentPerfLevel = level;
-    LOGI("Set performance level to %u (CPU=%u, GPU=%u)", level, level, level);
+    LOGI("Set performance level CPU=%u, GPU=%u", cpuLevel, gpuLevel);
     return true;
 }
 
+bool SetXR2PerformanceLevel(uint32_t level) {
+    return SetXR2OperatingLevels(level, level);
+}
+
 bool EnableXR2PowerOptimization(bool enable) {
     g_powerOptimizationEnabled = enable;
     
@@ -3,7 +3,9 @@
 
 #include <openxr/openxr.h>
 #include <openxr/openxr_platform.h>
-#include "qvr_api_wrapper.h"
+#include "pose_predictor.h"
+#include "platform/input_manager.h"
+#include "platform/compositor.h"
 
 // Custom structure for XR2 graphics properties
 // Note: This is not part of standard OpenXR, but used internally for XR2 platform
@@ -26,6 +28,26 @@ bool GetXR2GraphicsProperties(XrGraphicsPropertiesOpenGLESKHR* properties);
 bool GetXR2TrackingProperties(XrSystemTrackingProperties* properties);
 bool GetXR2ViewFOV(XrFovf* leftEyeFov, XrFovf* rightEyeFov);
 bool GetXR2EyeOffsets(XrVector3f* leftEyeOffset, XrVector3f* rightEyeOffset);
+
+// Per-eye projection data derived from the FOV: tangents of the FOV angles
+// and the mapping from tangent space to NDC (ndc = tan * scale + offset)
+struct XR2EyeProjection {
+    float tanLeft, tanRight, tanUp, tanDown;
+    float scaleX, scaleY;
+    float offsetX, offsetY;
+};
+
+// Eye calibration, index 0 = left, 1 = right
+struct XR2EyeCalibration {
+    XrFovf fov[2];
+    XrVector3f eyeOffset[2];
+    XR2EyeProjection projection[2];
+};
+
+// Re-query FOV and eye offsets from QVR. Called at session start and
+// whenever the IPD or display calibration changes; reads use the cache.
+bool RefreshXR2EyeCalibration();
+bool GetXR2EyeCalibration(XR2EyeCalibration* calibration);
 bool StartXR2Rendering();
 void StopXR2Rendering();
 
@@ -37,6 +59,7 @@ bool GetXR2ViewPoses(XrTime time, XrSpace space, XrView* views, uint32_t count,
 bool LocateXR2ReferenceSpace(XrReferenceSpaceType space, XrReferenceSpaceType baseSpace,
                              XrTime time, XrPosef* pose, XrSpaceLocationFlags* locationFlags);
 bool GetXR2StageBounds(XrExtent2Df* bounds);
+void SetXR2PosePredictionModel(PosePredictionModel model);
 
 // Hand tracking
 bool InitializeXR2HandTracking();
@@ -50,29 +73,58 @@ void ShutdownXR2EyeTracking();
 bool GetXR2EyeGaze(XrTime time, XrVector3f* gazeOrigin, XrVector3f* gazeDirection);
 
 // Frame management
-bool WaitForXR2NextFrame(XrTime* predictedDisplayTime, XrDuration* predictedDisplayPeriod);
+bool GetXR2VsyncTiming(XrTime* lastVsyncTime, XrDuration* nominalPeriod);
+// Route display vsync interrupts to PublishVsync (false if unsupported)
+bool SetXR2VsyncCallback(bool enable);
+// Called once per frame with the display time handed to the app
+void ScheduleXR2Frame(XrTime predictedDisplayTime);
 bool BeginXR2FrameRendering();
 bool EndXR2FrameRendering();
-bool SubmitXR2FrameLayers(const XrCompositionLayerBaseHeader* const* layers, uint32_t layerCount);
+// Compositor backend drawing to the XR2 display
+CompositorBackend* GetXR2CompositorBackend();
+
+// Raw controller input sample
+struct XR2ControllerInput {
+    XrTime timestamp;  // When the sample was taken
+    bool connected;
+    uint32_t buttonState;
+    float analog1D[8];
+    XrVector2f analog2D[4];
+};
 
 // Input
-bool GetXR2BooleanInput(XrAction action, XrPath subactionPath, bool* state, bool* changed);
-bool GetXR2FloatInput(XrAction action, XrPath subactionPath, float* state, bool* changed);
-bool GetXR2Vector2fInput(XrAction action, XrPath subactionPath, XrVector2f* state, bool* changed);
-bool GetXR2PoseInput(XrAction action, XrPath subactionPath, bool* isActive);
-bool GetXR2ActionPose(XrAction action, XrPath subactionPath, XrTime time, 
+bool CompileXR2InputBinding(const ParsedInputPath& parsed, InputBindingDesc* binding);
+bool GetXR2ControllerInputs(XR2ControllerInput* inputs, uint32_t count);
+
+// Frames between xrWaitFrame and display at once (frame ring depth limit)
+static const uint32_t XR2_MAX_FRAMES_IN_FLIGHT = 3;
+
+// Input sampling thread (polls controllers between frames)
+static const uint32_t XR2_MIN_INPUT_SAMPLE_RATE_HZ = 500;
+static const uint32_t XR2_MAX_INPUT_SAMPLE_RATE_HZ = 1000;
+static const uint32_t XR2_DEFAULT_INPUT_SAMPLE_RATE_HZ = 1000;
+bool StartXR2InputSampling(uint32_t rateHz);
+void StopXR2InputSampling();
+// Pop queued samples for one controller, oldest first; single consumer
+uint32_t DrainXR2InputSamples(uint32_t controllerIndex, XR2ControllerInput* samples, uint32_t maxSamples);
+bool GetXR2BooleanInput(const XR2ControllerInput& input, const InputBindingDesc& binding);
+float GetXR2FloatInput(const XR2ControllerInput& input, const InputBindingDesc& binding);
+XrVector2f GetXR2Vector2fInput(const XR2ControllerInput& input, const InputBindingDesc& binding);
+bool GetXR2ActionPose(uint32_t controllerIndex, XrTime time, 
                       XrPosef* pose, XrSpaceLocationFlags* locationFlags);
 bool GetXR2CurrentInteractionProfile(XrPath topLevelUserPath, XrPath* interactionProfile);
 bool SyncXR2InputActions();
 
 // Haptic feedback
-bool TriggerXR2HapticFeedback(XrAction action, XrPath subactionPath, 
-                              float amplitude, XrDuration duration);
+bool TriggerXR2HapticFeedback(uint32_t controllerIndex, float amplitude, XrDuration duration);
 
 // Time
 XrTime GetXR2CurrentTime();
 
-// Power management
+// Power management. Levels 0 (balanced) to XR2_MAX_PERF_LEVEL; these make a
+// blocking QVR call, so call them from the performance governor thread.
+static const uint32_t XR2_MAX_PERF_LEVEL = 2;
+bool SetXR2OperatingLevels(uint32_t cpuLevel, uint32_t gpuLevel);
 bool SetXR2PerformanceLevel(uint32_t level);
 bool EnableXR2PowerOptimization(bool enable);
 
@@ -0,0 +1,50 @@
+#include "frame_arena.h"
+#include "memory_manager.h"
+
+// Alignment of the backing block, enough for any SIMD type
+static const size_t FRAME_ARENA_BLOCK_ALIGNMENT = 64;
+
+FrameArena::FrameArena() : base_(nullptr), capacity_(0), used_(0) {
+}
+
+FrameArena::~FrameArena() {
+    Release();
+}
+
+bool FrameArena::Initialize(size_t capacity) {
+    if (base_) {
+        return capacity <= capacity_;
+    }
+
+    base_ = static_cast<uint8_t*>(AllocateAligned(capacity, FRAME_ARENA_BLOCK_ALIGNMENT));
+    if (!base_) {
+        return false;
+    }
+
+    capacity_ = capacity;
+    used_ = 0;
+    return true;
+}
+
+void FrameArena::Release() {
+    if (base_) {
+        FreeAligned(base_);
+    }
+    base_ = nullptr;
+    capacity_ = 0;
+    used_ = 0;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+    if (!base_ || alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        return nullptr;
+    }
+
+    size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+    if (offset > capacity_ || size > capacity_ - offset) {
+        return nullptr;
+    }
+
+    used_ = offset + size;
+    return base_ + offset;
+}
@@ -0,0 +1,42 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Bump allocator for per-frame data. The block is allocated once; Allocate
+// only advances an offset and Reset frees everything at once, so a frame
+// loop that recycles arenas does no heap allocation. Not thread-safe: one
+// owner at a time.
+class FrameArena {
+public:
+    FrameArena();
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Allocate the backing block (once); false on failure
+    bool Initialize(size_t capacity);
+    void Release();
+
+    // nullptr when the arena is full; memory is not zeroed
+    void* Allocate(size_t size, size_t alignment);
+
+    template <typename T>
+    T* AllocateArray(uint32_t count) {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void Reset() { used_ = 0; }
+
+    size_t Used() const { return used_; }
+    size_t Capacity() const { return capacity_; }
+
+private:
+    uint8_t* base_;
+    size_t capacity_;
+    size_t used_;
+};
+
+#endif // FRAME_ARENA_H
@@ -1,4 +1,321 @@
 #include "logger.h"
+#include "thread_ring_pool.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
-// Logger implementation is header-only
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
 
+static const uint32_t LOG_MAX_THREADS = 16;
+static const uint32_t LOG_THREAD_RING_SIZE = 128;
+static const uint32_t LOG_DRAIN_INTERVAL_MS = 50;
+
+static ThreadRingPool<LogRecord, LOG_THREAD_RING_SIZE, LOG_MAX_THREADS> g_logPool;
+static thread_local ThreadRingSlot t_logSlot;
+
+static std::atomic<uint64_t> g_logSuppressed(0);
+static uint64_t g_logReportedDrops = 0;  // Guarded by g_logMutex
+static std::atomic<bool> g_logAsync(false);  // Log thread running
+
+static std::mutex g_logMutex;  // Start/stop, the thread's sleep and backend writes
+static std::condition_variable g_logCondition;
+static std::thread g_logThread;
+static bool g_logRunning = false;
+
+#ifdef __ANDROID__
+static AndroidLogBackend g_defaultLogBackend;
+#else
+static StreamLogBackend g_defaultLogBackend(stderr);
+#endif
+static std::atomic<LogBackend*> g_logBackend(&g_defaultLogBackend);
+
+static int64_t LogNow() {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+}
+
+#ifdef __ANDROID__
+void AndroidLogBackend::Write(LogLevel level, int64_t /*timestamp*/, const char* tag, const char* message) {
+    static const int priorities[] = {
+        ANDROID_LOG_VERBOSE, ANDROID_LOG_DEBUG, ANDROID_LOG_INFO,
+        ANDROID_LOG_WARN, ANDROID_LOG_ERROR, ANDROID_LOG_FATAL
+    };
+    __android_log_write(priorities[level], tag, message);
+}
+#endif
+
+StreamLogBackend::StreamLogBackend(FILE* stream) : stream_(stream), owned_(false) {
+}
+
+StreamLogBackend::~StreamLogBackend() {
+    if (owned_ && stream_) {
+        fclose(stream_);
+    }
+}
+
+bool StreamLogBackend::Open(const char* path) {
+    FILE* file = path ? fopen(path, "a") : nullptr;
+    if (!file) {
+        return false;
+    }
+
+    if (owned_ && stream_) {
+        fclose(stream_);
+    }
+    stream_ = file;
+    owned_ = true;
+    return true;
+}
+
+void StreamLogBackend::Write(LogLevel level, int64_t timestamp, const char* tag, const char* message) {
+    static const char levels[] = {'V', 'D', 'I', 'W', 'E', 'F'};
+    if (!stream_) {
+        return;
+    }
+
+    long long micros = timestamp / 1000;
+    fprintf(stream_, "[%lld.%06lld] %c/%s: %s\n", micros / 1000000, micros % 1000000, levels[level],
+            tag, message);
+}
+
+void StreamLogBackend::Flush() {
+    if (stream_) {
+        fflush(stream_);
+    }
+}
+
+void SetLogBackend(LogBackend* backend) {
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    g_logBackend.store(backend ? backend : &g_defaultLogBackend, std::memory_order_release);
+}
+
+void LogWrite(LogLevel level, int64_t timestamp, const char* message) {
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    g_logBackend.load(std::memory_order_acquire)->Write(level, timestamp, LOG_TAG, message);
+}
+
+bool LogRateLimit(LogCallSite* site, uint32_t* suppressed) {
+    int64_t now = LogNow();
+
+    int64_t windowStart = site->windowStart.load(std::memory_order_relaxed);
+    if (now - windowStart >= LOG_RATE_LIMIT_WINDOW_NS &&
+        site->windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+        site->count.store(0, std::memory_order_relaxed);
+    }
+
+    if (site->count.fetch_add(1, std::memory_order_relaxed) >= LOG_RATE_LIMIT_BURST) {
+        site->suppressed.fetch_add(1, std::memory_order_relaxed);
+        g_logSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    *suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+// printf one conversion with the captured argument. The conversion is
+// rebuilt from the argument's captured type, so a mismatched format prints
+// the value instead of reading the wrong vararg.
+static int FormatLogArg(char* out, size_t size, const char* spec, size_t specLength, char conversion,
+                        const LogRecord& record, uint32_t arg) {
+    char format[32];
+    if (specLength > sizeof(format) - 4) {
+        specLength = sizeof(format) - 4;
+    }
+    memcpy(format, spec, specLength);  // '%', flags, width and precision
+
+    if (arg >= record.argCount) {
+        return snprintf(out, size, "?");
+    }
+
+    uint64_t value = record.args[arg];
+    switch (record.argTypes[arg]) {
+        case LOG_ARG_INT:
+        case LOG_ARG_UINT: {
+            bool isSigned = record.argTypes[arg] == LOG_ARG_INT;
+            if (conversion == 'c') {
+                memcpy(format + specLength, "c", 2);
+                return snprintf(out, size, format, static_cast<int>(value));
+            }
+            if (!strchr("diouxX", conversion)) {
+                conversion = isSigned ? 'd' : 'u';
+            }
+            memcpy(format + specLength, "ll", 2);
+            format[specLength + 2] = conversion;
+            format[specLength + 3] = '\0';
+            if (conversion == 'd' || conversion == 'i') {
+                return snprintf(out, size, format, static_cast<long long>(value));
+            }
+            return snprintf(out, size, format, static_cast<unsigned long long>(value));
+        }
+
+        case LOG_ARG_DOUBLE: {
+            double d;
+            memcpy(&d, &value, sizeof(d));
+            format[specLength] = strchr("fFeEgGaA", conversion) ? conversion : 'f';
+            format[specLength + 1] = '\0';
+            return snprintf(out, size, format, d);
+        }
+
+        case LOG_ARG_STRING:
+            memcpy(format + specLength, "s", 2);
+            return snprintf(out, size, format, record.strings + value);
+
+        default:
+            memcpy(format + specLength, "p", 2);
+            return snprintf(out, size, format, reinterpret_cast<void*>(static_cast<uintptr_t>(value)));
+    }
+}
+
+static void FormatLogRecord(const LogRecord& record, char* out, size_t size) {
+    size_t length = 0;
+    uint32_t arg = 0;
+
+    for (const char* p = record.format; *p && length + 1 < size;) {
+        if (*p != '%') {
+            out[length++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[length++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion
+        const char* spec = p++;
+        while (*p && strchr("-+ #0", *p)) {
+            ++p;
+        }
+        while (*p >= '0' && *p <= '9') {
+            ++p;
+        }
+        if (*p == '.') {
+            ++p;
+            while (*p >= '0' && *p <= '9') {
+                ++p;
+            }
+        }
+        size_t specLength = p - spec;
+        while (*p && strchr("hljztL", *p)) {
+            ++p;
+        }
+        if (!*p) {
+            break;
+        }
+
+        char conversion = *p++;
+        if (conversion == 'n') {
+            continue;
+        }
+        int written = FormatLogArg(out + length, size - length, spec, specLength, conversion, record, arg++);
+        if (written < 0) {
+            break;
+        }
+        length += static_cast<size_t>(written) < size - length ? written : size - length - 1;
+    }
+    out[length] = '\0';
+
+    if (record.suppressed > 0 && length + 1 < size) {
+        snprintf(out + length, size - length, " (%u suppressed)", record.suppressed);
+    }
+}
+
+static void WriteLogRecord(const LogRecord& record) {
+    char message[LOG_MAX_MESSAGE];
+    FormatLogRecord(record, message, sizeof(message));
+    g_logBackend.load(std::memory_order_acquire)->Write(static_cast<LogLevel>(record.level),
+                                                        record.timestamp, LOG_TAG, message);
+}
+
+void LogSubmit(LogRecord* record) {
+    record->timestamp = LogNow();
+
+    if (g_logAsync.load(std::memory_order_acquire) && record->level != LOG_LEVEL_FATAL &&
+        g_logPool.Push(&t_logSlot, *record)) {
+        return;
+    }
+
+    // No log thread yet, fatal, or this thread's ring is full: write it
+    // here so nothing is lost off the hot path
+    if (!g_logAsync.load(std::memory_order_acquire) || record->level >= LOG_LEVEL_ERROR) {
+        std::lock_guard<std::mutex> lock(g_logMutex);
+        WriteLogRecord(*record);
+        g_logBackend.load(std::memory_order_acquire)->Flush();
+    }
+}
+
+static void DrainLogRecords() {
+    std::lock_guard<std::mutex> lock(g_logMutex);
+
+    g_logPool.Drain([](const LogRecord& record) { WriteLogRecord(record); });
+
+    uint64_t droppedFull = 0, droppedNoRing = 0;
+    g_logPool.GetCounts(nullptr, &droppedFull, &droppedNoRing);
+    uint64_t drops = droppedFull + droppedNoRing;
+    if (drops > g_logReportedDrops) {
+        char message[64];
+        snprintf(message, sizeof(message), "%llu log messages dropped (queue full)",
+                 static_cast<unsigned long long>(drops - g_logReportedDrops));
+        g_logBackend.load(std::memory_order_acquire)->Write(LOG_LEVEL_WARN, LogNow(), LOG_TAG, message);
+        g_logReportedDrops = drops;
+    }
+    g_logBackend.load(std::memory_order_acquire)->Flush();
+}
+
+static void LogThreadMain() {
+    std::unique_lock<std::mutex> lock(g_logMutex);
+    while (g_logRunning) {
+        g_logCondition.wait_for(lock, std::chrono::milliseconds(LOG_DRAIN_INTERVAL_MS));
+
+        lock.unlock();
+        DrainLogRecords();
+        lock.lock();
+    }
+}
+
+bool StartLogThread() {
+    std::lock_guard<std::mutex> lock(g_logMutex);
+
+    if (g_logRunning) {
+        return true;
+    }
+
+    g_logRunning = true;
+    g_logThread = std::thread(LogThreadMain);
+    g_logAsync.store(true, std::memory_order_release);
+    return true;
+}
+
+void StopLogThread() {
+    {
+        std::lock_guard<std::mutex> lock(g_logMutex);
+        if (!g_logRunning) {
+            return;
+        }
+        g_logRunning = false;
+    }
+    g_logCondition.notify_all();
+
+    if (g_logThread.joinable()) {
+        g_logThread.join();
+    }
+
+    // Messages queued after the last drain
+    g_logAsync.store(false, std::memory_order_release);
+    DrainLogRecords();
+}
+
+void GetLogStats(LogStats* stats) {
+    if (!stats) {
+        return;
+    }
+
+    uint64_t droppedFull = 0, droppedNoRing = 0;
+    g_logPool.GetCounts(&stats->queued, &droppedFull, &droppedNoRing);
+    stats->dropped = droppedFull + droppedNoRing;
+    stats->suppressed = g_logSuppressed.load(std::memory_order_relaxed);
+}
@@ -1,16 +1,212 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#include <android/log.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
 
 #define LOG_TAG "XRRuntime"
 
-#define LOGV(...) __android_log_print(ANDROID_LOG_VERBOSE, LOG_TAG, __VA_ARGS__)
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGF(...) __android_log_print(ANDROID_LOG_FATAL, LOG_TAG, __VA_ARGS__)
+// Cold paths only; per-frame and per-sample events go through trace.h
+//
+// LOGx captures the format pointer and arguments into the calling thread's
+// ring without formatting; the log thread formats and writes them through
+// the current LogBackend. Before StartLogThread (and for LOGF) messages are
+// written synchronously. Each call site (except LOGF) is rate limited to
+// LOG_RATE_LIMIT_BURST messages per LOG_RATE_LIMIT_WINDOW_NS; the next
+// message let through reports how many were suppressed.
 
-#endif // LOGGER_H
+enum LogLevel {
+    LOG_LEVEL_VERBOSE,
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_FATAL
+};
+
+static const uint32_t LOG_MAX_ARGS = 12;
+static const uint32_t LOG_STRING_BYTES = 128;  // %s arguments, copied, truncated
+static const uint32_t LOG_MAX_MESSAGE = 512;
+static const uint32_t LOG_RATE_LIMIT_BURST = 10;
+static const int64_t LOG_RATE_LIMIT_WINDOW_NS = 1000000000LL;
+
+// Where formatted messages go. Write is called from one thread at a time
+// (the log thread, or the caller before it starts).
+class LogBackend {
+public:
+    virtual ~LogBackend() {}
+
+    // 'timestamp' is steady_clock ns at the LOGx call
+    virtual void Write(LogLevel level, int64_t timestamp, const char* tag, const char* message) = 0;
+    virtual void Flush() {}
+};
+
+#ifdef __ANDROID__
+// logcat
+class AndroidLogBackend : public LogBackend {
+public:
+    void Write(LogLevel level, int64_t timestamp, const char* tag, const char* message) override;
+};
+#endif
+
+// stderr or a file (Linux, host builds)
+class StreamLogBackend : public LogBackend {
+public:
+    explicit StreamLogBackend(FILE* stream);
+    ~StreamLogBackend() override;
+
+    StreamLogBackend(const StreamLogBackend&) = delete;
+    StreamLogBackend& operator=(const StreamLogBackend&) = delete;
+
+    // Append to 'path' instead of the stream given at construction
+    bool Open(const char* path);
+
+    void Write(LogLevel level, int64_t timestamp, const char* tag, const char* message) override;
+    void Flush() override;
+
+private:
+    FILE* stream_;
+    bool owned_;
+};
+
+// nullptr restores the platform default (logcat on Android, else stderr).
+// Writes are serialized with the switch, so the previous backend may be
+// destroyed once this returns.
+void SetLogBackend(LogBackend* backend);
+
+// Write an already formatted message straight to the backend, for
+// background threads with their own queue (trace.h)
+void LogWrite(LogLevel level, int64_t timestamp, const char* message);
+
+// Background formatting thread (runtime init/shutdown); stopping flushes
+bool StartLogThread();
+void StopLogThread();
+
+struct LogStats {
+    uint64_t queued;
+    uint64_t dropped;     // Ring full or no ring free
+    uint64_t suppressed;  // Rate limited at the call site
+};
+
+void GetLogStats(LogStats* stats);
 
+// Per call site rate limit state (a function-local static in LOGx)
+struct LogCallSite {
+    std::atomic<int64_t> windowStart{0};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> suppressed{0};
+};
+
+enum LogArgType : uint8_t {
+    LOG_ARG_INT,
+    LOG_ARG_UINT,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_POINTER,
+    LOG_ARG_STRING  // Value is the offset into LogRecord::strings
+};
+
+// Unformatted message
+struct LogRecord {
+    int64_t timestamp;
+    const char* format;  // String literal
+    uint32_t suppressed;
+    uint8_t level;
+    uint8_t argCount;
+    uint16_t stringBytes;
+    uint8_t argTypes[LOG_MAX_ARGS];
+    uint64_t args[LOG_MAX_ARGS];
+    char strings[LOG_STRING_BYTES];
+};
+
+// Argument capture by printf argument class
+inline void PackLogString(LogRecord* record, const char* value) {
+    uint32_t index = record->argCount++;
+    record->argTypes[index] = LOG_ARG_STRING;
+    record->args[index] = record->stringBytes;
+
+    if (!value) {
+        value = "(null)";
+    }
+    size_t available = LOG_STRING_BYTES - record->stringBytes;
+    size_t length = strnlen(value, available > 0 ? available - 1 : 0);
+    memcpy(record->strings + record->stringBytes, value, length);
+    record->strings[record->stringBytes + length] = '\0';
+    record->stringBytes = static_cast<uint16_t>(record->stringBytes + length + 1);
+}
+
+template <typename T>
+inline void PackLogArg(LogRecord* record, T value) {
+    if (record->argCount >= LOG_MAX_ARGS) {
+        return;
+    }
+
+    uint32_t index = record->argCount;
+    if constexpr (std::is_same<T, char*>::value || std::is_same<T, const char*>::value) {
+        if (record->stringBytes < LOG_STRING_BYTES) {
+            PackLogString(record, value);
+            return;
+        }
+        record->args[index] = reinterpret_cast<uint64_t>(value);  // No room; print the address
+        record->argTypes[index] = LOG_ARG_POINTER;
+    } else if constexpr (std::is_pointer<T>::value || std::is_null_pointer<T>::value) {
+        record->args[index] = reinterpret_cast<uint64_t>(static_cast<const void*>(value));
+        record->argTypes[index] = LOG_ARG_POINTER;
+    } else if constexpr (std::is_floating_point<T>::value) {
+        double d = static_cast<double>(value);
+        memcpy(&record->args[index], &d, sizeof(d));
+        record->argTypes[index] = LOG_ARG_DOUBLE;
+    } else if constexpr (std::is_signed<T>::value || std::is_enum<T>::value) {
+        record->args[index] = static_cast<uint64_t>(static_cast<int64_t>(value));
+        record->argTypes[index] = LOG_ARG_INT;
+    } else {
+        static_assert(std::is_integral<T>::value, "LOGx argument must be printf-compatible");
+        record->args[index] = static_cast<uint64_t>(value);
+        record->argTypes[index] = LOG_ARG_UINT;
+    }
+    record->argCount++;
+}
+
+bool LogRateLimit(LogCallSite* site, uint32_t* suppressed);
+void LogSubmit(LogRecord* record);
+
+// printf-style compile-time check of the format and arguments; never called
+void LogFormatCheck(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+template <typename... Args>
+inline void LogMessage(LogCallSite* site, LogLevel level, const char* format, Args... args) {
+    uint32_t suppressed = 0;
+    if (level != LOG_LEVEL_FATAL && !LogRateLimit(site, &suppressed)) {
+        return;
+    }
+
+    LogRecord record;
+    record.format = format;
+    record.suppressed = suppressed;
+    record.level = static_cast<uint8_t>(level);
+    record.argCount = 0;
+    record.stringBytes = 0;
+    int pack[] = {0, (PackLogArg(&record, args), 0)...};
+    (void)pack;
+    LogSubmit(&record);
+}
+
+#define XR_LOG(level, ...)                              \
+    do {                                                \
+        static LogCallSite xrLogSite_;                  \
+        if (false) {                                    \
+            LogFormatCheck(__VA_ARGS__);                \
+        }                                               \
+        LogMessage(&xrLogSite_, (level), __VA_ARGS__);  \
+    } while (0)
+
+#define LOGV(...) XR_LOG(LOG_LEVEL_VERBOSE, __VA_ARGS__)
+#define LOGD(...) XR_LOG(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOGI(...) XR_LOG(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOGW(...) XR_LOG(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOGE(...) XR_LOG(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOGF(...) XR_LOG(LOG_LEVEL_FATAL, __VA_ARGS__)
+
+#endif // LOGGER_H
@@ -0,0 +1,106 @@
+#ifndef POSE_MATH_H
+#define POSE_MATH_H
+
+#include <openxr/openxr.h>
+#include <cmath>
+
+// Small quaternion/pose helpers shared by tracking and time warp code.
+// Quaternions are (x, y, z, w) as in OpenXR.
+
+inline float QuatDot(const XrQuaternionf& a, const XrQuaternionf& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+inline XrQuaternionf QuatNormalize(const XrQuaternionf& q) {
+    float len = sqrtf(QuatDot(q, q));
+    if (len < 0.0001f) {
+        return {0.0f, 0.0f, 0.0f, 1.0f};
+    }
+    return {q.x / len, q.y / len, q.z / len, q.w / len};
+}
+
+inline XrQuaternionf QuatConjugate(const XrQuaternionf& q) {
+    return {-q.x, -q.y, -q.z, q.w};
+}
+
+inline XrQuaternionf QuatMultiply(const XrQuaternionf& a, const XrQuaternionf& b) {
+    return {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+}
+
+// v' = q * v * q^-1, using t = 2 * cross(q.xyz, v); v' = v + w * t + cross(q.xyz, t)
+inline XrVector3f QuatRotateVector(const XrQuaternionf& q, const XrVector3f& v) {
+    float tx = 2.0f * (q.y * v.z - q.z * v.y);
+    float ty = 2.0f * (q.z * v.x - q.x * v.z);
+    float tz = 2.0f * (q.x * v.y - q.y * v.x);
+    return {
+        v.x + q.w * tx + (q.y * tz - q.z * ty),
+        v.y + q.w * ty + (q.z * tx - q.x * tz),
+        v.z + q.w * tz + (q.x * ty - q.y * tx)
+    };
+}
+
+// Rotation vector (axis * angle, radians) to quaternion: exp(v / 2)
+inline XrQuaternionf QuatFromRotationVector(const XrVector3f& v) {
+    float angle = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+    if (angle < 1e-6f) {
+        return QuatNormalize({0.5f * v.x, 0.5f * v.y, 0.5f * v.z, 1.0f});
+    }
+    float s = sinf(0.5f * angle) / angle;
+    return {v.x * s, v.y * s, v.z * s, cosf(0.5f * angle)};
+}
+
+// Inverse of QuatFromRotationVector (2 * log(q)), shortest rotation
+inline XrVector3f QuatToRotationVector(XrQuaternionf q) {
+    if (q.w < 0.0f) {
+        q = {-q.x, -q.y, -q.z, -q.w};
+    }
+    float sinHalf = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z);
+    if (sinHalf < 1e-6f) {
+        return {2.0f * q.x, 2.0f * q.y, 2.0f * q.z};
+    }
+    float scale = 2.0f * atan2f(sinHalf, q.w) / sinHalf;
+    return {q.x * scale, q.y * scale, q.z * scale};
+}
+
+// Shortest-path slerp. t outside [0, 1] extrapolates along the same arc.
+inline XrQuaternionf QuatSlerp(const XrQuaternionf& a, XrQuaternionf b, float t) {
+    float cosTheta = QuatDot(a, b);
+    if (cosTheta < 0.0f) {
+        b = {-b.x, -b.y, -b.z, -b.w};
+        cosTheta = -cosTheta;
+    }
+
+    float wa = 1.0f - t;
+    float wb = t;
+    if (cosTheta < 0.9995f) {
+        float theta = acosf(cosTheta);
+        float sinTheta = sinf(theta);
+        wa = sinf((1.0f - t) * theta) / sinTheta;
+        wb = sinf(t * theta) / sinTheta;
+    }
+
+    return QuatNormalize({
+        wa * a.x + wb * b.x,
+        wa * a.y + wb * b.y,
+        wa * a.z + wb * b.z,
+        wa * a.w + wb * b.w
+    });
+}
+
+inline XrVector3f Vec3Lerp(const XrVector3f& a, const XrVector3f& b, float t) {
+    return {a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t};
+}
+
+inline XrPosef PoseInterpolate(const XrPosef& a, const XrPosef& b, float t) {
+    XrPosef pose;
+    pose.orientation = QuatSlerp(a.orientation, b.orientation, t);
+    pose.position = Vec3Lerp(a.position, b.position, t);
+    return pose;
+}
+
+#endif // POSE_MATH_H
@@ -0,0 +1,130 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// Back off while a seqlock writer is mid-update: spin briefly with the CPU's
+// pause hint, then yield so a preempted writer can finish
+inline void SeqLockPause(uint32_t spins) {
+    if (spins < 64) {
+#if defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+// Sequence counter for one writer and any number of lock-free readers; odd
+// while the writer is updating the data it guards. Concurrent writers must
+// be serialized by the caller.
+//
+// Data accessed between BeginWrite/EndWrite and ReadBegin/ReadRetry is
+// bracketed by the fences here. Prefer SeqLocked<T>, whose copies are
+// atomic words; use this directly only for data updated in place.
+class SeqLock {
+public:
+    SeqLock() : sequence_(0) {}
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    void BeginWrite() {
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void EndWrite() {
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_release);
+    }
+
+    // Waits out a write in progress; returns the (even) sequence to pass
+    // to ReadRetry
+    uint64_t ReadBegin() const {
+        uint64_t sequence;
+        for (uint32_t spins = 0; (sequence = sequence_.load(std::memory_order_acquire)) & 1; ++spins) {
+            SeqLockPause(spins);
+        }
+        return sequence;
+    }
+
+    // True if a write overlapped the read and it must be repeated
+    bool ReadRetry(uint64_t sequence) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence_.load(std::memory_order_relaxed) != sequence;
+    }
+
+private:
+    std::atomic<uint64_t> sequence_;
+};
+
+// A trivially copyable value behind a seqlock. The value is kept as relaxed
+// atomic words, so a reader racing the writer sees a torn copy it then
+// discards, never a data race.
+template <typename T>
+class SeqLocked {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLocked value must be trivially copyable");
+
+public:
+    SeqLocked() {
+        for (std::atomic<uint64_t>& word : words_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    explicit SeqLocked(const T& value) : SeqLocked() {
+        Store(value);
+    }
+
+    SeqLocked(const SeqLocked&) = delete;
+    SeqLocked& operator=(const SeqLocked&) = delete;
+
+    // Writer only
+    void Store(const T& value) {
+        uint64_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+
+        lock_.BeginWrite();
+        for (uint32_t i = 0; i < WORDS; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        lock_.EndWrite();
+    }
+
+    // Returns the sequence the value was read at; it grows by two per Store
+    uint64_t Load(T* value) const {
+        uint64_t words[WORDS];
+        uint64_t sequence;
+        do {
+            sequence = lock_.ReadBegin();
+            for (uint32_t i = 0; i < WORDS; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+        } while (lock_.ReadRetry(sequence));
+
+        memcpy(value, words, sizeof(T));
+        return sequence;
+    }
+
+    T Load() const {
+        T value;
+        Load(&value);
+        return value;
+    }
+
+private:
+    static const uint32_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    SeqLock lock_;
+    std::atomic<uint64_t> words_[WORDS];
+};
+
+#endif // SEQLOCK_H
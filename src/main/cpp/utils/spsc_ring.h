@@ -0,0 +1,60 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded single-producer/single-consumer ring.
+// Push is only called from the producer thread and Pop from the consumer
+// thread; neither ever blocks. Capacity must be a power of two.
+template <typename T, uint32_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head_(0), tail_(0) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: returns false (item dropped) when the ring is full
+    bool Push(const T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+        items_[head & (Capacity - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: returns false when the ring is empty
+    bool Pop(T* item) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *item = items_[tail & (Capacity - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: discard everything currently queued
+    void Clear() {
+        tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    uint32_t Size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    // Keep producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<uint32_t> head_;
+    alignas(64) std::atomic<uint32_t> tail_;
+    alignas(64) T items_[Capacity];
+};
+
+#endif // SPSC_RING_H
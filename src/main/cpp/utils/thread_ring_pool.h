@@ -0,0 +1,141 @@
+#ifndef THREAD_RING_POOL_H
+#define THREAD_RING_POOL_H
+
+#include "spsc_ring.h"
+#include <atomic>
+#include <cstdint>
+
+// Per-thread ownership of a pool ring. Must be thread_local; when the
+// thread exits the ring is marked retired and freed after its last drain.
+struct ThreadRingSlot {
+    std::atomic<bool>* retired = nullptr;
+    void* ring = nullptr;
+    bool unavailable = false;  // All rings were taken; don't retry
+
+    ~ThreadRingSlot() {
+        if (retired) {
+            retired->store(true, std::memory_order_release);
+        }
+    }
+};
+
+// Fixed set of SPSC rings, one per producing thread, all drained by a
+// single consumer thread. Producers never block or allocate: a thread
+// claims a free ring on its first Push and the items are dropped (and
+// counted) when its ring is full or no ring is free.
+template <typename T, uint32_t RingSize, uint32_t MaxThreads>
+class ThreadRingPool {
+public:
+    ThreadRingPool() : retiredPushed_(0), retiredDropped_(0), droppedNoRing_(0) {}
+
+    ThreadRingPool(const ThreadRingPool&) = delete;
+    ThreadRingPool& operator=(const ThreadRingPool&) = delete;
+
+    // Producer; 'slot' is the calling thread's thread_local slot for this pool
+    bool Push(ThreadRingSlot* slot, const T& item) {
+        Entry* entry = static_cast<Entry*>(slot->ring);
+        if (!entry) {
+            entry = Claim(slot);
+            if (!entry) {
+                droppedNoRing_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        // Only the owner writes its counters, so load/store suffices
+        if (!entry->ring.Push(item)) {
+            entry->dropped.store(entry->dropped.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
+            return false;
+        }
+        entry->pushed.store(entry->pushed.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer: pop everything queued, calling 'consume(item)' per item, and
+    // free the rings of threads that have exited
+    template <typename Consumer>
+    void Drain(Consumer consume) {
+        for (uint32_t i = 0; i < MaxThreads; ++i) {
+            Entry& entry = entries_[i];
+            if (!entry.claimed.load(std::memory_order_acquire)) {
+                continue;
+            }
+
+            // Read before draining so a retired ring is known to be complete
+            bool retired = entry.retired.load(std::memory_order_acquire);
+
+            T item;
+            while (entry.ring.Pop(&item)) {
+                consume(item);
+            }
+
+            if (retired) {
+                retiredPushed_.fetch_add(entry.pushed.exchange(0, std::memory_order_relaxed),
+                                         std::memory_order_relaxed);
+                retiredDropped_.fetch_add(entry.dropped.exchange(0, std::memory_order_relaxed),
+                                          std::memory_order_relaxed);
+                entry.retired.store(false, std::memory_order_relaxed);
+                entry.claimed.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+    // Totals over all threads: queued items, items dropped on a full ring
+    // and items dropped because no ring was free
+    void GetCounts(uint64_t* pushed, uint64_t* droppedFull, uint64_t* droppedNoRing) const {
+        uint64_t totalPushed = retiredPushed_.load(std::memory_order_relaxed);
+        uint64_t totalDropped = retiredDropped_.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < MaxThreads; ++i) {
+            totalPushed += entries_[i].pushed.load(std::memory_order_relaxed);
+            totalDropped += entries_[i].dropped.load(std::memory_order_relaxed);
+        }
+        if (pushed) {
+            *pushed = totalPushed;
+        }
+        if (droppedFull) {
+            *droppedFull = totalDropped;
+        }
+        if (droppedNoRing) {
+            *droppedNoRing = droppedNoRing_.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Entry {
+        Entry() : claimed(false), retired(false), pushed(0), dropped(0) {}
+
+        std::atomic<bool> claimed;
+        std::atomic<bool> retired;  // Owner exited, drain then free
+        std::atomic<uint64_t> pushed;
+        std::atomic<uint64_t> dropped;
+        SpscRing<T, RingSize> ring;
+    };
+
+    Entry* Claim(ThreadRingSlot* slot) {
+        if (slot->unavailable) {
+            return nullptr;
+        }
+
+        for (uint32_t i = 0; i < MaxThreads; ++i) {
+            bool expected = false;
+            if (entries_[i].claimed.compare_exchange_strong(expected, true,
+                                                            std::memory_order_acquire)) {
+                slot->ring = &entries_[i];
+                slot->retired = &entries_[i].retired;
+                return &entries_[i];
+            }
+        }
+
+        slot->unavailable = true;
+        return nullptr;
+    }
+
+    Entry entries_[MaxThreads];
+    std::atomic<uint64_t> retiredPushed_;
+    std::atomic<uint64_t> retiredDropped_;
+    std::atomic<uint64_t> droppedNoRing_;
+};
+
+#endif // THREAD_RING_POOL_H
@@ -0,0 +1,195 @@
+#include "trace.h"
+#include "logger.h"
+#include "thread_ring_pool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+// Format and minimum interval between records (0 = no rate limit).
+// Formats take %u (unsigned), %x (hex) and %f (float) arguments in order.
+struct TraceEventInfo {
+    const char* format;
+    int64_t minIntervalNs;
+};
+
+static const TraceEventInfo g_traceEvents[] = {
+    {"Compose layer %u, view %u: image=%x, pose=(%f,%f,%f)", 0},  // TRACE_COMPOSE_PROJECTION_VIEW
+    {"Compose quad layer %u: image=%x", 0},                       // TRACE_COMPOSE_QUAD
+    {"Composed frame %u (%u layers, reused=%u)", 0},              // TRACE_COMPOSE_FRAME
+    {"Low tracking quality: %f", 1000000000},                     // TRACE_TRACKING_LOW_QUALITY
+    {"Tracking warning flags: %x", 1000000000},                   // TRACE_TRACKING_WARNING
+    {"Tracking: relocation in progress", 1000000000},             // TRACE_TRACKING_RELOCATING
+};
+static_assert(sizeof(g_traceEvents) / sizeof(g_traceEvents[0]) == TRACE_EVENT_COUNT,
+              "g_traceEvents out of sync with TraceEvent");
+
+static ThreadRingPool<TraceRecord, TRACE_THREAD_RING_SIZE, TRACE_MAX_THREADS> g_tracePool;
+static thread_local ThreadRingSlot t_traceSlot;
+
+// Rate limit state, shared by all threads
+static std::atomic<int64_t> g_traceLastEmit[TRACE_EVENT_COUNT];
+static std::atomic<uint32_t> g_traceSuppressed[TRACE_EVENT_COUNT];
+
+static std::mutex g_traceMutex;
+static std::condition_variable g_traceCondition;
+static std::thread g_traceThread;
+static bool g_traceRunning = false;
+
+static int64_t TraceNow() {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+}
+
+void TraceEmit(uint32_t level, TraceEvent event, const uint64_t* args, uint32_t argCount) {
+    if (event >= TRACE_EVENT_COUNT) {
+        return;
+    }
+
+    int64_t now = TraceNow();
+    uint32_t suppressed = 0;
+
+    int64_t minInterval = g_traceEvents[event].minIntervalNs;
+    if (minInterval > 0) {
+        int64_t last = g_traceLastEmit[event].load(std::memory_order_relaxed);
+        if (now - last < minInterval ||
+            !g_traceLastEmit[event].compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            g_traceSuppressed[event].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        suppressed = g_traceSuppressed[event].exchange(0, std::memory_order_relaxed);
+    }
+
+    TraceRecord record;
+    record.timestamp = now;
+    record.event = event;
+    record.level = static_cast<uint8_t>(level);
+    record.argCount = static_cast<uint8_t>(argCount < TRACE_MAX_ARGS ? argCount : TRACE_MAX_ARGS);
+    record.suppressed = suppressed;
+    for (uint32_t i = 0; i < record.argCount; ++i) {
+        record.args[i] = args[i];
+    }
+
+    g_tracePool.Push(&t_traceSlot, record);
+}
+
+static LogLevel TraceLevelToLogLevel(uint32_t level) {
+    switch (level) {
+        case XR_TRACE_LEVEL_VERBOSE: return LOG_LEVEL_VERBOSE;
+        case XR_TRACE_LEVEL_DEBUG: return LOG_LEVEL_DEBUG;
+        case XR_TRACE_LEVEL_INFO: return LOG_LEVEL_INFO;
+        case XR_TRACE_LEVEL_WARN: return LOG_LEVEL_WARN;
+        default: return LOG_LEVEL_ERROR;
+    }
+}
+
+static void FormatTraceRecord(const TraceRecord& record, char* out, size_t size) {
+    size_t length = 0;
+    uint32_t arg = 0;
+
+    for (const char* p = g_traceEvents[record.event].format; *p && length + 1 < size; ++p) {
+        if (p[0] != '%' || p[1] == '\0') {
+            out[length++] = *p;
+            continue;
+        }
+
+        ++p;
+        uint64_t value = arg < record.argCount ? record.args[arg++] : 0;
+        int written;
+        switch (*p) {
+            case 'u':
+                written = snprintf(out + length, size - length, "%llu",
+                                   static_cast<unsigned long long>(value));
+                break;
+            case 'x':
+                written = snprintf(out + length, size - length, "0x%llx",
+                                   static_cast<unsigned long long>(value));
+                break;
+            case 'f': {
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                written = snprintf(out + length, size - length, "%.3f", d);
+                break;
+            }
+            default:
+                out[length++] = *p;
+                continue;
+        }
+        if (written < 0) {
+            break;
+        }
+        length += static_cast<size_t>(written) < size - length ? written : size - length - 1;
+    }
+    out[length] = '\0';
+}
+
+static void LogTraceRecord(const TraceRecord& record) {
+    if (record.event >= TRACE_EVENT_COUNT) {
+        return;
+    }
+
+    char message[256];
+    FormatTraceRecord(record, message, sizeof(message));
+
+    if (record.suppressed > 0) {
+        size_t length = strlen(message);
+        snprintf(message + length, sizeof(message) - length, " (%u suppressed)", record.suppressed);
+    }
+
+    // Stamped with the record's own time; it is written up to a drain
+    // interval later
+    LogWrite(TraceLevelToLogLevel(record.level), record.timestamp, message);
+}
+
+static void DrainTraceBuffers() {
+    g_tracePool.Drain([](const TraceRecord& record) { LogTraceRecord(record); });
+}
+
+static void TraceThreadMain() {
+    std::unique_lock<std::mutex> lock(g_traceMutex);
+    while (g_traceRunning) {
+        g_traceCondition.wait_for(lock, std::chrono::milliseconds(TRACE_DRAIN_INTERVAL_MS));
+
+        lock.unlock();
+        DrainTraceBuffers();
+        lock.lock();
+    }
+}
+
+bool StartTraceDrain() {
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+
+    if (g_traceRunning) {
+        return true;
+    }
+
+    g_traceRunning = true;
+    g_traceThread = std::thread(TraceThreadMain);
+    return true;
+}
+
+void StopTraceDrain() {
+    {
+        std::lock_guard<std::mutex> lock(g_traceMutex);
+        if (!g_traceRunning) {
+            return;
+        }
+        g_traceRunning = false;
+    }
+    g_traceCondition.notify_all();
+
+    // The thread drains once more after it is woken
+    if (g_traceThread.joinable()) {
+        g_traceThread.join();
+    }
+}
+
+void GetTraceStats(TraceStats* stats) {
+    if (!stats) {
+        return;
+    }
+
+    g_tracePool.GetCounts(&stats->emitted, &stats->droppedFull, &stats->droppedNoBuffer);
+}
@@ -0,0 +1,103 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <cstring>
+
+// Binary trace channel for hot paths (per frame, per view, per pose
+// sample). Emitting a record copies a few words into the calling thread's
+// lock-free ring; a background thread formats and logs them. LOGx from
+// logger.h is for cold paths only.
+
+#define XR_TRACE_LEVEL_VERBOSE 0
+#define XR_TRACE_LEVEL_DEBUG 1
+#define XR_TRACE_LEVEL_INFO 2
+#define XR_TRACE_LEVEL_WARN 3
+#define XR_TRACE_LEVEL_ERROR 4
+#define XR_TRACE_LEVEL_NONE 5
+
+// Records below this level are compiled out
+#ifndef XR_TRACE_LEVEL
+#define XR_TRACE_LEVEL XR_TRACE_LEVEL_INFO
+#endif
+
+static const uint32_t TRACE_MAX_ARGS = 6;
+static const uint32_t TRACE_MAX_THREADS = 16;   // Threads with a ring at once
+static const uint32_t TRACE_THREAD_RING_SIZE = 256;
+static const uint32_t TRACE_DRAIN_INTERVAL_MS = 100;
+
+// Hot-path events. Each has a format and rate limit in g_traceEvents
+// (trace.cpp); keep the two in the same order.
+enum TraceEvent : uint16_t {
+    TRACE_COMPOSE_PROJECTION_VIEW,  // layer, view, swapchain, x, y, z
+    TRACE_COMPOSE_QUAD,             // layer, swapchain
+    TRACE_COMPOSE_FRAME,            // frameId, layerCount, reused
+    TRACE_TRACKING_LOW_QUALITY,     // quality
+    TRACE_TRACKING_WARNING,         // warning flags
+    TRACE_TRACKING_RELOCATING,
+    TRACE_EVENT_COUNT
+};
+
+// One cache line per record
+struct TraceRecord {
+    int64_t timestamp;     // steady_clock ns
+    uint16_t event;
+    uint8_t level;
+    uint8_t argCount;
+    uint32_t suppressed;   // Records dropped by the rate limit since the last one
+    uint64_t args[TRACE_MAX_ARGS];
+};
+
+struct TraceStats {
+    uint64_t emitted;
+    uint64_t droppedFull;       // Thread ring full
+    uint64_t droppedNoBuffer;   // More than TRACE_MAX_THREADS threads tracing
+};
+
+// Floating-point arguments travel as the bit pattern of a double
+inline uint64_t TraceArg(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+inline uint64_t TraceArg(float value) { return TraceArg(static_cast<double>(value)); }
+template <typename T>
+inline uint64_t TraceArg(T value) {
+    return static_cast<uint64_t>(value);
+}
+template <typename T>
+inline uint64_t TraceArg(T* value) {
+    return reinterpret_cast<uint64_t>(value);
+}
+
+// Non-blocking; drops the record when rate limited or the ring is full
+void TraceEmit(uint32_t level, TraceEvent event, const uint64_t* args, uint32_t argCount);
+
+// Background thread draining the rings to the log (runtime init/shutdown)
+bool StartTraceDrain();
+void StopTraceDrain();
+
+void GetTraceStats(TraceStats* stats);
+
+template <typename... Args>
+inline void TraceEmitArgs(uint32_t level, TraceEvent event, Args... args) {
+    static_assert(sizeof...(Args) <= TRACE_MAX_ARGS, "too many trace arguments");
+    const uint64_t packed[sizeof...(Args) > 0 ? sizeof...(Args) : 1] = {TraceArg(args)...};
+    TraceEmit(level, event, packed, sizeof...(Args));
+}
+
+// 'level' is one of XR_TRACE_LEVEL_*; the branch is resolved at compile
+// time so filtered records cost nothing
+#define XR_TRACE(level, ...)                      \
+    do {                                          \
+        if ((level) >= XR_TRACE_LEVEL) {          \
+            TraceEmitArgs((level), __VA_ARGS__);  \
+        }                                         \
+    } while (0)
+
+#define TRACEV(...) XR_TRACE(XR_TRACE_LEVEL_VERBOSE, __VA_ARGS__)
+#define TRACED(...) XR_TRACE(XR_TRACE_LEVEL_DEBUG, __VA_ARGS__)
+#define TRACEI(...) XR_TRACE(XR_TRACE_LEVEL_INFO, __VA_ARGS__)
+#define TRACEW(...) XR_TRACE(XR_TRACE_LEVEL_WARN, __VA_ARGS__)
+
+#endif // TRACE_H
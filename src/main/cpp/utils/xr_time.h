@@ -0,0 +1,13 @@
+#ifndef XR_TIME_H
+#define XR_TIME_H
+
+#include <openxr/openxr.h>
+#include <chrono>
+
+// XrTime is steady_clock nanoseconds (see GetXR2CurrentTime), so deadlines
+// convert directly
+inline std::chrono::steady_clock::time_point XrTimeToSteadyClock(XrTime time) {
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(time));
+}
+
+#endif // XR_TIME_H
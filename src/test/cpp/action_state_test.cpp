@@ -0,0 +1,138 @@
+#include "openxr/action_state.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Every field of every entry encodes the sync it was written by, so a torn
+// read shows up as fields that disagree
+ActionStateValue MakeValue(uint32_t sync, uint32_t entry) {
+    ActionStateValue value;
+    value.isActive = true;
+    value.booleanState = ((sync + entry) & 1) != 0;
+    value.changedSinceLastSync = ((sync + entry) & 2) != 0;
+    value.floatState = static_cast<float>(sync);
+    value.vector2fState = {static_cast<float>(sync), -static_cast<float>(sync)};
+    value.lastChangeTime = static_cast<XrTime>(sync) * 1000 + entry;
+    return value;
+}
+
+void PublishSync(ActionStateBuffer* buffer, uint32_t sync, uint32_t entries) {
+    std::lock_guard<std::mutex> lock(buffer->writerMutex);
+    ActionStateSnapshot* snapshot = BeginActionStateWrite(buffer);
+    snapshot->syncTime = sync;
+    for (uint32_t entry = 0; entry < entries; ++entry) {
+        StoreActionState(snapshot, entry, MakeValue(sync, entry));
+    }
+    PublishActionState(buffer);
+}
+
+bool IsConsistent(const ActionStateValue& value, uint32_t entry, uint32_t* sync) {
+    uint32_t written = static_cast<uint32_t>(value.floatState);
+    ActionStateValue expected = MakeValue(written, entry);
+    *sync = written;
+    return value.isActive == expected.isActive && value.booleanState == expected.booleanState &&
+           value.changedSinceLastSync == expected.changedSinceLastSync &&
+           value.vector2fState.x == expected.vector2fState.x &&
+           value.vector2fState.y == expected.vector2fState.y &&
+           value.lastChangeTime == expected.lastChangeTime;
+}
+
+}  // namespace
+
+TEST(ActionStateTest, UnwrittenEntriesReadInactive) {
+    std::unique_ptr<ActionStateBuffer> buffer(new ActionStateBuffer());
+    PublishSync(buffer.get(), 1, 1);
+
+    ActionStateValue value;
+    ASSERT_TRUE(ReadActionState(*buffer, 0, &value));
+    EXPECT_TRUE(value.isActive);
+    ASSERT_TRUE(ReadActionState(*buffer, 1, &value));
+    EXPECT_FALSE(value.isActive);
+    EXPECT_FALSE(ReadActionState(*buffer, ACTION_STATE_ENTRIES, &value));
+}
+
+TEST(ActionStateTest, ReadsTheLatestPublishedSync) {
+    std::unique_ptr<ActionStateBuffer> buffer(new ActionStateBuffer());
+    for (uint32_t sync = 1; sync <= 3; ++sync) {
+        PublishSync(buffer.get(), sync, ACTION_STATE_ENTRIES);
+        ActionStateValue value;
+        uint32_t read;
+        ASSERT_TRUE(ReadActionState(*buffer, ActionStateEntry(1, ACTION_STATE_LANE_ANY), &value));
+        EXPECT_TRUE(IsConsistent(value, ActionStateEntry(1, ACTION_STATE_LANE_ANY), &read));
+        EXPECT_EQ(read, sync);
+    }
+}
+
+// xrSyncActions republishes as fast as it can while readers query; every
+// read must come from one sync, and a reader never goes back in time
+TEST(ActionStateTest, ReadersNeverSeeTornOrOlderState) {
+    std::unique_ptr<ActionStateBuffer> buffer(new ActionStateBuffer());
+    PublishSync(buffer.get(), 1, ACTION_STATE_ENTRIES);
+
+    std::atomic<bool> running(true);
+    std::atomic<uint32_t> syncs(1);
+    std::thread writer([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+            PublishSync(buffer.get(), syncs.load() + 1, ACTION_STATE_ENTRIES);
+            syncs++;
+        }
+    });
+
+    uint64_t reads = 0, torn = 0, backwards = 0;
+    uint32_t lastSync = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (std::chrono::steady_clock::now() < end) {
+        for (uint32_t entry = 0; entry < ACTION_STATE_ENTRIES; entry += 7) {
+            ActionStateValue value;
+            uint32_t sync;
+            ASSERT_TRUE(ReadActionState(*buffer, entry, &value));
+            if (!IsConsistent(value, entry, &sync)) {
+                torn++;
+            }
+            if (sync < lastSync) {
+                backwards++;
+            }
+            lastSync = sync;
+            reads++;
+        }
+    }
+
+    running = false;
+    writer.join();
+
+    printf("[ BENCH    ] %llu reads across %u syncs\n", static_cast<unsigned long long>(reads), syncs.load());
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(backwards, 0u);
+    EXPECT_GT(syncs.load(), 2u);
+}
+
+// Per-query cost with every action slot bound; a query is an index and a
+// few loads, so it must not grow with the number of actions. Disabled by
+// default, see README.
+TEST(ActionStateBenchmark, DISABLED_QueryCostWithEveryActionBound) {
+    std::unique_ptr<ActionStateBuffer> buffer(new ActionStateBuffer());
+    PublishSync(buffer.get(), 1, ACTION_STATE_ENTRIES);
+
+    const uint32_t rounds = 2000;
+    double sum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; ++round) {
+        for (uint32_t entry = 0; entry < ACTION_STATE_ENTRIES; ++entry) {
+            ActionStateValue value;
+            ReadActionState(*buffer, entry, &value);
+            sum += value.floatState;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double queries = static_cast<double>(rounds) * ACTION_STATE_ENTRIES;
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    printf("[ BENCH    ] %u entries: %.1f ns per query\n", ACTION_STATE_ENTRIES, ns / queries);
+    EXPECT_EQ(sum, queries);
+}
@@ -0,0 +1,97 @@
+#include "platform/compositor.h"
+#include "qualcomm/xr2_platform.h"
+#include <gtest/gtest.h>
+#include <atomic>
+
+namespace {
+
+// Counts calls; composes nothing
+class CountingBackend : public CompositorBackend {
+public:
+    explicit CountingBackend(bool initializes) : initializes_(initializes) {}
+
+    bool Initialize() override {
+        initializeCalls++;
+        return initializes_;
+    }
+
+    void Shutdown() override {
+        shutdownCalls++;
+    }
+
+    bool SampleWarpPoses(XrTime, XrTime, XrPosef*, XrPosef*) override {
+        return false;
+    }
+
+    bool Compose(const CompositorFrame&, const CompositorWarp&) override {
+        return true;
+    }
+
+    std::atomic<int> initializeCalls{0};
+    std::atomic<int> shutdownCalls{0};
+
+private:
+    bool initializes_;
+};
+
+}  // namespace
+
+TEST(CompositorTest, FailedBackendInitializeFailsStart) {
+    CountingBackend broken(false);
+    EXPECT_FALSE(StartCompositor(&broken));
+    EXPECT_EQ(broken.initializeCalls.load(), 1);
+    EXPECT_EQ(broken.shutdownCalls.load(), 0);
+
+    // Nothing left running: the next start gets a fresh thread
+    CountingBackend working(true);
+    ASSERT_TRUE(StartCompositor(&working));
+    EXPECT_EQ(working.initializeCalls.load(), 1);
+    StopCompositor();
+    EXPECT_EQ(working.shutdownCalls.load(), 1);
+}
+
+TEST(CompositorTest, SecondStartIsRefused) {
+    CountingBackend first(true);
+    CountingBackend second(true);
+    ASSERT_TRUE(StartCompositor(&first));
+    EXPECT_FALSE(StartCompositor(&second));
+    EXPECT_EQ(second.initializeCalls.load(), 0);
+    StopCompositor();
+    EXPECT_EQ(first.shutdownCalls.load(), 1);
+}
+
+// Frames for a vsync far ahead pile up in the queue; once it is full the
+// frame is dropped, not failed
+TEST(CompositorTest, FullQueueDropsTheFrame) {
+    CountingBackend backend(true);
+    ASSERT_TRUE(StartCompositor(&backend));
+
+    XrCompositionLayerQuad quad = {};
+    quad.type = XR_TYPE_COMPOSITION_LAYER_QUAD;
+    quad.pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}};
+    quad.size = {1.0f, 1.0f};
+    const XrCompositionLayerBaseHeader* layers[] = {
+        reinterpret_cast<const XrCompositionLayerBaseHeader*>(&quad)};
+    XrTime displayTime = GetXR2CurrentTime() + 10000000000LL;
+
+    uint32_t queued = 0;
+    uint32_t dropped = 0;
+    for (uint64_t frameId = 1; frameId <= 2 * COMPOSITOR_QUEUE_SIZE + 2; ++frameId) {
+        switch (SubmitCompositorLayers(frameId, displayTime, layers, 1)) {
+            case COMPOSITOR_SUBMIT_QUEUED: queued++; break;
+            case COMPOSITOR_SUBMIT_DROPPED: dropped++; break;
+            case COMPOSITOR_SUBMIT_FAILED: ADD_FAILURE() << "frame " << frameId; break;
+        }
+    }
+    EXPECT_EQ(SubmitCompositorLayers(0, displayTime, layers, 0), COMPOSITOR_SUBMIT_FAILED);
+
+    CompositorStats stats;
+    GetCompositorStats(&stats);
+    StopCompositor();
+
+    // The queue, plus the one frame the thread may have taken as pending
+    EXPECT_GE(queued, COMPOSITOR_QUEUE_SIZE);
+    EXPECT_LE(queued, COMPOSITOR_QUEUE_SIZE + 1);
+    EXPECT_GT(dropped, 0u);
+    EXPECT_EQ(stats.queueOverflows, dropped);
+}
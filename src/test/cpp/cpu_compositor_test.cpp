@@ -0,0 +1,253 @@
+#include "platform/cpu_compositor.h"
+#include "platform/host_graphics_backend.h"
+#include "platform/texture_pool.h"
+#include "openxr/handle_table.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const float HALF_FOV = 0.7853982f;  // 45 degrees each way
+
+struct CompositorContext {
+    HostGraphicsBackend graphics;
+    XrPosef renderPose;
+    XrPosef displayPose;
+};
+
+// Layers name host images directly: the swapchain handle is the image id
+bool ResolveHostImage(void* context, const CompositorView& view, HostImage* image) {
+    HostGraphicsBackend& graphics = static_cast<CompositorContext*>(context)->graphics;
+    return graphics.MapImage(static_cast<uint32_t>(HandleToValue(view.swapchain)), view.imageArrayIndex, image);
+}
+
+bool SampleFixedPoses(void* context, XrTime /*renderTime*/, XrTime /*targetTime*/,
+                      XrPosef* renderPose, XrPosef* displayPose) {
+    const CompositorContext* poses = static_cast<const CompositorContext*>(context);
+    *renderPose = poses->renderPose;
+    *displayPose = poses->displayPose;
+    return true;
+}
+
+class CpuCompositorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        context_.renderPose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+        context_.displayPose = context_.renderPose;
+    }
+
+    CpuCompositorConfig MakeConfig(uint32_t width, uint32_t height) {
+        CpuCompositorConfig config = {};
+        config.eyeWidth = width;
+        config.eyeHeight = height;
+        for (XrFovf& fov : config.eyeFov) {
+            fov = {-HALF_FOV, HALF_FOV, HALF_FOV, -HALF_FOV};
+        }
+        config.threadCount = 0;
+        config.resolveImage = ResolveHostImage;
+        config.samplePoses = SampleFixedPoses;
+        config.context = &context_;
+        return config;
+    }
+
+    // One RGBA8 image filled by 'fill(x, y, texel)'
+    template <typename Fill>
+    XrSwapchain CreateImage(uint32_t width, uint32_t height, Fill fill) {
+        SwapchainImageDesc desc = {width, height, HOST_FORMAT_RGBA8, 1, 1, 1};
+        uint32_t texture = 0;
+        EXPECT_TRUE(context_.graphics.CreateTextures(desc, 1, &texture));
+        HostImage image;
+        EXPECT_TRUE(context_.graphics.MapImage(texture, 0, &image));
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                fill(x, y, image.pixels + y * image.stride + x * 4);
+            }
+        }
+        return ValueToHandle<XrSwapchain>(texture);
+    }
+
+    XrSwapchain CreateSolidImage(uint32_t width, uint32_t height, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+        return CreateImage(width, height, [=](uint32_t, uint32_t, uint8_t* texel) {
+            texel[0] = r;
+            texel[1] = g;
+            texel[2] = b;
+            texel[3] = a;
+        });
+    }
+
+    static CompositorView MakeView(XrSwapchain swapchain, uint32_t width, uint32_t height) {
+        CompositorView view = {};
+        view.swapchain = swapchain;
+        view.imageRect = {{0, 0}, {static_cast<int32_t>(width), static_cast<int32_t>(height)}};
+        view.pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+        view.fov = {-HALF_FOV, HALF_FOV, HALF_FOV, -HALF_FOV};
+        return view;
+    }
+
+    static CompositorLayer MakeProjection(const CompositorView* views, XrCompositionLayerFlags flags) {
+        CompositorLayer layer = {};
+        layer.type = XR_TYPE_COMPOSITION_LAYER_PROJECTION;
+        layer.layerFlags = flags;
+        layer.viewCount = 2;
+        layer.views = views;
+        return layer;
+    }
+
+    static CompositorWarp MakeWarp(CompositorBackend* backend) {
+        CompositorWarp warp = {};
+        backend->SampleWarpPoses(0, 0, &warp.renderPose, &warp.displayPose);
+        return warp;
+    }
+
+    static const uint8_t* Texel(const HostImage* image, uint32_t x, uint32_t y) {
+        return image->pixels + y * image->stride + x * 4;
+    }
+
+    CompositorContext context_;
+};
+
+}  // namespace
+
+TEST_F(CpuCompositorTest, SolidProjectionPassesThrough) {
+    CpuCompositorBackend compositor(MakeConfig(64, 64));
+    ASSERT_TRUE(compositor.Initialize());
+
+    XrSwapchain image = CreateSolidImage(32, 32, 200, 100, 50, 255);
+    CompositorView views[2] = {MakeView(image, 32, 32), MakeView(image, 32, 32)};
+    CompositorLayer layer = MakeProjection(views, 0);
+    CompositorFrame frame = {1, 0, 1, &layer, 0};
+    ASSERT_TRUE(compositor.Compose(frame, MakeWarp(&compositor)));
+
+    for (uint32_t eye = 0; eye < 2; ++eye) {
+        const HostImage* output = compositor.GetEyeOutput(eye);
+        ASSERT_NE(output, nullptr);
+        uint32_t wrong = 0;
+        for (uint32_t y = 0; y < output->height; ++y) {
+            for (uint32_t x = 0; x < output->width; ++x) {
+                const uint8_t* texel = Texel(output, x, y);
+                if (texel[0] != 200 || texel[1] != 100 || texel[2] != 50) {
+                    wrong++;
+                }
+            }
+        }
+        EXPECT_EQ(wrong, 0u) << "eye " << eye;
+    }
+}
+
+TEST_F(CpuCompositorTest, EachEyeSamplesItsOwnView) {
+    CpuCompositorBackend compositor(MakeConfig(32, 32));
+    ASSERT_TRUE(compositor.Initialize());
+
+    CompositorView views[2] = {MakeView(CreateSolidImage(16, 16, 255, 0, 0, 255), 16, 16),
+                               MakeView(CreateSolidImage(16, 16, 0, 0, 255, 255), 16, 16)};
+    CompositorLayer layer = MakeProjection(views, 0);
+    CompositorFrame frame = {1, 0, 1, &layer, 0};
+    ASSERT_TRUE(compositor.Compose(frame, MakeWarp(&compositor)));
+
+    EXPECT_EQ(Texel(compositor.GetEyeOutput(0), 16, 16)[0], 255);
+    EXPECT_EQ(Texel(compositor.GetEyeOutput(0), 16, 16)[2], 0);
+    EXPECT_EQ(Texel(compositor.GetEyeOutput(1), 16, 16)[0], 0);
+    EXPECT_EQ(Texel(compositor.GetEyeOutput(1), 16, 16)[2], 255);
+}
+
+TEST_F(CpuCompositorTest, SourceAlphaBlendsOverLowerLayers) {
+    CpuCompositorBackend compositor(MakeConfig(16, 16));
+    ASSERT_TRUE(compositor.Initialize());
+
+    XrSwapchain base = CreateSolidImage(8, 8, 255, 0, 0, 255);
+    XrSwapchain overlay = CreateSolidImage(8, 8, 128, 128, 128, 128);  // Premultiplied
+    CompositorView baseViews[2] = {MakeView(base, 8, 8), MakeView(base, 8, 8)};
+    CompositorView overlayViews[2] = {MakeView(overlay, 8, 8), MakeView(overlay, 8, 8)};
+    CompositorLayer layers[2] = {MakeProjection(baseViews, 0),
+                                 MakeProjection(overlayViews, XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT)};
+    CompositorFrame frame = {1, 0, 2, layers, 0};
+    ASSERT_TRUE(compositor.Compose(frame, MakeWarp(&compositor)));
+
+    // 128 + 255 * (1 - 128/255) for red, 128 + 0 for the rest
+    const uint8_t* texel = Texel(compositor.GetEyeOutput(0), 8, 8);
+    EXPECT_NEAR(texel[0], 255, 1);
+    EXPECT_NEAR(texel[1], 128, 1);
+    EXPECT_NEAR(texel[2], 128, 1);
+}
+
+// Left half black, right half white; the edge sits straight ahead. A head
+// turn to the left after rendering must move it to the right on screen.
+TEST_F(CpuCompositorTest, TimeWarpMovesTheSceneAgainstTheHeadTurn) {
+    const uint32_t width = 256;
+    CpuCompositorBackend compositor(MakeConfig(width, 8));
+    ASSERT_TRUE(compositor.Initialize());
+
+    XrSwapchain image = CreateImage(width, 8, [=](uint32_t x, uint32_t, uint8_t* texel) {
+        uint8_t value = x < width / 2 ? 0 : 255;
+        texel[0] = texel[1] = texel[2] = value;
+        texel[3] = 255;
+    });
+    CompositorView views[2] = {MakeView(image, width, 8), MakeView(image, width, 8)};
+    CompositorLayer layer = MakeProjection(views, 0);
+    CompositorFrame frame = {1, 0, 1, &layer, 0};
+
+    float yaw = 0.1f;  // About +y, to the left
+    context_.displayPose.orientation = {0.0f, sinf(yaw / 2), 0.0f, cosf(yaw / 2)};
+    ASSERT_TRUE(compositor.Compose(frame, MakeWarp(&compositor)));
+
+    const HostImage* output = compositor.GetEyeOutput(0);
+    uint32_t edge = 0;
+    while (edge < width && Texel(output, edge, 4)[0] < 128) {
+        edge++;
+    }
+
+    // tan(yaw) of the half-width tangent range 1.0, in pixels
+    float expected = width / 2.0f * (1.0f + tanf(yaw));
+    EXPECT_NEAR(static_cast<float>(edge), expected, 2.0f);
+}
+
+// Timing benchmarks; disabled by default, see README
+class CpuCompositorBenchmark : public CpuCompositorTest {};
+
+// Per-megapixel throughput with lens distortion, two projection layers and a
+// head-locked quad, every core working
+TEST_F(CpuCompositorBenchmark, DISABLED_Throughput) {
+    CpuCompositorConfig config = MakeConfig(1024, 1024);
+    config.distortionK1 = 0.22f;
+    config.distortionK2 = 0.24f;
+    CpuCompositorBackend compositor(config);
+    ASSERT_TRUE(compositor.Initialize());
+
+    XrSwapchain scene = CreateImage(1024, 1024, [](uint32_t x, uint32_t y, uint8_t* texel) {
+        texel[0] = static_cast<uint8_t>(x);
+        texel[1] = static_cast<uint8_t>(y);
+        texel[2] = static_cast<uint8_t>(x ^ y);
+        texel[3] = 255;
+    });
+    XrSwapchain hud = CreateSolidImage(256, 256, 32, 64, 32, 96);
+    CompositorView sceneViews[2] = {MakeView(scene, 1024, 1024), MakeView(scene, 1024, 1024)};
+    CompositorView hudViews[2] = {MakeView(hud, 256, 256), MakeView(hud, 256, 256)};
+    CompositorView quadView = MakeView(hud, 256, 256);
+    quadView.pose.position = {0.0f, 0.0f, -1.0f};
+
+    CompositorLayer layers[3] = {MakeProjection(sceneViews, 0),
+                                 MakeProjection(hudViews, XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT),
+                                 {}};
+    layers[2].type = XR_TYPE_COMPOSITION_LAYER_QUAD;
+    layers[2].layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+    layers[2].eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+    layers[2].size = {0.5f, 0.5f};
+    layers[2].viewCount = 1;
+    layers[2].views = &quadView;
+    CompositorFrame frame = {1, 0, 3, layers, 0};
+
+    float yaw = 0.02f;
+    context_.displayPose.orientation = {0.0f, sinf(yaw / 2), 0.0f, cosf(yaw / 2)};
+    for (uint32_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(compositor.Compose(frame, MakeWarp(&compositor)));
+    }
+
+    CpuCompositorStats stats;
+    compositor.GetStats(&stats);
+    printf("[ BENCH    ] %llu compositions of 2x1024x1024, 3 layers: %.1f ms each, %.1f MP/s\n",
+           static_cast<unsigned long long>(stats.composedFrames),
+           stats.composeTime / 1e6 / stats.composedFrames, stats.megapixelsPerSecond);
+    EXPECT_EQ(stats.composedFrames, 10u);
+    EXPECT_GT(stats.megapixelsPerSecond, 0.0f);
+}
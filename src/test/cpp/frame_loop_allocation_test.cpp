@@ -0,0 +1,226 @@
+#include "openxr/openxr_api.h"
+#include "openxr/handle_table.h"
+#include "openxr/session.h"
+#include "platform/compositor.h"
+#include "platform/cpu_compositor.h"
+#include "platform/display_manager.h"
+#include "platform/frame_pacer.h"
+#include "platform/host_graphics_backend.h"
+#include "platform/vsync_source.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+extern HandleTable<XRSession, XrSession> g_sessions;
+
+// Every heap allocation in the process, on any thread, while counting
+static std::atomic<bool> g_countAllocations(false);
+static std::atomic<uint64_t> g_allocations(0);
+
+static void* CountedAllocate(size_t size) {
+    if (g_countAllocations.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* pointer = malloc(size ? size : 1);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new(size_t size) {
+    return CountedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+    return CountedAllocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return CountedAllocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return CountedAllocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+namespace {
+
+const uint32_t EYE_SIZE = 128;
+
+// The app side of one frame: render both eyes and hand the layer over
+class FrameLoop {
+public:
+    bool Create() {
+        session_ = g_sessions.Insert(std::make_shared<XRSession>(XR_NULL_HANDLE));
+        if (session_ == XR_NULL_HANDLE) {
+            return false;
+        }
+        pacer_ = &g_sessions.Lookup(session_)->framePacer;
+        ResetFramePacer(pacer_);
+
+        XrSwapchainCreateInfo createInfo = {};
+        createInfo.type = XR_TYPE_SWAPCHAIN_CREATE_INFO;
+        createInfo.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+        createInfo.format = HOST_FORMAT_RGBA8;
+        createInfo.sampleCount = 1;
+        createInfo.width = EYE_SIZE;
+        createInfo.height = EYE_SIZE;
+        createInfo.faceCount = 1;
+        createInfo.arraySize = 1;
+        createInfo.mipCount = 1;
+        for (uint32_t eye = 0; eye < 2; ++eye) {
+            if (xrCreateSwapchain(session_, &createInfo, &swapchains_[eye]) != XR_SUCCESS) {
+                return false;
+            }
+            views_[eye] = {};
+            views_[eye].type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW;
+            views_[eye].pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+            views_[eye].fov = {-0.78f, 0.78f, 0.78f, -0.78f};
+            views_[eye].subImage.swapchain = swapchains_[eye];
+            views_[eye].subImage.imageRect = {{0, 0}, {static_cast<int32_t>(EYE_SIZE),
+                                                       static_cast<int32_t>(EYE_SIZE)}};
+        }
+        layer_ = {};
+        layer_.type = XR_TYPE_COMPOSITION_LAYER_PROJECTION;
+        layer_.viewCount = 2;
+        layer_.views = views_;
+        return true;
+    }
+
+    void Destroy() {
+        for (XrSwapchain swapchain : swapchains_) {
+            if (swapchain != XR_NULL_HANDLE) {
+                xrDestroySwapchain(swapchain);
+            }
+        }
+        if (session_ != XR_NULL_HANDLE) {
+            CancelFramePacer(pacer_);
+            g_sessions.Remove(session_);
+        }
+    }
+
+    bool RunFrame() {
+        XrTime displayTime;
+        XrDuration period;
+        if (!WaitForFramePacer(pacer_, &displayTime, &period)) {
+            return false;
+        }
+        XrTime wakeTime = GetXR2CurrentTime();
+
+        for (XrSwapchain swapchain : swapchains_) {
+            XrSwapchainImageAcquireInfo acquireInfo = {};
+            acquireInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO;
+            XrSwapchainImageWaitInfo waitInfo = {};
+            waitInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO;
+            waitInfo.timeout = XR_INFINITE_DURATION;
+            XrSwapchainImageReleaseInfo releaseInfo = {};
+            releaseInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO;
+            uint32_t index;
+            if (xrAcquireSwapchainImage(swapchain, &acquireInfo, &index) != XR_SUCCESS ||
+                xrWaitSwapchainImage(swapchain, &waitInfo) != XR_SUCCESS ||
+                xrReleaseSwapchainImage(swapchain, &releaseInfo) != XR_SUCCESS) {
+                return false;
+            }
+        }
+
+        const XrCompositionLayerBaseHeader* layers[] = {
+            reinterpret_cast<const XrCompositionLayerBaseHeader*>(&layer_)};
+        CompositorSubmitResult submitted = SubmitCompositorLayers(++frameId_, displayTime, layers, 1);
+        EndFramePacerFrame(pacer_, wakeTime);
+        return submitted == COMPOSITOR_SUBMIT_QUEUED;
+    }
+
+private:
+    XrSession session_ = XR_NULL_HANDLE;
+    FramePacer* pacer_ = nullptr;
+    XrSwapchain swapchains_[2] = {XR_NULL_HANDLE, XR_NULL_HANDLE};
+    XrCompositionLayerProjectionView views_[2];
+    XrCompositionLayerProjection layer_;
+    uint64_t frameId_ = 0;
+};
+
+}  // namespace
+
+TEST(FrameLoopAllocationTest, HookCountsAllocations) {
+    g_allocations = 0;
+    g_countAllocations = true;
+    std::unique_ptr<int[]> counted(new int[4]);
+    g_countAllocations = false;
+    EXPECT_EQ(g_allocations.load(), 1u);
+}
+
+// Wait, acquire, wait, release and submit for both eyes, with the compositor
+// thread composing every vsync on the CPU: once warmed up, nothing on any
+// thread touches the heap
+TEST(FrameLoopAllocationTest, SteadyStateFrameLoopDoesNotAllocate) {
+    ASSERT_EQ(StartVsyncSource(VSYNC_SOURCE_SIMULATED), VSYNC_SOURCE_SIMULATED);
+
+    CpuCompositorConfig config = {};
+    config.eyeWidth = EYE_SIZE;
+    config.eyeHeight = EYE_SIZE;
+    for (XrFovf& fov : config.eyeFov) {
+        fov = {-0.78f, 0.78f, 0.78f, -0.78f};
+    }
+    config.threadCount = 2;
+    config.resolveImage = ResolveSwapchainHostImage;
+    config.context = GetGraphicsBackend();
+    CpuCompositorBackend compositor(config);
+    ASSERT_TRUE(StartCompositor(&compositor));
+
+    // Warm-up: arenas, worker threads and the logger settle. Failures only
+    // end the loop, so the compositor is always stopped below.
+    FrameLoop loop;
+    bool ok = loop.Create();
+    for (int i = 0; i < 30 && ok; ++i) {
+        ok = loop.RunFrame();
+    }
+
+    g_allocations = 0;
+    g_countAllocations = true;
+    int frames = 0;
+    for (; frames < 60 && ok; ++frames) {
+        ok = loop.RunFrame();
+    }
+    g_countAllocations = false;
+    uint64_t allocations = g_allocations.load();
+
+    CompositorStats stats;
+    GetCompositorStats(&stats);
+    StopCompositor();
+    loop.Destroy();
+    StopVsyncSource();
+
+    printf("[ BENCH    ] %d frames, %llu compositions: %llu heap allocations\n", frames,
+           static_cast<unsigned long long>(stats.composedFrames), static_cast<unsigned long long>(allocations));
+    ASSERT_TRUE(ok);
+    EXPECT_GT(stats.composedFrames, 30u);
+    EXPECT_EQ(allocations, 0u);
+}
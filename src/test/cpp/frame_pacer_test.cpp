@@ -0,0 +1,167 @@
+#include "platform/frame_pacer.h"
+#include "platform/vsync_source.h"
+#include "openxr/handle_table.h"
+#include "openxr/session.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+extern HandleTable<XRSession, XrSession> g_sessions;
+
+class FramePacerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(StartVsyncSource(VSYNC_SOURCE_SIMULATED), VSYNC_SOURCE_SIMULATED);
+    }
+
+    void TearDown() override {
+        StopVsyncSource();
+    }
+};
+
+static int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TEST_F(FramePacerTest, DisplayTimesFollowTheVsyncGrid) {
+    FramePacer pacer;
+    ResetFramePacer(&pacer);
+
+    XrTime previous = 0;
+    for (int frame = 0; frame < 30; ++frame) {
+        XrTime displayTime;
+        XrDuration period;
+        XrTime waitTime = NowNs();
+        ASSERT_TRUE(WaitForFramePacer(&pacer, &displayTime, &period));
+        XrTime wakeTime = NowNs();
+        ASSERT_GT(period, 0);
+        // Never a vsync that had already passed when the app asked
+        EXPECT_GT(displayTime, waitTime);
+
+        if (previous != 0) {
+            // Never the same vsync twice, and always on the grid
+            XrDuration step = displayTime - previous;
+            ASSERT_GE(step, period / 2);
+            XrDuration offGrid = step % period;
+            offGrid = std::min(offGrid, period - offGrid);
+            EXPECT_LT(offGrid, period / 10) << "frame " << frame;
+        }
+        previous = displayTime;
+        EndFramePacerFrame(&pacer, wakeTime);
+    }
+}
+
+TEST_F(FramePacerTest, CancelReleasesTheWaitingThread) {
+    FramePacer pacer;
+    ResetFramePacer(&pacer);
+
+    std::atomic<bool> returned(false);
+    std::thread frameThread([&]() {
+        XrTime displayTime;
+        XrDuration period;
+        while (WaitForFramePacer(&pacer, &displayTime, &period)) {
+        }
+        returned = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CancelFramePacer(&pacer);
+    frameThread.join();
+    EXPECT_TRUE(returned);
+}
+
+// Timing benchmarks; disabled by default, see README
+class FramePacerBenchmark : public FramePacerTest {};
+
+namespace {
+
+struct PacedLookups {
+    std::vector<int64_t> latencies;  // Sorted
+    uint32_t framesPaced;
+    uint64_t lookupsDuringWait;  // Started and finished while the frame thread waited
+};
+
+// A frame thread paces frames on a session's pacer while this thread looks
+// the session handle up for 'runNs'
+PacedLookups LookUpWhilePacing(int64_t runNs) {
+    PacedLookups result = {};
+    XrSession handle = g_sessions.Insert(std::make_shared<XRSession>(XR_NULL_HANDLE));
+    EXPECT_NE(handle, XR_NULL_HANDLE);
+    XRSession* session = g_sessions.Lookup(handle);
+    if (!session) {
+        return result;
+    }
+    ResetFramePacer(&session->framePacer);
+
+    std::atomic<bool> running(true);
+    std::atomic<bool> waiting(false);
+    std::atomic<uint32_t> framesPaced(0);
+    std::thread frameThread([&]() {
+        while (running.load(std::memory_order_acquire)) {
+            XRSession* paced = g_sessions.Lookup(handle);
+            XrTime displayTime;
+            XrDuration period;
+            waiting = true;
+            bool pacedOk = paced && WaitForFramePacer(&paced->framePacer, &displayTime, &period);
+            waiting = false;
+            if (!pacedOk) {
+                break;
+            }
+            framesPaced++;
+        }
+    });
+
+    result.latencies.reserve(1 << 20);
+    int64_t start = NowNs();
+    while (NowNs() - start < runNs) {
+        bool waitingBefore = waiting.load();
+        int64_t before = NowNs();
+        XRSession* found = g_sessions.Lookup(handle);
+        result.latencies.push_back(NowNs() - before);
+        EXPECT_EQ(found, session);
+        if (waitingBefore && waiting.load()) {
+            result.lookupsDuringWait++;
+        }
+    }
+
+    running = false;
+    CancelFramePacer(&session->framePacer);
+    frameThread.join();
+    g_sessions.Remove(handle);
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    result.framesPaced = framesPaced.load();
+    return result;
+}
+
+}  // namespace
+
+// xrWaitFrame blocks on the session's own pacer, so threads validating the
+// same session handle (input, spaces) are never held up by the wait
+TEST_F(FramePacerTest, HandleLookupsDoNotStallBehindFrameWait) {
+    // The frame thread spends almost all of this asleep in the pacer
+    PacedLookups run = LookUpWhilePacing(100000000);  // 100 ms, ~9 vsyncs
+
+    EXPECT_GE(run.framesPaced, 3u);
+    // A lookup held behind the wait could only finish once the frame
+    // thread left it; these went through while it was inside
+    EXPECT_GT(run.lookupsDuringWait, 100u * run.framesPaced);
+}
+
+TEST_F(FramePacerBenchmark, DISABLED_HandleLookupLatencyWhileFramesArePaced) {
+    PacedLookups run = LookUpWhilePacing(200000000);  // 200 ms, ~18 vsyncs
+    ASSERT_FALSE(run.latencies.empty());
+
+    const std::vector<int64_t>& latencies = run.latencies;
+    int64_t p50 = latencies[latencies.size() / 2];
+    int64_t p99 = latencies[latencies.size() * 99 / 100];
+    printf("[ BENCH    ] %zu lookups while %u frames were paced: p50 %lld ns, p99 %lld ns, max %lld ns\n",
+           latencies.size(), run.framesPaced, static_cast<long long>(p50), static_cast<long long>(p99),
+           static_cast<long long>(latencies.back()));
+    EXPECT_GE(run.framesPaced, 5u);
+}
@@ -0,0 +1,97 @@
+#include "host_xr2_platform.h"
+#include "platform/frame_telemetry.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+const XrDuration PERIOD = 11111111;  // 90 Hz
+const XrDuration MS = 1000000;
+
+// Frames stamped on a stopped host clock, so every duration is exact
+class FrameTelemetryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ResetFrameTelemetry();
+    }
+
+    void TearDown() override {
+        SetHostCurrentTime(0);
+        ResetFrameTelemetry();
+    }
+
+    // Waits at 'wake', ends 'appTime' later, for display at 'displayTime'
+    static void RunFrame(uint64_t frameId, XrTime wake, XrDuration appTime, XrTime displayTime) {
+        SetHostCurrentTime(wake);
+        BeginFrameTiming(frameId, displayTime, PERIOD);
+        SetHostCurrentTime(wake + appTime);
+        RecordFrameEvent(frameId, FRAME_EVENT_END);
+    }
+};
+
+}  // namespace
+
+TEST_F(FrameTelemetryTest, AppTimePercentilesAreNearestRank) {
+    // App times of 1..100 ms, one frame per vsync
+    const XrTime start = 1000 * MS;
+    for (uint64_t frameId = 1; frameId <= 100; ++frameId) {
+        XrTime wake = start + static_cast<XrTime>(frameId) * 200 * MS;
+        RunFrame(frameId, wake, static_cast<XrDuration>(frameId) * MS, wake + 150 * MS);
+    }
+
+    FrameTimingStats stats;
+    GetFrameTimingStats(&stats);
+    EXPECT_EQ(stats.frameCount, 100u);
+    EXPECT_EQ(stats.appCpu.count, 100u);
+    EXPECT_EQ(stats.appCpu.p50, 50 * MS);
+    EXPECT_EQ(stats.appCpu.p90, 90 * MS);
+    EXPECT_EQ(stats.appCpu.p99, 99 * MS);
+    EXPECT_EQ(stats.appCpu.max, 100 * MS);
+    EXPECT_FLOAT_EQ(stats.frameRate, 5.0f);
+
+    // No vsync yet: no compositor or latency samples
+    EXPECT_EQ(stats.compositor.count, 0u);
+    EXPECT_EQ(stats.latency.count, 0u);
+}
+
+TEST_F(FrameTelemetryTest, DropCausesAreCountedApart) {
+    const XrTime display = 1000 * MS;
+
+    // Shown at its vsync, 1 ms after the compositor picked it up
+    RunFrame(1, display - 2 * PERIOD, 5 * MS, display);
+    SetHostCurrentTime(display - MS);
+    RecordFrameEvent(1, FRAME_EVENT_COMPOSITOR_PICKUP);
+    RecordDisplayVsync(display);
+
+    // Ended in time, but the next vsync is a period after its own
+    RunFrame(2, display - PERIOD, 5 * MS, display + PERIOD);
+    RecordDisplayVsync(display + 2 * PERIOD);
+
+    // Ended after its predicted display time; counted at xrEndFrame only
+    RunFrame(3, display + PERIOD, 2 * PERIOD, display + 2 * PERIOD);
+    RecordDisplayVsync(display + 3 * PERIOD);
+
+    RecordFrameDrop(FRAME_DROP_DISCARDED);
+    RecordFrameDrop(FRAME_DROP_QUEUE_FULL);
+    RecordFrameDrop(FRAME_DROP_QUEUE_FULL);
+
+    FrameTimingStats stats;
+    GetFrameTimingStats(&stats);
+    EXPECT_EQ(stats.drops[FRAME_DROP_DISCARDED], 1u);
+    EXPECT_EQ(stats.drops[FRAME_DROP_LATE_SUBMIT], 1u);
+    EXPECT_EQ(stats.drops[FRAME_DROP_MISSED_VSYNC], 1u);
+    EXPECT_EQ(stats.drops[FRAME_DROP_QUEUE_FULL], 2u);
+
+    // Wait return to vsync: 2, 3 and 2 periods
+    EXPECT_EQ(stats.latency.count, 3u);
+    EXPECT_EQ(stats.latency.p50, 2 * PERIOD);
+    EXPECT_EQ(stats.latency.max, 3 * PERIOD);
+    EXPECT_EQ(stats.compositor.count, 1u);
+    EXPECT_EQ(stats.compositor.max, MS);
+
+    ResetFrameTelemetry();
+    GetFrameTimingStats(&stats);
+    EXPECT_EQ(stats.frameCount, 0u);
+    for (uint64_t drops : stats.drops) {
+        EXPECT_EQ(drops, 0u);
+    }
+}
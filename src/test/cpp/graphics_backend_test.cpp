@@ -0,0 +1,271 @@
+#include "openxr/openxr_api.h"
+#include "openxr/handle_table.h"
+#include "openxr/session.h"
+#include "openxr/swapchain.h"
+#include "platform/compositor.h"
+#include "platform/display_manager.h"
+#include "platform/host_graphics_backend.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+
+extern HandleTable<XRSession, XrSession> g_sessions;
+extern HandleTable<XRSwapchain, XrSwapchain> g_swapchains;
+
+namespace {
+
+SwapchainImageDesc MakeDesc(uint32_t width, uint32_t height, uint32_t arraySize) {
+    SwapchainImageDesc desc = {};
+    desc.width = width;
+    desc.height = height;
+    desc.format = HOST_FORMAT_RGBA8;
+    desc.sampleCount = 1;
+    desc.arraySize = arraySize;
+    desc.mipCount = 1;
+    return desc;
+}
+
+void Fill(const HostImage& image, uint32_t rgba) {
+    for (uint32_t y = 0; y < image.height; ++y) {
+        uint8_t* row = image.pixels + static_cast<size_t>(y) * image.stride;
+        for (uint32_t x = 0; x < image.width; ++x) {
+            memcpy(row + x * 4, &rgba, 4);
+        }
+    }
+}
+
+uint32_t TexelAt(const HostImage& image, uint32_t x, uint32_t y) {
+    uint32_t rgba;
+    memcpy(&rgba, image.pixels + static_cast<size_t>(y) * image.stride + x * 4, 4);
+    return rgba;
+}
+
+// The app's side of one swapchain of the current graphics backend: render
+// a solid color and release it, so the compositor can pin it
+class HostSwapchainTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        session_ = g_sessions.Insert(std::make_shared<XRSession>(XR_NULL_HANDLE));
+        ASSERT_NE(session_, XR_NULL_HANDLE);
+
+        XrSwapchainCreateInfo createInfo = {};
+        createInfo.type = XR_TYPE_SWAPCHAIN_CREATE_INFO;
+        createInfo.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+        createInfo.format = HOST_FORMAT_RGBA8;
+        createInfo.sampleCount = 1;
+        createInfo.width = 32;
+        createInfo.height = 16;
+        createInfo.faceCount = 1;
+        createInfo.arraySize = 2;
+        createInfo.mipCount = 1;
+        ASSERT_EQ(xrCreateSwapchain(session_, &createInfo, &swapchain_), XR_SUCCESS);
+    }
+
+    void TearDown() override {
+        if (swapchain_ != XR_NULL_HANDLE) {
+            xrDestroySwapchain(swapchain_);
+        }
+        g_sessions.Remove(session_);
+    }
+
+    // Layer 0 gets 'rgba', layer 1 its complement
+    void Render(uint32_t rgba) {
+        XrSwapchainImageAcquireInfo acquireInfo = {};
+        acquireInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO;
+        XrSwapchainImageWaitInfo waitInfo = {};
+        waitInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO;
+        waitInfo.timeout = XR_INFINITE_DURATION;
+        XrSwapchainImageReleaseInfo releaseInfo = {};
+        releaseInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO;
+
+        uint32_t index;
+        ASSERT_EQ(xrAcquireSwapchainImage(swapchain_, &acquireInfo, &index), XR_SUCCESS);
+        ASSERT_EQ(xrWaitSwapchainImage(swapchain_, &waitInfo), XR_SUCCESS);
+        XRSwapchain* xrSwapchain = g_swapchains.Lookup(swapchain_);
+        ASSERT_NE(xrSwapchain, nullptr);
+        for (uint32_t layer = 0; layer < 2; ++layer) {
+            HostImage image;
+            ASSERT_TRUE(GetGraphicsBackend()->MapImage(xrSwapchain->textures[index], layer, &image));
+            Fill(image, layer == 0 ? rgba : ~rgba);
+        }
+        ASSERT_EQ(xrReleaseSwapchainImage(swapchain_, &releaseInfo), XR_SUCCESS);
+    }
+
+    // What xrEndFrame hands the compositor for one view of the swapchain
+    CompositorView Pin(uint32_t imageArrayIndex) {
+        CompositorView view = {};
+        view.swapchain = swapchain_;
+        view.imageIndex = SWAPCHAIN_NO_IMAGE;
+        view.imageArrayIndex = imageArrayIndex;
+        EXPECT_TRUE(PinSwapchainImage(swapchain_, &view.pinned, &view.imageIndex));
+        return view;
+    }
+
+    XrSession session_ = XR_NULL_HANDLE;
+    XrSwapchain swapchain_ = XR_NULL_HANDLE;
+};
+
+}  // namespace
+
+TEST(HostGraphicsBackendTest, ImagesAreMappedPerLayer) {
+    HostGraphicsBackend backend;
+    uint32_t texture;
+    ASSERT_TRUE(backend.CreateTextures(MakeDesc(8, 4, 2), 1, &texture));
+    EXPECT_NE(texture, 0u);
+    EXPECT_EQ(backend.TextureBytes(MakeDesc(8, 4, 2)), 8u * 4 * 4 * 2);
+
+    HostImage layers[2];
+    ASSERT_TRUE(backend.MapImage(texture, 0, &layers[0]));
+    ASSERT_TRUE(backend.MapImage(texture, 1, &layers[1]));
+    EXPECT_EQ(layers[0].width, 8u);
+    EXPECT_EQ(layers[0].height, 4u);
+    EXPECT_EQ(layers[0].stride, 32u);
+    EXPECT_EQ(layers[1].pixels, layers[0].pixels + 8 * 4 * 4);
+    EXPECT_EQ(TexelAt(layers[1], 7, 3), 0u);  // Zero-filled
+
+    HostImage image;
+    EXPECT_FALSE(backend.MapImage(texture, 2, &image));
+    EXPECT_FALSE(backend.MapImage(texture + 1, 0, &image));
+
+    backend.DestroyTextures(&texture, 1);
+    EXPECT_FALSE(backend.MapImage(texture, 0, &image));
+    EXPECT_EQ(backend.GetImageCount(), 0u);
+}
+
+TEST(HostGraphicsBackendTest, UnsupportedFormatIsRejected) {
+    HostGraphicsBackend backend;
+    SwapchainImageDesc desc = MakeDesc(8, 8, 1);
+    desc.format = 0x881A;  // GL_RGBA16F
+    uint32_t texture;
+    EXPECT_FALSE(backend.CreateTextures(desc, 1, &texture));
+}
+
+TEST(HostGraphicsBackendTest, BlitScalesAndClips) {
+    HostGraphicsBackend backend;
+    uint32_t textures[2];
+    ASSERT_TRUE(backend.CreateTextures(MakeDesc(4, 4, 1), 1, &textures[0]));
+    ASSERT_TRUE(backend.CreateTextures(MakeDesc(8, 8, 1), 1, &textures[1]));
+    HostImage source, destination;
+    ASSERT_TRUE(backend.MapImage(textures[0], 0, &source));
+    ASSERT_TRUE(backend.MapImage(textures[1], 0, &destination));
+    for (uint32_t y = 0; y < 4; ++y) {
+        for (uint32_t x = 0; x < 4; ++x) {
+            uint32_t rgba = 0xff000000u | (y << 8) | x;
+            memcpy(source.pixels + y * source.stride + x * 4, &rgba, 4);
+        }
+    }
+
+    // 4x4 to 8x8: every texel doubled
+    GraphicsImageRegion from = {textures[0], 0, {{0, 0}, {4, 4}}};
+    GraphicsImageRegion to = {textures[1], 0, {{0, 0}, {8, 8}}};
+    ASSERT_TRUE(backend.BlitImage(from, to));
+    EXPECT_EQ(TexelAt(destination, 0, 0), 0xff000000u);
+    EXPECT_EQ(TexelAt(destination, 5, 2), 0xff000102u);
+    EXPECT_EQ(TexelAt(destination, 7, 7), 0xff000303u);
+
+    // Off the edge: only the part inside the image is copied
+    Fill(destination, 0);
+    to.rect = {{6, 6}, {4, 4}};
+    ASSERT_TRUE(backend.BlitImage(from, to));
+    EXPECT_EQ(TexelAt(destination, 6, 6), 0xff000000u);
+    EXPECT_EQ(TexelAt(destination, 7, 7), 0xff000101u);
+    EXPECT_EQ(TexelAt(destination, 5, 5), 0u);
+
+    to.rect = {{-2, -2}, {4, 4}};
+    ASSERT_TRUE(backend.BlitImage(from, to));
+    EXPECT_EQ(TexelAt(destination, 0, 0), 0xff000202u);
+    EXPECT_EQ(TexelAt(destination, 1, 1), 0xff000303u);
+    EXPECT_EQ(TexelAt(destination, 2, 2), 0u);
+
+    // Scaled and clipped: the scale is that of the requested rects
+    Fill(destination, 0);
+    to.rect = {{4, 4}, {8, 8}};
+    ASSERT_TRUE(backend.BlitImage(from, to));
+    EXPECT_EQ(TexelAt(destination, 4, 4), 0xff000000u);
+    EXPECT_EQ(TexelAt(destination, 7, 7), 0xff000101u);
+
+    to.rect = {{8, 0}, {4, 4}};
+    EXPECT_FALSE(backend.BlitImage(from, to));
+    backend.DestroyTextures(textures, 2);
+}
+
+TEST(HostGraphicsBackendTest, FencesAreSignalledAtOnce) {
+    HostGraphicsBackend backend;
+    GraphicsFence first = backend.CreateFence();
+    GraphicsFence second = backend.CreateFence();
+    EXPECT_NE(first, GRAPHICS_NO_FENCE);
+    EXPECT_NE(first, second);
+    EXPECT_TRUE(backend.WaitFence(first, 0));
+    backend.DestroyFence(first);
+    backend.DestroyFence(second);
+}
+
+TEST_F(HostSwapchainTest, ResolveMapsThePinnedImageAndLayer) {
+    Render(0xff0000ffu);
+    CompositorView left = Pin(0);
+    CompositorView right = Pin(1);
+
+    // Rendered again while the compositor holds the first image
+    Render(0xff00ff00u);
+
+    HostImage image;
+    ASSERT_TRUE(ResolveSwapchainHostImage(GetGraphicsBackend(), left, &image));
+    EXPECT_EQ(image.width, 32u);
+    EXPECT_EQ(image.height, 16u);
+    EXPECT_EQ(TexelAt(image, 31, 15), 0xff0000ffu);
+    ASSERT_TRUE(ResolveSwapchainHostImage(GetGraphicsBackend(), right, &image));
+    EXPECT_EQ(TexelAt(image, 0, 0), ~0xff0000ffu);
+
+    UnpinSwapchainImage(left.pinned, left.imageIndex);
+    UnpinSwapchainImage(right.pinned, right.imageIndex);
+}
+
+TEST_F(HostSwapchainTest, ViewsOfAnotherBackendAreSkipped) {
+    Render(0xff0000ffu);
+    CompositorView view = Pin(0);
+
+    HostGraphicsBackend other;
+    HostImage image;
+    EXPECT_FALSE(ResolveSwapchainHostImage(&other, view, &image));
+    UnpinSwapchainImage(view.pinned, view.imageIndex);
+
+    // Nothing pinned for the view
+    CompositorView unpinned = {};
+    unpinned.swapchain = swapchain_;
+    unpinned.imageIndex = SWAPCHAIN_NO_IMAGE;
+    EXPECT_FALSE(ResolveSwapchainHostImage(GetGraphicsBackend(), unpinned, &image));
+}
+
+// The app destroys a swapchain right after submitting a frame that shows
+// it: the compositor still composes the frame, and the images only go back
+// to the pool once it is done and the app's graphics thread flushes them
+TEST_F(HostSwapchainTest, DestroyedSwapchainStaysMappableUntilUnpinned) {
+    Render(0xff0000ffu);
+    CompositorView view = Pin(0);
+    uint32_t imageCount = view.pinned->imageCount;
+
+    TexturePoolStats before;
+    GetSwapchainImagePoolStats(&before);
+    ASSERT_EQ(xrDestroySwapchain(swapchain_), XR_SUCCESS);
+    swapchain_ = XR_NULL_HANDLE;
+
+    HostImage image;
+    ASSERT_TRUE(ResolveSwapchainHostImage(GetGraphicsBackend(), view, &image));
+    EXPECT_EQ(TexelAt(image, 0, 0), 0xff0000ffu);
+
+    TexturePoolStats stillPinned;
+    GetSwapchainImagePoolStats(&stillPinned);
+    EXPECT_EQ(stillPinned.texturesHeld, before.texturesHeld);
+
+    // The compositor's unpin drops the last reference but deletes nothing
+    // on its own thread
+    UnpinSwapchainImage(view.pinned, view.imageIndex);
+    TexturePoolStats unpinned;
+    GetSwapchainImagePoolStats(&unpinned);
+    EXPECT_EQ(unpinned.texturesHeld, before.texturesHeld);
+
+    FlushDeferredSwapchainDeletes();
+    TexturePoolStats flushed;
+    GetSwapchainImagePoolStats(&flushed);
+    EXPECT_EQ(flushed.texturesHeld, before.texturesHeld + imageCount);
+}
@@ -0,0 +1,194 @@
+#include "openxr/handle_table.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct TestObject {
+    uint64_t id;
+    std::atomic<uint64_t> handle;  // Set once the table has issued it
+    explicit TestObject(uint64_t objectId) : id(objectId), handle(0) {}
+};
+
+typedef HandleTable<TestObject, XrSpace> TestTable;
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+TEST(HandleTableTest, InsertLookupRemove) {
+    TestTable table(HANDLE_TYPE_SPACE, 4);
+    XrSpace handle = table.Insert(std::make_shared<TestObject>(7));
+    ASSERT_NE(handle, XR_NULL_HANDLE);
+    ASSERT_NE(table.Lookup(handle), nullptr);
+    EXPECT_EQ(table.Lookup(handle)->id, 7u);
+    EXPECT_EQ(table.Acquire(handle)->id, 7u);
+    EXPECT_EQ(table.First(), handle);
+
+    std::shared_ptr<TestObject> removed = table.Remove(handle);
+    ASSERT_NE(removed, nullptr);
+    EXPECT_EQ(removed->id, 7u);
+    EXPECT_EQ(table.Lookup(handle), nullptr);
+    EXPECT_EQ(table.Acquire(handle), nullptr);
+    EXPECT_EQ(table.Remove(handle), nullptr);
+    EXPECT_EQ(table.First(), XR_NULL_HANDLE);
+}
+
+TEST(HandleTableTest, RecycledSlotRejectsStaleHandle) {
+    TestTable table(HANDLE_TYPE_SPACE, 1);
+    XrSpace first = table.Insert(std::make_shared<TestObject>(1));
+    table.Remove(first);
+    XrSpace second = table.Insert(std::make_shared<TestObject>(2));
+
+    ASSERT_NE(second, XR_NULL_HANDLE);
+    EXPECT_EQ(HandleSlotIndex(first), HandleSlotIndex(second));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(table.Lookup(first), nullptr);
+    EXPECT_EQ(table.Acquire(first), nullptr);
+    EXPECT_EQ(table.Lookup(second)->id, 2u);
+}
+
+TEST(HandleTableTest, RejectsForeignAndOutOfRangeHandles) {
+    TestTable table(HANDLE_TYPE_SPACE, 2);
+    XrSpace handle = table.Insert(std::make_shared<TestObject>(1));
+    uint64_t value = HandleToValue(handle);
+
+    // Same slot and generation, wrong type tag
+    uint64_t foreign = (value & ~(0xFFULL << HANDLE_TYPE_SHIFT)) |
+                       (static_cast<uint64_t>(HANDLE_TYPE_SESSION) << HANDLE_TYPE_SHIFT);
+    EXPECT_EQ(table.Lookup(ValueToHandle<XrSpace>(foreign)), nullptr);
+    EXPECT_EQ(table.Lookup(ValueToHandle<XrSpace>(value | HANDLE_INDEX_MASK)), nullptr);
+    EXPECT_EQ(table.Lookup(XR_NULL_HANDLE), nullptr);
+}
+
+TEST(HandleTableTest, FullTableReturnsNullHandle) {
+    TestTable table(HANDLE_TYPE_SPACE, 2);
+    XrSpace a = table.Insert(std::make_shared<TestObject>(1));
+    XrSpace b = table.Insert(std::make_shared<TestObject>(2));
+    ASSERT_NE(a, XR_NULL_HANDLE);
+    ASSERT_NE(b, XR_NULL_HANDLE);
+    EXPECT_EQ(table.Insert(std::make_shared<TestObject>(3)), XR_NULL_HANDLE);
+
+    table.Remove(a);
+    EXPECT_NE(table.Insert(std::make_shared<TestObject>(4)), XR_NULL_HANDLE);
+}
+
+TEST(HandleTableTest, ClearInvalidatesEveryHandle) {
+    TestTable table(HANDLE_TYPE_SPACE, 8);
+    std::vector<XrSpace> handles;
+    std::weak_ptr<TestObject> watched;
+    for (uint64_t i = 0; i < 8; ++i) {
+        std::shared_ptr<TestObject> object = std::make_shared<TestObject>(i);
+        if (i == 0) {
+            watched = object;
+        }
+        handles.push_back(table.Insert(std::move(object)));
+    }
+
+    table.Clear();
+    for (XrSpace handle : handles) {
+        EXPECT_EQ(table.Lookup(handle), nullptr);
+    }
+    EXPECT_TRUE(watched.expired());
+    EXPECT_EQ(table.First(), XR_NULL_HANDLE);
+}
+
+// Writers churn half the table while readers validate both a long-lived
+// handle and handles that are being destroyed under them: a reader must get
+// the object the handle was issued for or nothing, never a slot's next
+// occupant, and the long-lived lookups must not queue behind the writers
+TEST(HandleTableTest, ReadersRaceWritersWithoutMixingUpObjects) {
+    const uint32_t capacity = 64;
+    const uint32_t writerCount = 2;
+    const uint32_t readerCount = 2;
+    TestTable table(HANDLE_TYPE_SPACE, capacity);
+
+    XrSpace stable = table.Insert(std::make_shared<TestObject>(~0ULL));
+
+    // Handles the writers currently own, one per entry
+    std::vector<std::atomic<uint64_t>> published(capacity / 2);
+    for (std::atomic<uint64_t>& entry : published) {
+        entry = 0;
+    }
+
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> mismatches(0);
+    std::atomic<uint64_t> churned(0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < writerCount; ++w) {
+        threads.emplace_back([&, w]() {
+            while (running.load(std::memory_order_relaxed)) {
+                for (size_t i = w; i < published.size(); i += writerCount) {
+                    std::shared_ptr<TestObject> object = std::make_shared<TestObject>(i);
+                    TestObject* raw = object.get();
+                    XrSpace handle = table.Insert(std::move(object));
+                    if (handle == XR_NULL_HANDLE) {
+                        continue;
+                    }
+                    raw->handle = HandleToValue(handle);
+                    uint64_t old = published[i].exchange(HandleToValue(handle));
+                    if (old != 0) {
+                        table.Remove(ValueToHandle<XrSpace>(old));
+                    }
+                    churned++;
+                }
+            }
+        });
+    }
+
+    std::vector<std::vector<int64_t>> latencies(readerCount);
+    for (uint32_t r = 0; r < readerCount; ++r) {
+        threads.emplace_back([&, r]() {
+            std::vector<int64_t>& samples = latencies[r];
+            samples.reserve(1 << 20);
+            size_t i = r;
+            while (running.load(std::memory_order_relaxed)) {
+                int64_t before = NowNs();
+                TestObject* object = table.Lookup(stable);
+                int64_t after = NowNs();
+                if (!object || object->id != ~0ULL) {
+                    mismatches++;
+                }
+                if (samples.size() < samples.capacity()) {
+                    samples.push_back(after - before);
+                }
+
+                // Often already destroyed, and its slot possibly reused
+                uint64_t value = published[i++ % published.size()].load();
+                std::shared_ptr<TestObject> churning = table.Acquire(ValueToHandle<XrSpace>(value));
+                if (churning && churning->handle.load() != value) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    running = false;
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int64_t> all;
+    for (const std::vector<int64_t>& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+    ASSERT_FALSE(all.empty());
+    printf("[ BENCH    ] %zu lookups against %llu inserts/removes: p50 %lld ns, p99 %lld ns\n",
+           all.size(), static_cast<unsigned long long>(churned.load()),
+           static_cast<long long>(all[all.size() / 2]), static_cast<long long>(all[all.size() * 99 / 100]));
+
+    EXPECT_EQ(mismatches.load(), 0u);
+    EXPECT_GT(churned.load(), 0u);
+    EXPECT_EQ(table.Lookup(stable)->id, ~0ULL);
+}
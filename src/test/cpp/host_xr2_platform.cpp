@@ -0,0 +1,158 @@
+// The XR2 platform calls made by the host-built runtime modules, without a
+// QVR device: the clock is steady_clock like on the device, and there is no
+// display vsync, so the vsync source falls back to the simulated one.
+
+#include "host_xr2_platform.h"
+#include "openxr/handle_table.h"
+#include "openxr/instance.h"
+#include "openxr/session.h"
+#include "utils/spsc_ring.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// The instance and session modules are not built for the host; the input
+// and swapchain modules only need the tables
+HandleTable<XRInstance, XrInstance> g_instances(HANDLE_TYPE_INSTANCE, 4);
+HandleTable<XRSession, XrSession> g_sessions(HANDLE_TYPE_SESSION, 4);
+
+// Controller samples queued by the test instead of the sampling thread
+static const uint32_t HOST_INPUT_SAMPLE_RING_SIZE = 256;
+static SpscRing<XR2ControllerInput, HOST_INPUT_SAMPLE_RING_SIZE> g_hostInputSampleRings[2];
+static std::mutex g_hostControllerMutex;
+static XR2ControllerInput g_hostControllerInputs[2] = {};
+
+bool PushHostInputSample(uint32_t controllerIndex, const XR2ControllerInput& sample) {
+    if (controllerIndex >= 2) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_hostControllerMutex);
+        g_hostControllerInputs[controllerIndex] = sample;
+    }
+    return g_hostInputSampleRings[controllerIndex].Push(sample);
+}
+
+void ResetHostInput() {
+    std::lock_guard<std::mutex> lock(g_hostControllerMutex);
+    for (uint32_t i = 0; i < 2; ++i) {
+        g_hostInputSampleRings[i].Clear();
+        g_hostControllerInputs[i] = XR2ControllerInput();
+    }
+}
+
+static std::atomic<XrTime> g_hostCurrentTime(0);
+
+void SetHostCurrentTime(XrTime time) {
+    g_hostCurrentTime.store(time);
+}
+
+XrTime GetXR2CurrentTime() {
+    XrTime fixed = g_hostCurrentTime.load(std::memory_order_relaxed);
+    if (fixed != 0) {
+        return fixed;
+    }
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+}
+
+bool GetXR2VsyncTiming(XrTime* /*lastVsyncTime*/, XrDuration* /*nominalPeriod*/) {
+    return false;
+}
+
+bool SetXR2VsyncCallback(bool /*enable*/) {
+    return false;
+}
+
+void ScheduleXR2Frame(XrTime /*predictedDisplayTime*/) {
+}
+
+bool BeginXR2FrameRendering() {
+    return true;
+}
+
+bool EndXR2FrameRendering() {
+    return true;
+}
+
+CompositorBackend* GetXR2CompositorBackend() {
+    return nullptr;
+}
+
+bool SetXR2OperatingLevels(uint32_t /*cpuLevel*/, uint32_t /*gpuLevel*/) {
+    return true;
+}
+
+bool GetXR2DisplayProperties(uint32_t* recommendedWidth, uint32_t* recommendedHeight,
+                             uint32_t* maxWidth, uint32_t* maxHeight) {
+    *recommendedWidth = 1024;
+    *recommendedHeight = 1024;
+    *maxWidth = 2048;
+    *maxHeight = 2048;
+    return true;
+}
+
+bool CompileXR2InputBinding(const ParsedInputPath& /*parsed*/, InputBindingDesc* /*binding*/) {
+    return false;
+}
+
+bool SyncXR2InputActions() {
+    return true;
+}
+
+bool GetXR2ControllerInputs(XR2ControllerInput* inputs, uint32_t count) {
+    std::lock_guard<std::mutex> lock(g_hostControllerMutex);
+    for (uint32_t i = 0; i < count && i < 2; ++i) {
+        inputs[i] = g_hostControllerInputs[i];
+    }
+    return true;
+}
+
+// Same policy as the device: keep the newest samples when far behind
+uint32_t DrainXR2InputSamples(uint32_t controllerIndex, XR2ControllerInput* samples, uint32_t maxSamples) {
+    if (controllerIndex >= 2 || !samples) {
+        return 0;
+    }
+
+    auto& ring = g_hostInputSampleRings[controllerIndex];
+    XR2ControllerInput discarded;
+    uint32_t queued = ring.Size();
+    while (queued > maxSamples && ring.Pop(&discarded)) {
+        queued--;
+    }
+
+    uint32_t count = 0;
+    while (count < maxSamples && ring.Pop(&samples[count])) {
+        count++;
+    }
+    return count;
+}
+
+bool GetXR2BooleanInput(const XR2ControllerInput& input, const InputBindingDesc& binding) {
+    if (binding.buttonBit != 0) {
+        return (input.buttonState & binding.buttonBit) != 0;
+    }
+    return input.buttonState != 0;
+}
+
+float GetXR2FloatInput(const XR2ControllerInput& input, const InputBindingDesc& binding) {
+    if (binding.component == INPUT_COMPONENT_X) {
+        return input.analog2D[binding.analog2DIndex].x;
+    } else if (binding.component == INPUT_COMPONENT_Y) {
+        return input.analog2D[binding.analog2DIndex].y;
+    }
+    return input.analog1D[binding.analog1DIndex];
+}
+
+XrVector2f GetXR2Vector2fInput(const XR2ControllerInput& input, const InputBindingDesc& binding) {
+    return input.analog2D[binding.analog2DIndex];
+}
+
+bool GetXR2ActionPose(uint32_t /*controllerIndex*/, XrTime /*time*/,
+                      XrPosef* /*pose*/, XrSpaceLocationFlags* /*locationFlags*/) {
+    return false;
+}
+
+bool GetXR2CurrentInteractionProfile(XrPath /*topLevelUserPath*/, XrPath* /*interactionProfile*/) {
+    return false;
+}
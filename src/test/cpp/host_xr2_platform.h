@@ -0,0 +1,18 @@
+#ifndef HOST_XR2_PLATFORM_H
+#define HOST_XR2_PLATFORM_H
+
+#include "qualcomm/xr2_platform.h"
+
+// Test side of the host XR2 platform: stands in for the input sampling
+// thread. Queues a sample for the next sync and makes it the current
+// controller state; false when the ring is full (sample dropped).
+bool PushHostInputSample(uint32_t controllerIndex, const XR2ControllerInput& sample);
+
+// Empty the sample rings and disconnect both controllers
+void ResetHostInput();
+
+// Stop GetXR2CurrentTime at 'time' so timestamps are exact; 0 returns it to
+// steady_clock. Only while no runtime thread reads the clock.
+void SetHostCurrentTime(XrTime time);
+
+#endif // HOST_XR2_PLATFORM_H
@@ -0,0 +1,209 @@
+#include "host_xr2_platform.h"
+#include "openxr/action_state.h"
+#include "openxr/handle_table.h"
+#include "platform/input_manager.h"
+#include "utils/spsc_ring.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+namespace {
+
+const uint32_t TRIGGER_CLICK = 1u << 3;
+const uint32_t A_CLICK = 1u << 0;
+
+// One boolean action bound to the left trigger click, in action slot 0
+class InputSamplingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ResetHostInput();
+        bindings_ = std::make_shared<InputBindingTable>();
+        buffer_.reset(new ActionStateBuffer());
+
+        action_ = ValueToHandle<XrAction>((static_cast<uint64_t>(HANDLE_TYPE_ACTION) << HANDLE_TYPE_SHIFT) |
+                                          (1ULL << HANDLE_GENERATION_SHIFT));
+        ActionBindingSlot& slot = bindings_->actions[HandleSlotIndex(action_)];
+        slot.action = action_;
+        slot.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
+        slot.bindingCounts[0] = 1;
+        slot.listed = true;
+        slot.hands[0][0].controllerIndex = 0;
+        slot.hands[0][0].buttonBit = TRIGGER_CLICK;
+        bindings_->boundSlots.push_back(HandleSlotIndex(action_));
+    }
+
+    void TearDown() override {
+        ResetHostInput();
+    }
+
+    static XR2ControllerInput Sample(XrTime timestamp, bool pressed) {
+        return Sample(timestamp, pressed ? TRIGGER_CLICK : 0);
+    }
+
+    static XR2ControllerInput Sample(XrTime timestamp, uint32_t buttonState) {
+        XR2ControllerInput input = {};
+        input.timestamp = timestamp;
+        input.connected = true;
+        input.buttonState = buttonState;
+        return input;
+    }
+
+    ActionStateValue Sync() {
+        EXPECT_TRUE(SyncInputActions(*bindings_, buffer_.get()));
+        ActionStateValue value;
+        EXPECT_TRUE(GetActionStateValue(*bindings_, *buffer_, action_, XR_NULL_PATH, &value));
+        return value;
+    }
+
+    std::shared_ptr<InputBindingTable> bindings_;
+    std::unique_ptr<ActionStateBuffer> buffer_;
+    XrAction action_;
+};
+
+}  // namespace
+
+TEST_F(InputSamplingTest, ChangeTimeIsTheSampleEdgeNotTheSyncTime) {
+    PushHostInputSample(0, Sample(1000, false));
+    Sync();
+
+    PushHostInputSample(0, Sample(5000, true));
+    PushHostInputSample(0, Sample(6000, true));
+    PushHostInputSample(0, Sample(7000, true));
+    ActionStateValue value = Sync();
+
+    EXPECT_TRUE(value.isActive);
+    EXPECT_TRUE(value.booleanState);
+    EXPECT_TRUE(value.changedSinceLastSync);
+    EXPECT_EQ(value.lastChangeTime, 5000);
+}
+
+TEST_F(InputSamplingTest, TapBetweenSyncsIsLatchedForOneSync) {
+    PushHostInputSample(0, Sample(1000, false));
+    Sync();
+
+    // Pressed and released again before the app syncs
+    PushHostInputSample(0, Sample(2000, true));
+    PushHostInputSample(0, Sample(3000, false));
+    ActionStateValue tapped = Sync();
+    EXPECT_TRUE(tapped.booleanState);
+    EXPECT_TRUE(tapped.changedSinceLastSync);
+    EXPECT_EQ(tapped.lastChangeTime, 2000);
+
+    ActionStateValue released = Sync();
+    EXPECT_FALSE(released.booleanState);
+    EXPECT_TRUE(released.changedSinceLastSync);
+    EXPECT_EQ(released.lastChangeTime, 3000);
+
+    ActionStateValue idle = Sync();
+    EXPECT_FALSE(idle.booleanState);
+    EXPECT_FALSE(idle.changedSinceLastSync);
+}
+
+TEST_F(InputSamplingTest, IdleSamplerStillSyncsCurrentState) {
+    PushHostInputSample(0, Sample(1000, true));
+    ActionStateValue value = Sync();
+    EXPECT_TRUE(value.booleanState);
+
+    // Nothing queued: the current controller state is folded on its own
+    value = Sync();
+    EXPECT_TRUE(value.booleanState);
+    EXPECT_FALSE(value.changedSinceLastSync);
+    EXPECT_EQ(value.lastChangeTime, 1000);
+}
+
+// Bound to both the trigger and the A button on the left hand: either
+// press counts
+TEST_F(InputSamplingTest, BooleanBindingsOfOneHandAreOred) {
+    ActionBindingSlot& slot = bindings_->actions[HandleSlotIndex(action_)];
+    slot.hands[0][1].controllerIndex = 0;
+    slot.hands[0][1].buttonBit = A_CLICK;
+    slot.bindingCounts[0] = 2;
+
+    PushHostInputSample(0, Sample(1000, A_CLICK));
+    EXPECT_TRUE(Sync().booleanState);
+
+    PushHostInputSample(0, Sample(2000, TRIGGER_CLICK | A_CLICK));
+    EXPECT_TRUE(Sync().booleanState);
+
+    PushHostInputSample(0, Sample(3000, TRIGGER_CLICK));
+    EXPECT_TRUE(Sync().booleanState);
+
+    PushHostInputSample(0, Sample(4000, 0u));
+    EXPECT_FALSE(Sync().booleanState);
+}
+
+// Bound to the trigger and the grip value: the larger one wins
+TEST_F(InputSamplingTest, FloatBindingsOfOneHandTakeTheLargest) {
+    ActionBindingSlot& slot = bindings_->actions[HandleSlotIndex(action_)];
+    slot.actionType = XR_ACTION_TYPE_FLOAT_INPUT;
+    slot.hands[0][0] = {};
+    slot.hands[0][0].analog1DIndex = 0;
+    slot.hands[0][1] = {};
+    slot.hands[0][1].analog1DIndex = 1;
+    slot.bindingCounts[0] = 2;
+
+    XR2ControllerInput input = Sample(1000, 0u);
+    input.analog1D[0] = 0.25f;
+    input.analog1D[1] = 0.75f;
+    PushHostInputSample(0, input);
+    EXPECT_FLOAT_EQ(Sync().floatState, 0.75f);
+
+    input.timestamp = 2000;
+    input.analog1D[0] = 0.5f;
+    input.analog1D[1] = 0.0f;
+    PushHostInputSample(0, input);
+    ActionStateValue value = Sync();
+    EXPECT_FLOAT_EQ(value.floatState, 0.5f);
+    EXPECT_EQ(value.lastChangeTime, 2000);
+}
+
+TEST(SpscRingTest, DropsWhenFullAndKeepsOrder) {
+    SpscRing<XrTime, 4> ring;
+    for (XrTime t = 1; t <= 4; ++t) {
+        EXPECT_TRUE(ring.Push(t));
+    }
+    EXPECT_FALSE(ring.Push(5));
+    EXPECT_EQ(ring.Size(), 4u);
+
+    XrTime t;
+    for (XrTime expected = 1; expected <= 4; ++expected) {
+        ASSERT_TRUE(ring.Pop(&t));
+        EXPECT_EQ(t, expected);
+    }
+    EXPECT_FALSE(ring.Pop(&t));
+}
+
+// A 1 kHz-style sampler racing the sync thread: every sample that was
+// accepted arrives once, in timestamp order
+TEST(SpscRingTest, ConcurrentProducerAndConsumerLoseNothing) {
+    static SpscRing<XR2ControllerInput, 64> ring;
+    const XrTime sampleCount = 200000;
+
+    std::thread producer([&]() {
+        for (XrTime t = 1; t <= sampleCount; ++t) {
+            XR2ControllerInput sample = {};
+            sample.timestamp = t;
+            while (!ring.Push(sample)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    XrTime expected = 1;
+    uint64_t outOfOrder = 0;
+    while (expected <= sampleCount) {
+        XR2ControllerInput sample;
+        if (!ring.Pop(&sample)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (sample.timestamp != expected) {
+            outOfOrder++;
+        }
+        expected = sample.timestamp + 1;
+    }
+    producer.join();
+
+    EXPECT_EQ(outOfOrder, 0u);
+    EXPECT_EQ(ring.Size(), 0u);
+}
@@ -0,0 +1,141 @@
+#include "qualcomm/perf_governor.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace {
+
+const XrDuration PERIOD_NS = 1000000000LL / 90;
+const uint32_t MAX_LEVEL = 2;
+
+PerfGovernorSample MakeSample(XrDuration cpuTime, XrDuration gpuTime, uint32_t newDrops) {
+    PerfGovernorSample sample;
+    sample.displayPeriod = PERIOD_NS;
+    sample.cpuTime = cpuTime;
+    sample.gpuTime = gpuTime;
+    sample.newDrops = newDrops;
+    return sample;
+}
+
+// Closed-loop replay: the app does a fixed amount of work per frame, and
+// each level makes a unit config.levelSpeedup times faster
+struct ReplayResult {
+    uint32_t cpuLevel;
+    uint32_t gpuLevel;
+    uint32_t changes;
+    uint32_t lateChanges;  // In the second half of the replay
+};
+
+ReplayResult Replay(const PerfGovernorConfig& config, XrDuration cpuWork, XrDuration gpuWork, uint32_t samples) {
+    PerfGovernorState state = {};
+    ReplayResult result = {};
+    for (uint32_t i = 0; i < samples; ++i) {
+        XrDuration cpuTime = static_cast<XrDuration>(cpuWork / std::pow(config.levelSpeedup, state.cpuLevel));
+        XrDuration gpuTime = static_cast<XrDuration>(gpuWork / std::pow(config.levelSpeedup, state.gpuLevel));
+        uint32_t drops = (cpuTime > PERIOD_NS || gpuTime > PERIOD_NS) ? 5 : 0;
+        if (UpdatePerfGovernor(config, MakeSample(cpuTime, gpuTime, drops), &state)) {
+            result.changes++;
+            if (i >= samples / 2) {
+                result.lateChanges++;
+            }
+        }
+    }
+    result.cpuLevel = state.cpuLevel;
+    result.gpuLevel = state.gpuLevel;
+    return result;
+}
+
+}  // namespace
+
+TEST(PerfGovernorTest, SteadyLoadsSettleWithoutOscillating) {
+    PerfGovernorConfig config = GetDefaultPerfGovernorConfig(MAX_LEVEL);
+
+    // 30% to 160% of the period, CPU and GPU loads swept independently
+    for (int cpuPercent = 30; cpuPercent <= 160; cpuPercent += 5) {
+        for (int gpuPercent = 30; gpuPercent <= 160; gpuPercent += 15) {
+            XrDuration cpuWork = PERIOD_NS * cpuPercent / 100;
+            XrDuration gpuWork = PERIOD_NS * gpuPercent / 100;
+            ReplayResult result = Replay(config, cpuWork, gpuWork, 200);
+
+            EXPECT_EQ(result.lateChanges, 0u) << "cpu " << cpuPercent << "% gpu " << gpuPercent << "%";
+            EXPECT_LE(result.changes, 2 * MAX_LEVEL) << "cpu " << cpuPercent << "% gpu " << gpuPercent << "%";
+        }
+    }
+}
+
+TEST(PerfGovernorTest, HeavyUnitRisesToTheLevelThatFits) {
+    PerfGovernorConfig config = GetDefaultPerfGovernorConfig(MAX_LEVEL);
+
+    // 95% of the period at level 0, 76% at level 1: one level is enough
+    ReplayResult oneLevel = Replay(config, PERIOD_NS * 95 / 100, PERIOD_NS / 2, 100);
+    EXPECT_EQ(oneLevel.cpuLevel, 1u);
+    EXPECT_EQ(oneLevel.gpuLevel, 0u);
+
+    // Over budget even at the top level
+    ReplayResult saturated = Replay(config, PERIOD_NS / 2, PERIOD_NS * 2, 100);
+    EXPECT_EQ(saturated.cpuLevel, 0u);
+    EXPECT_EQ(saturated.gpuLevel, MAX_LEVEL);
+}
+
+TEST(PerfGovernorTest, DropsAreBlamedOnTheBusierUnit) {
+    PerfGovernorConfig config = GetDefaultPerfGovernorConfig(MAX_LEVEL);
+    PerfGovernorState state = {};
+
+    ASSERT_TRUE(UpdatePerfGovernor(config, MakeSample(PERIOD_NS / 2, PERIOD_NS * 7 / 10, 3), &state));
+    EXPECT_EQ(state.cpuLevel, 0u);
+    EXPECT_EQ(state.gpuLevel, 1u);
+}
+
+TEST(PerfGovernorTest, UnknownGpuTimeMovesBothLevels) {
+    PerfGovernorConfig config = GetDefaultPerfGovernorConfig(MAX_LEVEL);
+    PerfGovernorState state = {};
+
+    // CPU looks fine, yet frames drop: the GPU may be the cause
+    ASSERT_TRUE(UpdatePerfGovernor(config, MakeSample(PERIOD_NS / 2, PERF_GOVERNOR_GPU_TIME_UNKNOWN, 2), &state));
+    EXPECT_EQ(state.cpuLevel, 1u);
+    EXPECT_EQ(state.gpuLevel, 1u);
+
+    // And both come back down together once it is calm
+    for (uint32_t i = 0; i < config.cooldownSamples + config.lowerAfterSamples; ++i) {
+        UpdatePerfGovernor(config, MakeSample(PERIOD_NS / 3, PERF_GOVERNOR_GPU_TIME_UNKNOWN, 0), &state);
+    }
+    EXPECT_EQ(state.cpuLevel, 0u);
+    EXPECT_EQ(state.gpuLevel, 0u);
+}
+
+TEST(PerfGovernorTest, CooldownHoldsLevelsAfterAChange) {
+    PerfGovernorConfig config = GetDefaultPerfGovernorConfig(MAX_LEVEL);
+    PerfGovernorState state = {};
+    PerfGovernorSample overloaded = MakeSample(PERIOD_NS, PERIOD_NS / 2, 4);
+
+    ASSERT_TRUE(UpdatePerfGovernor(config, overloaded, &state));
+    for (uint32_t i = 0; i < config.cooldownSamples; ++i) {
+        EXPECT_FALSE(UpdatePerfGovernor(config, overloaded, &state)) << "sample " << i;
+    }
+    EXPECT_EQ(state.cpuLevel, 1u);
+    EXPECT_TRUE(UpdatePerfGovernor(config, overloaded, &state));
+    EXPECT_EQ(state.cpuLevel, 2u);
+}
+
+TEST(PerfGovernorTest, LowersOnlyAfterSustainedHeadroom) {
+    PerfGovernorConfig config = GetDefaultPerfGovernorConfig(MAX_LEVEL);
+    PerfGovernorState state = {};
+    state.cpuLevel = MAX_LEVEL;
+    state.gpuLevel = MAX_LEVEL;
+
+    PerfGovernorSample light = MakeSample(PERIOD_NS / 3, PERIOD_NS / 3, 0);
+    for (uint32_t i = 0; i + 1 < config.lowerAfterSamples; ++i) {
+        EXPECT_FALSE(UpdatePerfGovernor(config, light, &state));
+    }
+
+    // One busy sample restarts the count
+    EXPECT_FALSE(UpdatePerfGovernor(config, MakeSample(PERIOD_NS * 7 / 10, PERIOD_NS * 7 / 10, 0), &state));
+    EXPECT_FALSE(UpdatePerfGovernor(config, light, &state));
+    EXPECT_EQ(state.cpuLevel, MAX_LEVEL);
+
+    for (uint32_t i = 0; i + 2 < config.lowerAfterSamples; ++i) {
+        EXPECT_FALSE(UpdatePerfGovernor(config, light, &state));
+    }
+    EXPECT_TRUE(UpdatePerfGovernor(config, light, &state));
+    EXPECT_EQ(state.cpuLevel, MAX_LEVEL - 1);
+    EXPECT_EQ(state.gpuLevel, MAX_LEVEL - 1);
+}
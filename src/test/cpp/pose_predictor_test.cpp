@@ -0,0 +1,155 @@
+#include "qualcomm/pose_predictor.h"
+#include "utils/pose_math.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const XrDuration TRACKER_PERIOD_NS = 2000000;  // 500 Hz
+const double RAD_TO_DEG = 180.0 / 3.14159265358979323846;
+
+// Head trajectory: yaw (rad) and forward position (m) at t seconds
+struct Trajectory {
+    std::function<double(double)> yaw;
+    std::function<double(double)> position;
+};
+
+XrPosef PoseAt(const Trajectory& trajectory, double t) {
+    XrPosef pose;
+    double yaw = trajectory.yaw(t);
+    pose.orientation = {0.0f, static_cast<float>(std::sin(yaw / 2)), 0.0f, static_cast<float>(std::cos(yaw / 2))};
+    pose.position = {0.0f, 1.6f, static_cast<float>(trajectory.position(t))};
+    return pose;
+}
+
+double AngleBetween(const XrQuaternionf& a, const XrQuaternionf& b) {
+    double dot = std::min(1.0, std::fabs(static_cast<double>(QuatDot(a, b))));
+    return 2.0 * std::acos(dot);
+}
+
+// Trajectory sampled at the tracker rate up to 'end' seconds
+void Record(const Trajectory& trajectory, double end, PoseHistory* history) {
+    for (XrTime time = TRACKER_PERIOD_NS; time <= static_cast<XrTime>(end * 1e9); time += TRACKER_PERIOD_NS) {
+        HeadPoseSample sample = {};
+        sample.time = time;
+        sample.pose = PoseAt(trajectory, time / 1e9);
+        sample.quality = 1.0f;
+        history->Push(sample);
+    }
+}
+
+struct PredictionError {
+    double angle;     // rad
+    double position;  // m
+};
+
+PredictionError PredictAhead(const Trajectory& trajectory, double now, XrDuration ahead,
+                             PosePredictionModel model) {
+    std::unique_ptr<PoseHistory> history(new PoseHistory());
+    Record(trajectory, now, history.get());
+
+    HeadPoseSample newest, predicted;
+    EXPECT_TRUE(history->Latest(&newest));
+    EXPECT_TRUE(PredictHeadPose(*history, newest.time + ahead, model, &predicted));
+
+    XrPosef truth = PoseAt(trajectory, (newest.time + ahead) / 1e9);
+    return {AngleBetween(predicted.pose.orientation, truth.orientation),
+            std::fabs(predicted.pose.position.z - truth.position.z)};
+}
+
+}  // namespace
+
+TEST(PosePredictorTest, ConstantAngularVelocityIsExactForBothModels) {
+    Trajectory turn = {[](double t) { return 2.0 * t; }, [](double t) { return 0.5 * t; }};
+    for (PosePredictionModel model : {POSE_PREDICTION_CONSTANT_VELOCITY, POSE_PREDICTION_CONSTANT_ACCELERATION}) {
+        PredictionError error = PredictAhead(turn, 0.5, 20000000, model);
+        EXPECT_LT(error.angle * RAD_TO_DEG, 0.05) << "model " << model;
+        EXPECT_LT(error.position, 0.0005) << "model " << model;
+    }
+}
+
+TEST(PosePredictorTest, ConstantAccelerationModelFollowsAcceleratingTurn) {
+    // 0 to ~6 rad/s over half a second: a fast head turn spinning up
+    Trajectory spinUp = {[](double t) { return 6.0 * t * t; }, [](double t) { return 2.0 * t * t; }};
+    PredictionError velocity = PredictAhead(spinUp, 0.5, 30000000, POSE_PREDICTION_CONSTANT_VELOCITY);
+    PredictionError acceleration = PredictAhead(spinUp, 0.5, 30000000, POSE_PREDICTION_CONSTANT_ACCELERATION);
+
+    // Constant velocity is off by a*dt^2/2: 6 * 0.03^2 rad, about 0.3 degrees
+    EXPECT_GT(velocity.angle * RAD_TO_DEG, 0.2);
+    EXPECT_LT(acceleration.angle * RAD_TO_DEG, 0.05);
+    EXPECT_LT(acceleration.position, velocity.position);
+}
+
+TEST(PosePredictorTest, PastTimesInterpolateAndHorizonIsClamped) {
+    Trajectory turn = {[](double t) { return 1.0 * t; }, [](double) { return 0.0; }};
+    std::unique_ptr<PoseHistory> history(new PoseHistory());
+    Record(turn, 0.2, history.get());
+
+    HeadPoseSample newest, sample;
+    ASSERT_TRUE(history->Latest(&newest));
+
+    // Halfway between two tracker samples
+    XrTime past = newest.time - 5 * TRACKER_PERIOD_NS - TRACKER_PERIOD_NS / 2;
+    ASSERT_TRUE(PredictHeadPose(*history, past, POSE_PREDICTION_CONSTANT_VELOCITY, &sample));
+    EXPECT_LT(AngleBetween(sample.pose.orientation, PoseAt(turn, past / 1e9).orientation) * RAD_TO_DEG, 0.01);
+
+    // A second ahead is predicted as if it were MAX_POSE_PREDICTION_NS
+    XrTime far = newest.time + 1000000000;
+    ASSERT_TRUE(PredictHeadPose(*history, far, POSE_PREDICTION_CONSTANT_VELOCITY, &sample));
+    EXPECT_EQ(sample.time, far);
+    XrPosef clamped = PoseAt(turn, (newest.time + MAX_POSE_PREDICTION_NS) / 1e9);
+    EXPECT_LT(AngleBetween(sample.pose.orientation, clamped.orientation) * RAD_TO_DEG, 0.05);
+}
+
+TEST(PosePredictorTest, SingleSampleHoldsTheNewestPose) {
+    std::unique_ptr<PoseHistory> history(new PoseHistory());
+    HeadPoseSample only = {};
+    only.time = 1000;
+    only.pose.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
+    only.pose.position = {1.0f, 2.0f, 3.0f};
+    history->Push(only);
+
+    HeadPoseSample sample;
+    ASSERT_TRUE(PredictHeadPose(*history, 20001000, POSE_PREDICTION_CONSTANT_ACCELERATION, &sample));
+    EXPECT_EQ(sample.pose.position.z, 3.0f);
+    EXPECT_EQ(sample.pose.orientation.w, 1.0f);
+}
+
+// Offline accuracy over a recorded-style head motion: +-40 degree yaw
+// sweeps at 0.5-1.5 Hz, predicted at typical display latencies
+TEST(PosePredictorTest, AccuracyOnHeadSweeps) {
+    const double amplitude = 40.0 / RAD_TO_DEG;
+    const XrDuration horizons[] = {10000000, 20000000, 40000000};
+
+    for (XrDuration ahead : horizons) {
+        double mean[2] = {0.0, 0.0};
+        double worst[2] = {0.0, 0.0};
+        uint32_t cases = 0;
+        for (double frequency = 0.5; frequency <= 1.5; frequency += 0.25) {
+            double w = 2.0 * 3.14159265358979323846 * frequency;
+            Trajectory sweep = {[=](double t) { return amplitude * std::sin(w * t); },
+                                [=](double t) { return 0.05 * std::sin(w * t); }};
+            for (double now = 0.1; now < 0.9; now += 0.1) {
+                for (int m = 0; m < 2; ++m) {
+                    PosePredictionModel model = static_cast<PosePredictionModel>(m);
+                    double error = PredictAhead(sweep, now, ahead, model).angle * RAD_TO_DEG;
+                    mean[m] += error;
+                    worst[m] = std::max(worst[m], error);
+                }
+                cases++;
+            }
+        }
+        mean[0] /= cases;
+        mean[1] /= cases;
+        printf("[ BENCH    ] %2lld ms ahead: constant velocity %.3f deg mean / %.3f max, "
+               "constant acceleration %.3f deg mean / %.3f max\n",
+               static_cast<long long>(ahead / 1000000), mean[0], worst[0], mean[1], worst[1]);
+
+        EXPECT_LT(mean[1], mean[0]) << static_cast<long long>(ahead / 1000000) << " ms";
+    }
+}
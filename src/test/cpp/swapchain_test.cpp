@@ -0,0 +1,222 @@
+#include "openxr/openxr_api.h"
+#include "openxr/handle_table.h"
+#include "openxr/session.h"
+#include "openxr/swapchain.h"
+#include "platform/host_graphics_backend.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+extern HandleTable<XRSession, XrSession> g_sessions;
+extern HandleTable<XRSwapchain, XrSwapchain> g_swapchains;
+
+namespace {
+
+// One session and one 64x64 swapchain of the host backend
+class SwapchainTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        session_ = g_sessions.Insert(std::make_shared<XRSession>(XR_NULL_HANDLE));
+        ASSERT_NE(session_, XR_NULL_HANDLE);
+    }
+
+    void TearDown() override {
+        if (swapchain_ != XR_NULL_HANDLE) {
+            xrDestroySwapchain(swapchain_);
+        }
+        g_sessions.Remove(session_);
+    }
+
+    void Create(XrSwapchainCreateFlags createFlags) {
+        XrSwapchainCreateInfo createInfo = {};
+        createInfo.type = XR_TYPE_SWAPCHAIN_CREATE_INFO;
+        createInfo.createFlags = createFlags;
+        createInfo.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+        createInfo.format = HOST_FORMAT_RGBA8;
+        createInfo.sampleCount = 1;
+        createInfo.width = 64;
+        createInfo.height = 64;
+        createInfo.faceCount = 1;
+        createInfo.arraySize = 1;
+        createInfo.mipCount = 1;
+        ASSERT_EQ(xrCreateSwapchain(session_, &createInfo, &swapchain_), XR_SUCCESS);
+        ASSERT_EQ(xrEnumerateSwapchainImages(swapchain_, 0, &imageCount_, nullptr), XR_SUCCESS);
+    }
+
+    XrResult Acquire(uint32_t* index) {
+        XrSwapchainImageAcquireInfo acquireInfo = {};
+        acquireInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO;
+        return xrAcquireSwapchainImage(swapchain_, &acquireInfo, index);
+    }
+
+    XrResult Wait(XrDuration timeout) {
+        XrSwapchainImageWaitInfo waitInfo = {};
+        waitInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO;
+        waitInfo.timeout = timeout;
+        return xrWaitSwapchainImage(swapchain_, &waitInfo);
+    }
+
+    XrResult Release() {
+        XrSwapchainImageReleaseInfo releaseInfo = {};
+        releaseInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO;
+        return xrReleaseSwapchainImage(swapchain_, &releaseInfo);
+    }
+
+    XrSession session_ = XR_NULL_HANDLE;
+    XrSwapchain swapchain_ = XR_NULL_HANDLE;
+    uint32_t imageCount_ = 0;
+};
+
+}  // namespace
+
+TEST_F(SwapchainTest, ImagesCycleInFifoOrder) {
+    Create(0);
+    ASSERT_GE(imageCount_, 2u);
+
+    for (uint32_t frame = 0; frame < 3 * imageCount_; ++frame) {
+        uint32_t index;
+        ASSERT_EQ(Acquire(&index), XR_SUCCESS);
+        EXPECT_EQ(index, frame % imageCount_);
+        ASSERT_EQ(Wait(XR_INFINITE_DURATION), XR_SUCCESS);
+        ASSERT_EQ(Release(), XR_SUCCESS);
+
+        // The compositor picks up the image just released
+        XRSwapchain* pinned;
+        uint32_t pinnedIndex;
+        ASSERT_TRUE(PinSwapchainImage(swapchain_, &pinned, &pinnedIndex));
+        EXPECT_EQ(pinnedIndex, index);
+        UnpinSwapchainImage(pinned, pinnedIndex);
+    }
+}
+
+TEST_F(SwapchainTest, CallsOutOfOrderAreRejected) {
+    Create(0);
+
+    EXPECT_EQ(Wait(0), XR_ERROR_CALL_ORDER_INVALID);
+    EXPECT_EQ(Release(), XR_ERROR_CALL_ORDER_INVALID);
+
+    // Every image held by the app: nothing left to hand out
+    uint32_t index;
+    for (uint32_t i = 0; i < imageCount_; ++i) {
+        ASSERT_EQ(Acquire(&index), XR_SUCCESS);
+    }
+    EXPECT_EQ(Acquire(&index), XR_ERROR_CALL_ORDER_INVALID);
+    EXPECT_EQ(Release(), XR_ERROR_CALL_ORDER_INVALID);
+
+    ASSERT_EQ(Wait(0), XR_SUCCESS);
+    ASSERT_EQ(Release(), XR_SUCCESS);
+    EXPECT_EQ(Acquire(&index), XR_SUCCESS);
+    EXPECT_EQ(index, 0u);
+}
+
+TEST_F(SwapchainTest, StaticImageIsAcquiredOnce) {
+    Create(XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT);
+    EXPECT_EQ(imageCount_, 1u);
+
+    uint32_t index;
+    ASSERT_EQ(Acquire(&index), XR_SUCCESS);
+    EXPECT_EQ(index, 0u);
+    ASSERT_EQ(Wait(XR_INFINITE_DURATION), XR_SUCCESS);
+    ASSERT_EQ(Release(), XR_SUCCESS);
+    EXPECT_EQ(Acquire(&index), XR_ERROR_CALL_ORDER_INVALID);
+}
+
+// Wait blocks on the image's release fence, which the compositor's unpin
+// signals
+TEST_F(SwapchainTest, WaitBlocksWhileTheCompositorReadsTheImage) {
+    Create(0);
+
+    // Show image 0 and keep it pinned, then cycle round to it again
+    uint32_t index;
+    ASSERT_EQ(Acquire(&index), XR_SUCCESS);
+    ASSERT_EQ(Wait(XR_INFINITE_DURATION), XR_SUCCESS);
+    ASSERT_EQ(Release(), XR_SUCCESS);
+    XRSwapchain* pinned;
+    uint32_t pinnedIndex;
+    ASSERT_TRUE(PinSwapchainImage(swapchain_, &pinned, &pinnedIndex));
+    ASSERT_EQ(pinnedIndex, 0u);
+    for (uint32_t i = 1; i < imageCount_; ++i) {
+        ASSERT_EQ(Acquire(&index), XR_SUCCESS);
+        ASSERT_EQ(Wait(XR_INFINITE_DURATION), XR_SUCCESS);
+        ASSERT_EQ(Release(), XR_SUCCESS);
+    }
+    ASSERT_EQ(Acquire(&index), XR_SUCCESS);
+    ASSERT_EQ(index, 0u);
+
+    // Still read: the wait times out and can be retried
+    EXPECT_EQ(Wait(2000000), XR_TIMEOUT_EXPIRED);
+
+    std::atomic<bool> unpinned(false);
+    std::thread compositor([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        unpinned = true;
+        UnpinSwapchainImage(pinned, pinnedIndex);
+    });
+    EXPECT_EQ(Wait(XR_INFINITE_DURATION), XR_SUCCESS);
+    EXPECT_TRUE(unpinned.load());
+    compositor.join();
+    EXPECT_EQ(Release(), XR_SUCCESS);
+}
+
+// The app cycling acquire, wait and release as fast as it can while a
+// compositor thread keeps pinning whatever was released last: the ring
+// stays in order and no image is handed back while it is still read
+TEST_F(SwapchainTest, AcquireWaitReleaseUnderCompositorPins) {
+    Create(0);
+    XRSwapchain* xrSwapchain = g_swapchains.Lookup(swapchain_);
+    ASSERT_NE(xrSwapchain, nullptr);
+
+    const uint32_t cycles = 50000;
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> pins(0);
+    std::thread compositor([&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            XRSwapchain* pinned;
+            uint32_t pinnedIndex;
+            if (PinSwapchainImage(swapchain_, &pinned, &pinnedIndex)) {
+                std::this_thread::yield();  // Read the image
+                UnpinSwapchainImage(pinned, pinnedIndex);
+                pins.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t outOfOrder = 0;
+    uint32_t stillRead = 0;
+    uint32_t failures = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t cycle = 0; cycle < cycles; ++cycle) {
+        uint32_t index;
+        if (Acquire(&index) != XR_SUCCESS || Wait(XR_INFINITE_DURATION) != XR_SUCCESS) {
+            failures++;
+            break;
+        }
+        if (index != cycle % imageCount_) {
+            outOfOrder++;
+        }
+        // Only the last released image is ever pinned, never this one
+        if (xrSwapchain->fences[index].compositorRefs.load() != 0) {
+            stillRead++;
+        }
+        std::this_thread::yield();  // Render to the image
+        if (Release() != XR_SUCCESS) {
+            failures++;
+            break;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stop = true;
+    compositor.join();
+
+    printf("[ BENCH    ] %u acquire/wait/release cycles, %llu compositor pins: %.0f ns per cycle\n", cycles,
+           static_cast<unsigned long long>(pins.load()), seconds * 1e9 / cycles);
+    EXPECT_EQ(failures, 0u);
+    EXPECT_EQ(outOfOrder, 0u);
+    EXPECT_EQ(stillRead, 0u);
+    EXPECT_GT(pins.load(), 0u);
+}
@@ -0,0 +1,303 @@
+#include "platform/host_graphics_backend.h"
+#include "platform/texture_pool.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+namespace {
+
+// Hands out texture names and tracks which are alive
+class MockTextureBackend : public TexturePoolBackend {
+public:
+    bool CreateTextures(const SwapchainImageDesc&, uint32_t count, uint32_t* textures) override {
+        if (failCreate) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            textures[i] = nextTexture++;
+            live.insert(textures[i]);
+        }
+        created += count;
+        return true;
+    }
+
+    void DestroyTextures(const uint32_t* textures, uint32_t count) override {
+        for (uint32_t i = 0; i < count; ++i) {
+            EXPECT_EQ(live.erase(textures[i]), 1u) << "texture " << textures[i] << " destroyed twice";
+        }
+        destroyed += count;
+    }
+
+    uint64_t TextureBytes(const SwapchainImageDesc& desc) const override {
+        return static_cast<uint64_t>(desc.width) * desc.height * 4 * desc.arraySize * desc.sampleCount;
+    }
+
+    std::set<uint32_t> live;
+    uint32_t nextTexture = 1;
+    uint32_t created = 0;
+    uint32_t destroyed = 0;
+    bool failCreate = false;
+};
+
+SwapchainImageDesc MakeDesc(uint32_t width, uint32_t height) {
+    SwapchainImageDesc desc = {};
+    desc.width = width;
+    desc.height = height;
+    desc.format = HOST_FORMAT_RGBA8;
+    desc.sampleCount = 1;
+    desc.arraySize = 1;
+    desc.mipCount = 1;
+    return desc;
+}
+
+const uint64_t TEXTURE_64_BYTES = 64 * 64 * 4;
+
+}  // namespace
+
+TEST(TexturePoolTest, RecreateReusesTheSameTextures) {
+    MockTextureBackend backend;
+    TexturePool pool(&backend, 1 << 20);
+    SwapchainImageDesc desc = MakeDesc(64, 64);
+
+    uint32_t first[3];
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 3, first));
+    pool.Release(&backend, desc, first, 3);
+
+    uint32_t second[3];
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 3, second));
+    EXPECT_EQ(std::set<uint32_t>(first, first + 3), std::set<uint32_t>(second, second + 3));
+    EXPECT_EQ(backend.created, 3u);
+
+    TexturePoolStats stats;
+    pool.GetStats(&stats);
+    EXPECT_EQ(stats.hits, 3u);
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.texturesHeld, 0u);
+    EXPECT_EQ(stats.bytesHeld, 0u);
+    pool.Release(&backend, desc, second, 3);
+}
+
+TEST(TexturePoolTest, OnlyIdenticalDescriptionsMatch) {
+    MockTextureBackend backend;
+    TexturePool pool(&backend, 1 << 20);
+    SwapchainImageDesc desc = MakeDesc(64, 64);
+    uint32_t texture;
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 1, &texture));
+    pool.Release(&backend, desc, &texture, 1);
+
+    SwapchainImageDesc layered = desc;
+    layered.arraySize = 2;
+    SwapchainImageDesc multisampled = desc;
+    multisampled.sampleCount = 4;
+    SwapchainImageDesc srgb = desc;
+    srgb.format = HOST_FORMAT_SRGB8_ALPHA8;
+    for (const SwapchainImageDesc& other : {MakeDesc(64, 32), layered, multisampled, srgb}) {
+        uint32_t created;
+        ASSERT_TRUE(pool.Acquire(&backend, other, 1, &created));
+        EXPECT_NE(created, texture);
+        backend.DestroyTextures(&created, 1);
+    }
+
+    TexturePoolStats stats;
+    pool.GetStats(&stats);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.texturesHeld, 1u);
+}
+
+TEST(TexturePoolTest, PartialHitCreatesTheRest) {
+    MockTextureBackend backend;
+    TexturePool pool(&backend, 1 << 20);
+    SwapchainImageDesc desc = MakeDesc(64, 64);
+    uint32_t texture;
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 1, &texture));
+    pool.Release(&backend, desc, &texture, 1);
+
+    uint32_t textures[3];
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 3, textures));
+    EXPECT_EQ(textures[0], texture);
+    EXPECT_EQ(backend.created, 3u);
+    EXPECT_EQ(std::set<uint32_t>(textures, textures + 3).size(), 3u);
+    pool.Release(&backend, desc, textures, 3);
+}
+
+TEST(TexturePoolTest, FailedCreateKeepsReusedTexturesPooled) {
+    MockTextureBackend backend;
+    TexturePool pool(&backend, 1 << 20);
+    SwapchainImageDesc desc = MakeDesc(64, 64);
+    uint32_t texture;
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 1, &texture));
+    pool.Release(&backend, desc, &texture, 1);
+
+    backend.failCreate = true;
+    uint32_t textures[3];
+    EXPECT_FALSE(pool.Acquire(&backend, desc, 3, textures));
+
+    TexturePoolStats stats;
+    pool.GetStats(&stats);
+    EXPECT_EQ(stats.texturesHeld, 1u);
+    EXPECT_EQ(backend.live.count(texture), 1u);
+}
+
+TEST(TexturePoolTest, EvictsLeastRecentlyReleasedOverBudget) {
+    MockTextureBackend backend;
+    TexturePool pool(&backend, 2 * TEXTURE_64_BYTES);
+    SwapchainImageDesc desc = MakeDesc(64, 64);
+    uint32_t textures[3];
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 3, textures));
+
+    for (uint32_t texture : textures) {
+        pool.Release(&backend, desc, &texture, 1);
+    }
+    EXPECT_EQ(backend.live.count(textures[0]), 0u);
+    EXPECT_EQ(backend.live.count(textures[1]), 1u);
+    EXPECT_EQ(backend.live.count(textures[2]), 1u);
+
+    TexturePoolStats stats;
+    pool.GetStats(&stats);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.bytesHeld, 2 * TEXTURE_64_BYTES);
+    EXPECT_LE(stats.bytesHeld, stats.budgetBytes);
+
+    // Lowering the budget evicts the older of the two
+    pool.SetBudget(TEXTURE_64_BYTES);
+    EXPECT_EQ(backend.live.count(textures[1]), 0u);
+    EXPECT_EQ(backend.live.count(textures[2]), 1u);
+
+    // Most recently released is handed out first
+    uint32_t reused;
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 1, &reused));
+    EXPECT_EQ(reused, textures[2]);
+    pool.Release(&backend, desc, &reused, 1);
+}
+
+TEST(TexturePoolTest, TexturesLargerThanTheBudgetAreNotKept) {
+    MockTextureBackend backend;
+    TexturePool pool(&backend, TEXTURE_64_BYTES);
+    SwapchainImageDesc desc = MakeDesc(128, 128);
+    uint32_t texture;
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 1, &texture));
+    pool.Release(&backend, desc, &texture, 1);
+
+    EXPECT_TRUE(backend.live.empty());
+    TexturePoolStats stats;
+    pool.GetStats(&stats);
+    EXPECT_EQ(stats.bytesHeld, 0u);
+}
+
+TEST(TexturePoolTest, BackendSwitchDestroysWithTheOwningBackend) {
+    MockTextureBackend oldBackend;
+    MockTextureBackend newBackend;
+    newBackend.nextTexture = 1000;
+    TexturePool pool(&oldBackend, 1 << 20);
+    SwapchainImageDesc desc = MakeDesc(64, 64);
+
+    uint32_t idle, inUse;
+    ASSERT_TRUE(pool.Acquire(&oldBackend, desc, 1, &idle));
+    ASSERT_TRUE(pool.Acquire(&oldBackend, desc, 1, &inUse));
+    pool.Release(&oldBackend, desc, &idle, 1);
+
+    // Idle textures go with the old backend
+    pool.SetBackend(&newBackend);
+    EXPECT_EQ(oldBackend.live.count(idle), 0u);
+
+    // A swapchain of the old backend destroyed later is not pooled
+    pool.Release(&oldBackend, desc, &inUse, 1);
+    EXPECT_TRUE(oldBackend.live.empty());
+
+    // The new backend never sees the old backend's textures
+    uint32_t texture;
+    ASSERT_TRUE(pool.Acquire(&newBackend, desc, 1, &texture));
+    EXPECT_GE(texture, 1000u);
+    pool.Release(&newBackend, desc, &texture, 1);
+
+    // Nor does the old one get the new backend's
+    ASSERT_TRUE(pool.Acquire(&oldBackend, desc, 1, &texture));
+    EXPECT_LT(texture, 1000u);
+    pool.Release(&oldBackend, desc, &texture, 1);
+    EXPECT_TRUE(oldBackend.live.empty());
+}
+
+TEST(TexturePoolTest, ClearAndDestructorDestroyIdleTextures) {
+    MockTextureBackend backend;
+    SwapchainImageDesc desc = MakeDesc(64, 64);
+    uint32_t textures[2];
+    {
+        TexturePool pool(&backend, 1 << 20);
+        ASSERT_TRUE(pool.Acquire(&backend, desc, 2, textures));
+        pool.Release(&backend, desc, textures, 2);
+        pool.Clear();
+        EXPECT_TRUE(backend.live.empty());
+
+        TexturePoolStats stats;
+        pool.GetStats(&stats);
+        EXPECT_EQ(stats.evictions, 2u);
+        EXPECT_EQ(stats.budgetBytes, 1u << 20);
+
+        ASSERT_TRUE(pool.Acquire(&backend, desc, 2, textures));
+        pool.Release(&backend, desc, textures, 2);
+    }
+    EXPECT_TRUE(backend.live.empty());
+    EXPECT_EQ(backend.created, backend.destroyed);
+}
+
+// Destroying reenters the pool, as a backend deferring deletes to another
+// thread would; with the pool still locked this would deadlock
+TEST(TexturePoolTest, EvictionCallsTheBackendWithThePoolUnlocked) {
+    struct ReenteringBackend : MockTextureBackend {
+        void DestroyTextures(const uint32_t* textures, uint32_t count) override {
+            MockTextureBackend::DestroyTextures(textures, count);
+            TexturePoolStats stats;
+            pool->GetStats(&stats);
+            heldAtDestroy = stats.texturesHeld;
+        }
+        TexturePool* pool = nullptr;
+        uint32_t heldAtDestroy = UINT32_MAX;
+    };
+
+    ReenteringBackend backend;
+    TexturePool pool(&backend, TEXTURE_64_BYTES);
+    backend.pool = &pool;
+    SwapchainImageDesc desc = MakeDesc(64, 64);
+    uint32_t textures[2];
+    ASSERT_TRUE(pool.Acquire(&backend, desc, 2, textures));
+    pool.Release(&backend, desc, textures, 2);
+    EXPECT_EQ(backend.destroyed, 1u);
+    EXPECT_EQ(backend.heldAtDestroy, 1u);
+
+    pool.Clear();
+    EXPECT_EQ(backend.heldAtDestroy, 0u);
+    EXPECT_TRUE(backend.live.empty());
+}
+
+// Recreating a swapchain of host images (allocation and zero-fill) with and
+// without the pool. Disabled by default, see README.
+TEST(TexturePoolBenchmark, DISABLED_RecreateCostWithAndWithoutPool) {
+    const uint32_t recreates = 40;
+    SwapchainImageDesc desc = MakeDesc(1024, 1024);
+    double seconds[2];
+
+    for (int pooled = 0; pooled < 2; ++pooled) {
+        HostGraphicsBackend backend;
+        TexturePool pool(&backend, pooled ? 64ULL << 20 : 0);
+        uint32_t textures[3];
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < recreates; ++i) {
+            ASSERT_TRUE(pool.Acquire(&backend, desc, 3, textures));
+            pool.Release(&backend, desc, textures, 3);
+        }
+        seconds[pooled] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Pooled, only the first recreate creates textures
+        TexturePoolStats stats;
+        pool.GetStats(&stats);
+        EXPECT_EQ(stats.misses, pooled ? 3u : 3u * recreates);
+        EXPECT_EQ(stats.hits, pooled ? 3u * (recreates - 1) : 0u);
+        pool.Clear();
+        EXPECT_EQ(backend.GetImageCount(), 0u);
+    }
+
+    printf("[ BENCH    ] 3 x 1024x1024 swapchain recreate: %.1f us unpooled, %.1f us pooled\n",
+           seconds[0] * 1e6 / recreates, seconds[1] * 1e6 / recreates);
+}